@@ -0,0 +1,12 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+flat in int Layer;
+
+uniform sampler2D image;
+
+void main()
+{
+    FragColor = texture(image, TexCoord);
+}
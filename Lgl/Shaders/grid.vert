@@ -0,0 +1,17 @@
+#version 330 core
+out vec2 TexCoord;
+flat out int Layer;
+
+// quads are laid out on a grid, object i lands in cell baseInstance + gl_InstanceID
+uniform int baseInstance;
+uniform int columns;
+
+void main()
+{
+   int id = baseInstance + gl_InstanceID;
+   vec2 corner = vec2(gl_VertexID & 1, (gl_VertexID >> 1) & 1);
+   vec2 cell = vec2(id % columns, id / columns);
+   TexCoord = corner;
+   Layer = id;
+   gl_Position = vec4((cell + corner) / float(columns) * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,30 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// the draw's base instance, see IndirectBatch
+layout (location = 7) in uint aDrawIndex;
+
+out vec2 TexCoord;
+flat out int Layer;
+
+struct DrawData
+{
+    mat4 model;
+    uvec4 layer; // x, the rest is padding
+};
+
+layout (std430, binding = 1) readonly buffer Draws
+{
+    DrawData draws[];
+};
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+   DrawData draw = draws[aDrawIndex];
+   gl_Position = projection * view * draw.model * vec4(aPos, 1.0);
+   TexCoord = aTexCoord;
+   Layer = int(draw.layer.x);
+}
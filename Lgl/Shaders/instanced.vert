@@ -0,0 +1,16 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// per-instance, a mat4 takes locations 2 to 5
+layout (location = 2) in mat4 aModel;
+
+out vec2 TexCoord;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+   gl_Position = projection * view * aModel * vec4(aPos, 1.0);
+   TexCoord = aTexCoord;
+}
\ No newline at end of file
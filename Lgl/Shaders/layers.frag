@@ -0,0 +1,12 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+flat in int Layer;
+
+uniform sampler2DArray images;
+
+void main()
+{
+    FragColor = texture(images, vec3(TexCoord, Layer));
+}
@@ -0,0 +1,16 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D image;
+uniform vec2 scale;
+
+void main()
+{
+    // four neighbouring taps per pixel at one texel per pixel keep the sampler on level 0
+    vec2 uv = TexCoord * scale;
+    vec2 texel = 1.0 / vec2(textureSize(image, 0));
+    FragColor = (texture(image, uv) + texture(image, uv + vec2(texel.x, 0.0)) +
+                 texture(image, uv + vec2(0.0, texel.y)) + texture(image, uv + texel)) * 0.25;
+}
@@ -0,0 +1,27 @@
+#version 430 core
+#ifdef BINDLESS
+#extension GL_ARB_bindless_texture : require
+#endif
+out vec4 FragColor;
+
+in vec2 TexCoord;
+flat in int Layer;
+
+#ifdef BINDLESS
+// resident texture handles, filled by TextureTable
+layout (std430, binding = 0) readonly buffer Textures
+{
+    uvec2 textures[];
+};
+#else
+uniform sampler2DArray textures;
+#endif
+
+void main()
+{
+#ifdef BINDLESS
+    FragColor = texture(sampler2D(textures[Layer]), TexCoord);
+#else
+    FragColor = texture(textures, vec3(TexCoord, Layer));
+#endif
+}
@@ -0,0 +1,53 @@
+#version 430 core
+#ifdef FEEDBACK
+// tile x, tile y, level and a valid flag, read back by VirtualTexture
+out uvec4 Feedback;
+#else
+out vec4 FragColor;
+#endif
+
+in vec2 TexCoord;
+
+// view of the image, uv = TexCoord * scale + offset
+uniform vec2 scale;
+uniform vec2 offset;
+
+// set by VirtualTexture::Bind
+uniform float virtualSize; // padded level 0 size in texels
+uniform vec2 uvScale;      // source image over padded size
+uniform int levels;
+uniform float tileSize;
+uniform float lodBias;
+uniform sampler2D pages;
+// sparse: finest resident level per level 0 tile
+// otherwise: page x, page y and resident level per tile of every level
+uniform usampler2D indirection;
+#ifndef SPARSE
+uniform float pageBorder;
+uniform float cacheSize;
+#endif
+
+void main()
+{
+    vec2 uv = clamp(TexCoord * scale + offset, 0.0, 1.0) * uvScale;
+
+    // level whose texels are closest to one per pixel
+    vec2 dx = dFdx(uv * virtualSize), dy = dFdy(uv * virtualSize);
+    float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + lodBias;
+    int level = int(clamp(lod, 0.0, float(levels - 1)));
+    vec2 texel = min(uv * virtualSize, virtualSize - 1.0);
+
+#ifdef FEEDBACK
+    Feedback = uvec4(uvec2(texel / (tileSize * exp2(float(level)))), uint(level), 1u);
+#elif defined(SPARSE)
+    uint finest = texelFetch(indirection, ivec2(texel / tileSize), 0).r;
+    FragColor = textureLod(pages, uv, float(max(uint(level), finest)));
+#else
+    uvec4 entry = texelFetch(indirection, ivec2(texel / (tileSize * exp2(float(level)))), level);
+    // position inside the tile at the level that is actually resident
+    vec2 resident = uv * virtualSize / exp2(float(entry.z));
+    vec2 inside = resident - floor(resident / tileSize) * tileSize;
+    vec2 physical = vec2(entry.xy) * (tileSize + 2.0 * pageBorder) + pageBorder + inside;
+    FragColor = texture(pages, physical / cacheSize);
+#endif
+}
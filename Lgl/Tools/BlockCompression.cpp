@@ -0,0 +1,203 @@
+#include "BlockCompression.h"
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace Mirage
+{
+    namespace BlockCompression
+    {
+        static std::uint16_t PackRGB565(const float *rgb)
+        {
+            const int r = static_cast<int>(std::min(std::max(rgb[0], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+            const int g = static_cast<int>(std::min(std::max(rgb[1], 0.0f), 255.0f) * 63.0f / 255.0f + 0.5f);
+            const int b = static_cast<int>(std::min(std::max(rgb[2], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+            return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+        }
+
+        static void UnpackRGB565(std::uint16_t color, int *rgb)
+        {
+            const int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+            rgb[0] = (r << 3) | (r >> 2);
+            rgb[1] = (g << 2) | (g >> 4);
+            rgb[2] = (b << 3) | (b >> 2);
+        }
+
+        /// Range fit: endpoints are the extremes of the block along its principal axis
+        static void EncodeColor(const unsigned char *rgba, unsigned char *block)
+        {
+            float mean[3] = {0.0f, 0.0f, 0.0f};
+            for (int i = 0; i < 16; i++)
+                for (int c = 0; c < 3; c++)
+                    mean[c] += rgba[i * 4 + c] / 16.0f;
+
+            float cov[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+            for (int i = 0; i < 16; i++)
+            {
+                const float r = rgba[i * 4] - mean[0], g = rgba[i * 4 + 1] - mean[1], b = rgba[i * 4 + 2] - mean[2];
+                cov[0] += r * r;
+                cov[1] += r * g;
+                cov[2] += r * b;
+                cov[3] += g * g;
+                cov[4] += g * b;
+                cov[5] += b * b;
+            }
+
+            // A few power iterations are enough to find the dominant eigenvector
+            float axis[3] = {1.0f, 1.0f, 1.0f};
+            for (int iteration = 0; iteration < 8; iteration++)
+            {
+                const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+                const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+                const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+                const float length = std::max(std::max(std::fabs(x), std::fabs(y)), std::fabs(z));
+                if (length <= 0.0f)
+                    break;
+                axis[0] = x / length;
+                axis[1] = y / length;
+                axis[2] = z / length;
+            }
+
+            float low = 0.0f, high = 0.0f;
+            for (int i = 0; i < 16; i++)
+            {
+                const float t = (rgba[i * 4] - mean[0]) * axis[0] + (rgba[i * 4 + 1] - mean[1]) * axis[1] +
+                                (rgba[i * 4 + 2] - mean[2]) * axis[2];
+                low = std::min(low, t);
+                high = std::max(high, t);
+            }
+            const float lengthSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+            float start[3], end[3];
+            for (int c = 0; c < 3; c++)
+            {
+                start[c] = mean[c] + axis[c] * high / std::max(lengthSq, 1e-6f);
+                end[c] = mean[c] + axis[c] * low / std::max(lengthSq, 1e-6f);
+            }
+
+            // The larger endpoint goes first to select the four colour mode
+            std::uint16_t c0 = PackRGB565(start), c1 = PackRGB565(end);
+            if (c0 < c1)
+                std::swap(c0, c1);
+
+            std::uint32_t indices = 0;
+            if (c0 != c1)
+            {
+                int palette[4][3];
+                UnpackRGB565(c0, palette[0]);
+                UnpackRGB565(c1, palette[1]);
+                for (int c = 0; c < 3; c++)
+                {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                }
+                for (int i = 0; i < 16; i++)
+                {
+                    int best = 0, bestError = 1 << 30;
+                    for (int p = 0; p < 4; p++)
+                    {
+                        int error = 0;
+                        for (int c = 0; c < 3; c++)
+                        {
+                            const int d = rgba[i * 4 + c] - palette[p][c];
+                            error += d * d;
+                        }
+                        if (error < bestError)
+                        {
+                            best = p;
+                            bestError = error;
+                        }
+                    }
+                    indices |= static_cast<std::uint32_t>(best) << (i * 2);
+                }
+            }
+
+            block[0] = c0 & 0xff;
+            block[1] = c0 >> 8;
+            block[2] = c1 & 0xff;
+            block[3] = c1 >> 8;
+            for (int i = 0; i < 4; i++)
+                block[4 + i] = (indices >> (i * 8)) & 0xff;
+        }
+
+        static void EncodeAlpha(const unsigned char *rgba, unsigned char *block)
+        {
+            int a0 = 0, a1 = 255;
+            for (int i = 0; i < 16; i++)
+            {
+                a0 = std::max<int>(a0, rgba[i * 4 + 3]);
+                a1 = std::min<int>(a1, rgba[i * 4 + 3]);
+            }
+
+            // a0 > a1 selects eight interpolated values, codes 2-7 blend from a0 towards a1
+            int palette[8] = {a0, a1};
+            for (int i = 2; i < 8; i++)
+                palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+
+            std::uint64_t indices = 0;
+            if (a0 != a1)
+            {
+                for (int i = 0; i < 16; i++)
+                {
+                    int best = 0, bestError = 256;
+                    for (int p = 0; p < 8; p++)
+                    {
+                        const int error = std::abs(rgba[i * 4 + 3] - palette[p]);
+                        if (error < bestError)
+                        {
+                            best = p;
+                            bestError = error;
+                        }
+                    }
+                    indices |= static_cast<std::uint64_t>(best) << (i * 3);
+                }
+            }
+
+            block[0] = static_cast<unsigned char>(a0);
+            block[1] = static_cast<unsigned char>(a1);
+            for (int i = 0; i < 6; i++)
+                block[2 + i] = (indices >> (i * 8)) & 0xff;
+        }
+
+        void EncodeBC1(const unsigned char *rgba, unsigned char *block)
+        {
+            EncodeColor(rgba, block);
+        }
+
+        void EncodeBC3(const unsigned char *rgba, unsigned char *block)
+        {
+            EncodeAlpha(rgba, block);
+            EncodeColor(rgba, block + 8);
+        }
+
+        std::size_t EncodeImage(const unsigned char *rgba, int width, int height, bool alpha, unsigned char *out)
+        {
+            const std::size_t blockSize = alpha ? 16 : 8;
+            unsigned char *block = out;
+            unsigned char texels[64];
+            for (int by = 0; by < height; by += 4)
+            {
+                for (int bx = 0; bx < width; bx += 4)
+                {
+                    for (int y = 0; y < 4; y++)
+                    {
+                        const int sy = std::min(by + y, height - 1);
+                        for (int x = 0; x < 4; x++)
+                        {
+                            const int sx = std::min(bx + x, width - 1);
+                            memcpy(texels + (y * 4 + x) * 4, rgba + (static_cast<std::size_t>(sy) * width + sx) * 4, 4);
+                        }
+                    }
+                    if (alpha)
+                        EncodeBC3(texels, block);
+                    else
+                        EncodeBC1(texels, block);
+                    block += blockSize;
+                }
+            }
+            return static_cast<std::size_t>(block - out);
+        }
+    };
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+// Standard Headers
+#include <cstddef>
+
+namespace Mirage
+{
+    /// CPU block encoders used by the texture cooker
+    ///
+    /// Every encoder reads a 4x4 block of RGBA8 texels (64 bytes, row major)
+    /// and writes one compressed block.
+    namespace BlockCompression
+    {
+        /// BC1 (DXT1), 8 bytes, opaque colour
+        void EncodeBC1(const unsigned char *rgba, unsigned char *block);
+
+        /// BC3 (DXT5), 16 bytes, interpolated alpha followed by a BC1 colour block
+        void EncodeBC3(const unsigned char *rgba, unsigned char *block);
+
+        /// Compresses a whole RGBA8 image, edge blocks repeat their last row/column
+        ///
+        /// @param alpha true for BC3, false for BC1
+        /// @return The bytes written to out, sized with GetCompressedLevelSize()
+        std::size_t EncodeImage(const unsigned char *rgba, int width, int height, bool alpha, unsigned char *out);
+    };
+};
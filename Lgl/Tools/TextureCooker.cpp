@@ -0,0 +1,323 @@
+// Converts source images into .ltx containers holding the full mip chain in
+// final upload layout, so the runtime can upload straight from a mapping.
+//
+// usage: LglCooker [--srgb] [--compress] <input image> <output.ltx>
+//        LglCooker --virtual <input image> <output.vtx>
+//
+// --compress stores BC1 for opaque images and BC3 for images with alpha
+// --virtual cuts the mip chain into bordered tiles for VirtualTexture
+
+#include "BlockCompression.h"
+#include "../src/CompressedFormats.h"
+#include "../src/LtxFormat.h"
+#include "../src/VtxFormat.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+// Standard Headers
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct Image
+{
+    int width;
+    int height;
+    int channels;
+    std::vector<unsigned char> pixels;
+};
+
+/// Halves an image with a 2x2 box filter, odd edges reuse their last texel
+static Image Downsample(Image const &src)
+{
+    Image dst;
+    dst.width = std::max(1, src.width / 2);
+    dst.height = std::max(1, src.height / 2);
+    dst.channels = src.channels;
+    dst.pixels.resize(static_cast<std::size_t>(dst.width) * dst.height * dst.channels);
+
+    for (int y = 0; y < dst.height; y++)
+    {
+        const int y0 = std::min(y * 2, src.height - 1), y1 = std::min(y * 2 + 1, src.height - 1);
+        for (int x = 0; x < dst.width; x++)
+        {
+            const int x0 = std::min(x * 2, src.width - 1), x1 = std::min(x * 2 + 1, src.width - 1);
+            for (int c = 0; c < src.channels; c++)
+            {
+                const unsigned sum = src.pixels[(y0 * src.width + x0) * src.channels + c] +
+                                     src.pixels[(y0 * src.width + x1) * src.channels + c] +
+                                     src.pixels[(y1 * src.width + x0) * src.channels + c] +
+                                     src.pixels[(y1 * src.width + x1) * src.channels + c];
+                dst.pixels[(y * dst.width + x) * dst.channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+static std::uint32_t InternalFormat(int channels, bool srgb)
+{
+    switch (channels)
+    {
+    case 1:
+        return GL_R8;
+    case 3:
+        return srgb ? GL_SRGB8 : GL_RGB8;
+    default:
+        return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    }
+}
+
+static std::uint32_t Format(int channels)
+{
+    switch (channels)
+    {
+    case 1:
+        return GL_RED;
+    case 3:
+        return GL_RGB;
+    default:
+        return GL_RGBA;
+    }
+}
+
+static bool HasAlpha(Image const &image)
+{
+    if (image.channels != 4)
+        return false;
+    for (std::size_t i = 3; i < image.pixels.size(); i += 4)
+        if (image.pixels[i] != 255)
+            return true;
+    return false;
+}
+
+/// Expands to the RGBA8 layout the block encoders read
+static std::vector<unsigned char> ToRGBA(Image const &image)
+{
+    std::vector<unsigned char> rgba(static_cast<std::size_t>(image.width) * image.height * 4, 255);
+    for (std::size_t i = 0, texels = rgba.size() / 4; i < texels; i++)
+    {
+        const unsigned char *texel = &image.pixels[i * image.channels];
+        // Grey images replicate their single channel into RGB
+        for (int c = 0; c < 3; c++)
+            rgba[i * 4 + c] = texel[image.channels >= 3 ? c : 0];
+        if (image.channels == 4)
+            rgba[i * 4 + 3] = texel[3];
+    }
+    return rgba;
+}
+
+static std::uint64_t Align(std::uint64_t offset)
+{
+    return (offset + Mirage::Ltx::PayloadAlignment - 1) & ~static_cast<std::uint64_t>(Mirage::Ltx::PayloadAlignment - 1);
+}
+
+/// Writes the tiled .vtx layout, tiles are the size of a sparse texture page for RGBA8
+static bool WriteVirtual(Image const &source, std::string const &path)
+{
+    const std::uint32_t tileSize = 128, border = 4, page = tileSize + 2 * border;
+
+    // Pad to a square of power of two tiles, repeating the edges
+    std::uint32_t tiles = 1;
+    while (tiles * tileSize < static_cast<std::uint32_t>(std::max(source.width, source.height)))
+        tiles <<= 1;
+    Image level;
+    level.width = level.height = static_cast<int>(tiles * tileSize);
+    level.channels = 4;
+    level.pixels.resize(static_cast<std::size_t>(level.width) * level.height * 4);
+    const std::vector<unsigned char> rgba = ToRGBA(source);
+    for (int y = 0; y < level.height; y++)
+    {
+        const int sy = std::min(y, source.height - 1);
+        for (int x = 0; x < level.width; x++)
+        {
+            const int sx = std::min(x, source.width - 1);
+            memcpy(&level.pixels[(static_cast<std::size_t>(y) * level.width + x) * 4],
+                   &rgba[(static_cast<std::size_t>(sy) * source.width + sx) * 4], 4);
+        }
+    }
+
+    Mirage::Vtx::Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = Mirage::Vtx::Magic;
+    header.version = Mirage::Vtx::Version;
+    header.width = source.width;
+    header.height = source.height;
+    header.size = level.width;
+    header.tileSize = tileSize;
+    header.border = border;
+    for (std::uint32_t side = tiles; side > 0; side >>= 1)
+        header.levels++;
+    if (header.levels > Mirage::Vtx::MaxLevels)
+    {
+        fprintf(stderr, "%s: %u levels exceed the limit of %u\n", path.c_str(), header.levels, Mirage::Vtx::MaxLevels);
+        return false;
+    }
+
+    const std::uint64_t count = Mirage::Vtx::TileCount(header);
+    const std::uint64_t tileBytes = static_cast<std::uint64_t>(page) * page * 4;
+    std::vector<std::uint64_t> offsets(count);
+    std::uint64_t offset = Align(sizeof(header) + count * sizeof(std::uint64_t));
+    for (auto &tileOffset : offsets)
+    {
+        tileOffset = offset;
+        offset = Align(offset + tileBytes);
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(offsets.data()), count * sizeof(std::uint64_t));
+    const char zeros[Mirage::Vtx::PayloadAlignment] = {};
+    out.write(zeros, offsets[0] - (sizeof(header) + count * sizeof(std::uint64_t)));
+
+    // Tiles are written in table order, so only the alignment padding goes between them
+    std::vector<unsigned char> tile(tileBytes);
+    for (std::uint32_t l = 0; l < header.levels; l++)
+    {
+        const std::uint32_t side = Mirage::Vtx::TilesPerSide(header, l);
+        for (std::uint32_t ty = 0; ty < side; ty++)
+            for (std::uint32_t tx = 0; tx < side; tx++)
+            {
+                for (std::uint32_t y = 0; y < page; y++)
+                {
+                    const int sy = std::min(std::max(static_cast<int>(ty * tileSize + y) - static_cast<int>(border), 0), level.height - 1);
+                    for (std::uint32_t x = 0; x < page; x++)
+                    {
+                        const int sx = std::min(std::max(static_cast<int>(tx * tileSize + x) - static_cast<int>(border), 0), level.width - 1);
+                        memcpy(&tile[(static_cast<std::size_t>(y) * page + x) * 4],
+                               &level.pixels[(static_cast<std::size_t>(sy) * level.width + sx) * 4], 4);
+                    }
+                }
+                out.write(reinterpret_cast<const char *>(tile.data()), tile.size());
+                out.write(zeros, Align(tileBytes) - tileBytes);
+            }
+        level = Downsample(level);
+    }
+
+    if (!out)
+    {
+        fprintf(stderr, "%s: write failed\n", path.c_str());
+        return false;
+    }
+    printf("%dx%d -> %s (%u levels of %u px tiles, %llu tiles, %llu bytes)\n", source.width, source.height, path.c_str(),
+           header.levels, tileSize, static_cast<unsigned long long>(count), static_cast<unsigned long long>(offset));
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bool srgb = false, compress = false, tiled = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--srgb") == 0)
+            srgb = true;
+        else if (strcmp(argv[i], "--compress") == 0)
+            compress = true;
+        else if (strcmp(argv[i], "--virtual") == 0)
+            tiled = true;
+        else
+            files.push_back(argv[i]);
+    }
+    if (files.size() != 2)
+    {
+        fprintf(stderr, "usage: %s [--srgb] [--compress] <input image> <output.ltx>\n", argv[0]);
+        fprintf(stderr, "       %s --virtual <input image> <output.vtx>\n", argv[0]);
+        return 1;
+    }
+
+    // Match the runtime loaders, which flip on load
+    stbi_set_flip_vertically_on_load(true);
+    Image base;
+    unsigned char *pixels = stbi_load(files[0].c_str(), &base.width, &base.height, &base.channels, 0);
+    if (!pixels)
+    {
+        fprintf(stderr, "%s: %s\n", files[0].c_str(), stbi_failure_reason());
+        return 1;
+    }
+    // Two channel images have no matching GL transfer format here, widen them
+    if (base.channels == 2)
+    {
+        stbi_image_free(pixels);
+        pixels = stbi_load(files[0].c_str(), &base.width, &base.height, &base.channels, 4);
+        base.channels = 4;
+    }
+    base.pixels.assign(pixels, pixels + static_cast<std::size_t>(base.width) * base.height * base.channels);
+    stbi_image_free(pixels);
+
+    if (tiled)
+        return WriteVirtual(base, files[1]) ? 0 : 1;
+
+    std::vector<Image> levels(1, base);
+    while ((levels.back().width > 1 || levels.back().height > 1) && levels.size() < Mirage::Ltx::MaxLevels)
+        levels.push_back(Downsample(levels.back()));
+
+    Mirage::Ltx::Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = Mirage::Ltx::Magic;
+    header.version = Mirage::Ltx::Version;
+    header.width = base.width;
+    header.height = base.height;
+    header.levels = static_cast<std::uint32_t>(levels.size());
+    header.internalFormat = InternalFormat(base.channels, srgb);
+    header.format = Format(base.channels);
+    header.type = GL_UNSIGNED_BYTE;
+    header.channels = base.channels;
+
+    // Block compression replaces every level with its encoded blocks
+    if (compress)
+    {
+        const bool alpha = HasAlpha(base);
+        if (alpha)
+            header.internalFormat = srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        else
+            header.internalFormat = srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        header.format = 0;
+        header.type = 0;
+        for (auto &level : levels)
+        {
+            std::vector<unsigned char> rgba = ToRGBA(level);
+            std::vector<unsigned char> blocks(Mirage::GetCompressedLevelSize(header.internalFormat, level.width, level.height));
+            Mirage::BlockCompression::EncodeImage(rgba.data(), level.width, level.height, alpha, blocks.data());
+            level.pixels.swap(blocks);
+        }
+    }
+
+    std::vector<Mirage::Ltx::Level> table(levels.size());
+    std::uint64_t offset = Align(sizeof(header) + table.size() * sizeof(Mirage::Ltx::Level));
+    for (std::size_t i = 0; i < levels.size(); i++)
+    {
+        table[i].offset = offset;
+        table[i].size = levels[i].pixels.size();
+        table[i].width = levels[i].width;
+        table[i].height = levels[i].height;
+        offset = Align(offset + table[i].size);
+    }
+
+    // Payloads follow the table, zero padded up to their aligned offsets
+    const char zeros[Mirage::Ltx::PayloadAlignment] = {};
+    std::ofstream out(files[1], std::ios::binary);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(Mirage::Ltx::Level));
+    std::uint64_t written = sizeof(header) + table.size() * sizeof(Mirage::Ltx::Level);
+    for (std::size_t i = 0; i < levels.size(); i++)
+    {
+        out.write(zeros, table[i].offset - written);
+        out.write(reinterpret_cast<const char *>(levels[i].pixels.data()), levels[i].pixels.size());
+        written = table[i].offset + table[i].size;
+    }
+    out.write(zeros, offset - written);
+
+    if (!out)
+    {
+        fprintf(stderr, "%s: write failed\n", files[1].c_str());
+        return 1;
+    }
+    printf("%s -> %s (%dx%d, %u levels, %llu bytes)\n", files[0].c_str(), files[1].c_str(), base.width, base.height,
+           header.levels, static_cast<unsigned long long>(offset));
+    return 0;
+}
@@ -0,0 +1,1528 @@
+#include "Benchmarks.h"
+#include "BufferArena.h"
+#include "GLState.h"
+#include "IndexBuffer.h"
+#include "IndirectBatch.h"
+#include "MeshOptimizer.h"
+#include "MipGenerator.h"
+#include "PixelUploadRing.h"
+#include "RenderQueue.h"
+#include "SamplerCache.h"
+#include "ScratchArena.h"
+#include "shader.h"
+#include "StreamBuffer.h"
+#include "Texture2D.h"
+#include "TextureArray.h"
+#include "TextureAtlas.h"
+#include "TextureLoader.h"
+#include "TextureTable.h"
+#include "Timer.h"
+#include "VirtualTexture.h"
+#include "VertexArray.h"
+#include "VertexArrayCache.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "VertexFormat.h"
+
+// GLAD
+#include <glad/glad.h>
+// GLM
+#include <glm/gtc/matrix_transform.hpp>
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Mirage
+{
+    namespace Bench
+    {
+        /// Per-call cost of uniform updates through glGetUniformLocation versus the location cache
+        static int uniforms(int, char **)
+        {
+            const int frames = 100;
+            const int updatesPerFrame = 4096;
+
+            Shader shader;
+            shader.attach("main.frag").attach("main.vert");
+            shader.link();
+            shader.activate();
+
+            glm::mat4 model(1.0f);
+            double uncached = 0.0, cached = 0.0;
+            for (int frame = 0; frame < frames; frame++)
+            {
+                // Old path: build a std::string and ask the driver for every update
+                Stopwatch watch;
+                for (int i = 0; i < updatesPerFrame; i++)
+                {
+                    std::string name = (i & 1) ? "model" : "view";
+                    GLint location = glGetUniformLocation(shader.get(), name.c_str());
+                    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(model));
+                }
+                glFinish();
+                uncached += watch.ElapsedMs();
+
+                // Cached path: hashed at compile time, resolved through the flat table
+                watch.Reset();
+                for (int i = 0; i < updatesPerFrame; i++)
+                {
+                    if (i & 1)
+                        shader.bind("model", model);
+                    else
+                        shader.bind("view", model);
+                }
+                glFinish();
+                cached += watch.ElapsedMs();
+            }
+
+            double calls = static_cast<double>(frames) * updatesPerFrame;
+            printf("uniform updates: %d per frame, %d frames\n", updatesPerFrame, frames);
+            printf("\tglGetUniformLocation : %8.1f ns/call, %6.3f ms/frame\n", uncached * 1e6 / calls, uncached / frames);
+            printf("\tlocation cache       : %8.1f ns/call, %6.3f ms/frame\n", cached * 1e6 / calls, cached / frames);
+            return 0;
+        }
+
+        /// Cold (full compile) versus warm (program binary cache) link time per program
+        static int shaders(int, char **)
+        {
+            const char *programs[][2] = {
+                {"main.frag", "main.vert"},
+            };
+
+            printf("program link times (driver side shader caches may still shorten cold links)\n");
+            for (auto const &files : programs)
+            {
+                // Cold: bypass the binary cache, then link again to store the binary
+                Shader::setBinaryCache("");
+                Shader cold;
+                cold.attach(files[0]).attach(files[1]).link();
+                Shader::setBinaryCache("shadercache");
+                Shader store;
+                store.attach(files[0]).attach(files[1]).link();
+
+                // Warm: the binary written above is loaded, nothing is compiled
+                Shader warm;
+                warm.attach(files[0]).attach(files[1]).link();
+                printf("\t%-24s cold %8.3f ms, warm %8.3f ms%s\n", cold.label().c_str(),
+                       cold.linkTime(), warm.linkTime(), warm.linkedFromCache() ? "" : " (cache miss)");
+            }
+            return 0;
+        }
+
+        /// Serial texture loading in the render thread versus the thread-pooled loader
+        static int textures(int argc, char **argv)
+        {
+            const int count = argc > 0 ? atoi(argv[0]) : 48;
+            const char *files[] = {"res/wall.jpg", "res/donot.png", "res/awesomeface.png"};
+
+            Stopwatch watch;
+            {
+                std::vector<std::unique_ptr<Texture2D>> serial;
+                for (int i = 0; i < count; i++)
+                    serial.emplace_back(new Texture2D(files[i % 3]));
+                glFinish();
+            }
+            double serialTime = watch.ElapsedMs();
+
+            watch.Reset();
+            TextureLoader loader;
+            {
+                std::vector<std::shared_ptr<Texture2D>> pooled;
+                for (int i = 0; i < count; i++)
+                    pooled.push_back(loader.Load(files[i % 3]));
+                loader.Finish();
+                glFinish();
+                printf("video memory of %d textures: %.2f MB\n", count, Texture2D::GetTotalMemoryUsage() / 1e6);
+                printf("decode scratch arenas: %.2f MB reserved in total\n", ScratchArena::GetTotalCapacity() / 1e6);
+            }
+            double pooledTime = watch.ElapsedMs();
+
+            // Cooked containers: no decode and no glGenerateMipmap, only the upload is left
+            const char *cooked[] = {"res/wall.ltx", "res/donot.ltx", "res/awesomeface.ltx"};
+            watch.Reset();
+            {
+                std::vector<std::unique_ptr<Texture2D>> mapped;
+                for (int i = 0; i < count; i++)
+                    mapped.emplace_back(new Texture2D(cooked[i % 3]));
+                glFinish();
+            }
+            double cookedTime = watch.ElapsedMs();
+
+            printf("loading %d textures\n", count);
+            printf("\tserial             : %8.1f ms\n", serialTime);
+            printf("\t%2u decode threads  : %8.1f ms (%.2fx)\n", loader.GetThreadCount(), pooledTime, serialTime / pooledTime);
+            printf("\tcooked .ltx        : %8.1f ms (%.2fx)\n", cookedTime, serialTime / cookedTime);
+            return 0;
+        }
+
+        /// Client memory glTexSubImage2D versus staging through the persistently mapped ring
+        static int uploads(int argc, char **argv)
+        {
+            const int count = argc > 0 ? atoi(argv[0]) : 32;
+            const int size = argc > 1 ? atoi(argv[1]) : 1024;
+            if (!PixelUploadRing::IsSupported())
+            {
+                printf("buffer storage unavailable, the ring can't be used\n");
+                return 1;
+            }
+
+            std::vector<unsigned char> pixels(static_cast<std::size_t>(size) * size * 4);
+            for (std::size_t i = 0; i < pixels.size(); i++)
+                pixels[i] = static_cast<unsigned char>(i * 31);
+            std::vector<std::unique_ptr<Texture2D>> textures;
+            for (int i = 0; i < count; i++)
+            {
+                textures.emplace_back(new Texture2D(0));
+                textures.back()->Allocate(size, size, 4);
+            }
+            glFinish();
+            const double megabytes = count * (pixels.size() / 1e6);
+
+            Stopwatch watch;
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            for (auto const &texture : textures)
+            {
+                GLState::BindTexture(GL_TEXTURE_2D, texture->getTexture());
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+            }
+            double directIssue = watch.ElapsedMs();
+            glFinish();
+            double direct = watch.ElapsedMs();
+
+            PixelUploadRing ring;
+            watch.Reset();
+            for (auto const &texture : textures)
+                ring.Upload(texture->getTexture(), 0, size, size, GL_RGBA, 4, pixels.data());
+            double ringIssue = watch.ElapsedMs();
+            glFinish();
+            double staged = watch.ElapsedMs();
+
+            PixelUploadRing::Stats const &stats = ring.GetStats();
+            printf("uploading %d textures of %dx%d RGBA (%.1f MB)\n", count, size, size, megabytes);
+            printf("\tclient memory : issue %8.2f ms, complete %8.2f ms, %8.1f MB/s\n", directIssue, direct, megabytes * 1000.0 / direct);
+            printf("\tupload ring   : issue %8.2f ms, complete %8.2f ms, %8.1f MB/s\n", ringIssue, staged, megabytes * 1000.0 / staged);
+            printf("\t                ring %.1f MB/s while issuing, %u uploads, %u stalls (%.2f ms)\n",
+                   stats.MegabytesPerSecond(), stats.uploads, stats.stalls, stats.stallMs);
+            return 0;
+        }
+
+        /// GPU time of a full screen pass sampling a texture at one texel per pixel
+        static double samplingTime(Shader &shader, Texture2D &texture, int passes)
+        {
+            GLint viewport[4];
+            glGetIntegerv(GL_VIEWPORT, viewport);
+            texture.Bind();
+            shader.bind("image", 0);
+            shader.bind("scale", glm::vec2(static_cast<float>(viewport[2]) / texture.getWidth(),
+                                           static_cast<float>(viewport[3]) / texture.getHeight()));
+
+            GLuint query;
+            GLuint64 elapsed = 0;
+            glGenQueries(1, &query);
+            glBeginQuery(GL_TIME_ELAPSED, query);
+            for (int i = 0; i < passes; i++)
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+            glEndQuery(GL_TIME_ELAPSED);
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+            glDeleteQueries(1, &query);
+            return elapsed / 1e6 / passes;
+        }
+
+        /// Video memory and sampling cost of the cooked textures, uncompressed versus BC1/BC3
+        static int compressed(int argc, char **argv)
+        {
+            const int passes = argc > 0 ? atoi(argv[0]) : 200;
+            const char *names[] = {"wall", "donot", "awesomeface"};
+
+            Shader shader;
+            shader.attach("fullscreen.vert").attach("sample.frag").link().activate();
+            Mirage::VertexArray empty;
+            empty.Bind();
+            SamplerCache samplers;
+            samplers.Bind(0, SamplerState::Trilinear());
+            GLState::Disable(GL_DEPTH_TEST);
+            GLState::Disable(GL_BLEND);
+
+            printf("%-12s %12s %12s %8s %14s %14s\n", "texture", "RGBA8 bytes", "BC bytes", "saved", "RGBA8 ms/pass", "BC ms/pass");
+            for (const char *name : names)
+            {
+                Texture2D plain((std::string("res/") + name + ".ltx").c_str());
+                Texture2D blocks((std::string("res/") + name + ".bc.ltx").c_str());
+                samplingTime(shader, plain, 4); // warm up
+                const double plainTime = samplingTime(shader, plain, passes);
+                samplingTime(shader, blocks, 4);
+                const double blockTime = samplingTime(shader, blocks, passes);
+                printf("%-12s %12zu %12zu %7.1f%% %14.3f %14.3f\n", name, plain.GetMemoryUsage(), blocks.GetMemoryUsage(),
+                       100.0 * (1.0 - static_cast<double>(blocks.GetMemoryUsage()) / plain.GetMemoryUsage()), plainTime, blockTime);
+            }
+            return 0;
+        }
+
+        /// One draw and texture bind per object versus one instanced draw from a texture array
+        static int batching(int argc, char **argv)
+        {
+            const int objects = std::min(argc > 0 ? atoi(argv[0]) : 1024, TextureArray::GetMaxLayers());
+            const int frames = 100;
+            const int size = 64;
+            int columns = 1;
+            while (columns * columns < objects)
+                columns++;
+
+            // Every object gets its own flat colour
+            std::vector<unsigned char> pixels(size * size * 4);
+            std::vector<std::unique_ptr<Texture2D>> separate;
+            TextureArray layers(size, size, objects);
+            for (int i = 0; i < objects; i++)
+            {
+                for (std::size_t p = 0; p < pixels.size(); p += 4)
+                {
+                    pixels[p] = static_cast<unsigned char>(i * 37);
+                    pixels[p + 1] = static_cast<unsigned char>(i * 91);
+                    pixels[p + 2] = static_cast<unsigned char>(i * 13);
+                    pixels[p + 3] = 255;
+                }
+                separate.emplace_back(new Texture2D(0));
+                separate.back()->Upload(pixels.data(), size, size, 4);
+                layers.Add(pixels.data(), size, size, 4);
+            }
+            layers.GenerateMipmaps();
+
+            Shader single, batched;
+            single.attach("grid.vert").attach("grid.frag").link();
+            batched.attach("grid.vert").attach("layers.frag").link();
+            Mirage::VertexArray empty;
+            empty.Bind();
+            SamplerCache samplers;
+            samplers.Bind(0, SamplerState::Trilinear());
+            GLState::Disable(GL_DEPTH_TEST);
+            GLState::Disable(GL_BLEND);
+            glFinish();
+
+            // Separate textures: a bind, a uniform and a draw per object
+            single.activate();
+            single.bind("image", 0);
+            single.bind("columns", columns);
+            Stopwatch watch;
+            for (int frame = 0; frame < frames; frame++)
+                for (int i = 0; i < objects; i++)
+                {
+                    separate[i]->Bind();
+                    single.bind("baseInstance", i);
+                    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+                }
+            double singleIssue = watch.ElapsedMs();
+            glFinish();
+            double singleTime = watch.ElapsedMs();
+
+            // Texture array: the layer comes from the instance, one draw per frame
+            batched.activate();
+            batched.bind("images", 0);
+            batched.bind("columns", columns);
+            batched.bind("baseInstance", 0);
+            layers.Bind(0);
+            watch.Reset();
+            for (int frame = 0; frame < frames; frame++)
+                glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, objects);
+            double batchedIssue = watch.ElapsedMs();
+            glFinish();
+            double batchedTime = watch.ElapsedMs();
+
+            // Mixed sizes go to an atlas instead, report how tightly they pack
+            TextureAtlas atlas(2048, 2048);
+            std::vector<unsigned char> tile(128 * 128 * 4, 255);
+            srand(1);
+            for (int i = 0; i < objects; i++)
+            {
+                if (atlas.Add(tile.data(), 16 + rand() % 112, 16 + rand() % 112, 4) < 0)
+                    break;
+            }
+            atlas.Finish();
+
+            printf("drawing %d objects with distinct %dx%d textures, %d frames\n", objects, size, size, frames);
+            printf("\tseparate textures : issue %8.3f ms/frame, complete %8.3f ms/frame, %d draws/frame\n",
+                   singleIssue / frames, singleTime / frames, objects);
+            printf("\ttexture array     : issue %8.3f ms/frame, complete %8.3f ms/frame, 1 draw/frame (%.2f MB)\n",
+                   batchedIssue / frames, batchedTime / frames, layers.GetMemoryUsage() / 1e6);
+            printf("\tatlas 2048x2048   : %d of %d mixed size images packed, %.1f%% occupied\n",
+                   atlas.GetRegionCount(), objects, 100.0 * atlas.GetOccupancy());
+            return 0;
+        }
+
+        /// Issue rate of one draw per texture from a texture table, bindless versus array mode
+        static double tableDraws(TextureTable &table, int objects, int columns, int frames)
+        {
+            Shader shader;
+            table.Configure(shader);
+            shader.attach("grid.vert").attach("table.frag").link().activate();
+            shader.bind("columns", columns);
+            table.Bind(shader);
+            glFinish();
+
+            // Only the index changes between draws, nothing is bound
+            Stopwatch watch;
+            for (int frame = 0; frame < frames; frame++)
+                for (int i = 0; i < objects; i++)
+                {
+                    shader.bind("baseInstance", i);
+                    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+                }
+            glFinish();
+            return watch.ElapsedMs();
+        }
+
+        /// Draw call throughput with distinct textures: a bind per draw, bindless handles, texture array
+        static int bindless(int argc, char **argv)
+        {
+            const int objects = std::min(argc > 0 ? atoi(argv[0]) : 1000, TextureArray::GetMaxLayers());
+            const int frames = 100;
+            const int size = 32;
+            int columns = 1;
+            while (columns * columns < objects)
+                columns++;
+
+            std::vector<unsigned char> pixels(size * size * 4);
+            std::vector<std::unique_ptr<Texture2D>> separate;
+            TextureTable handles(size, size, objects), layers(size, size, objects, false);
+            for (int i = 0; i < objects; i++)
+            {
+                for (std::size_t p = 0; p < pixels.size(); p += 4)
+                {
+                    pixels[p] = static_cast<unsigned char>(i * 37);
+                    pixels[p + 1] = static_cast<unsigned char>(i * 91);
+                    pixels[p + 2] = static_cast<unsigned char>(i * 13);
+                    pixels[p + 3] = 255;
+                }
+                separate.emplace_back(new Texture2D(0));
+                separate.back()->Upload(pixels.data(), size, size, 4);
+                handles.Add(pixels.data(), size, size, 4);
+                layers.Add(pixels.data(), size, size, 4);
+            }
+            SamplerCache samplers;
+            const GLuint sampler = samplers.Get(SamplerState::Trilinear());
+            handles.Finish(sampler);
+            layers.Finish(sampler);
+
+            Mirage::VertexArray empty;
+            empty.Bind();
+            GLState::Disable(GL_DEPTH_TEST);
+            GLState::Disable(GL_BLEND);
+
+            Shader single;
+            single.attach("grid.vert").attach("grid.frag").link().activate();
+            single.bind("image", 0);
+            GLState::BindSampler(0, sampler);
+            single.bind("columns", columns);
+            glFinish();
+            Stopwatch watch;
+            for (int frame = 0; frame < frames; frame++)
+                for (int i = 0; i < objects; i++)
+                {
+                    separate[i]->Bind();
+                    single.bind("baseInstance", i);
+                    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+                }
+            glFinish();
+            const double boundTime = watch.ElapsedMs();
+            const double handleTime = tableDraws(handles, objects, columns, frames);
+            const double layerTime = tableDraws(layers, objects, columns, frames);
+
+            const double draws = static_cast<double>(objects) * frames;
+            printf("%d draws per frame with distinct %dx%d textures, %d frames\n", objects, size, size, frames);
+            printf("\tbind per draw  : %8.3f ms/frame, %6.2f M draws/s\n", boundTime / frames, draws / boundTime / 1e3);
+            if (handles.IsBindless())
+                printf("\tbindless       : %8.3f ms/frame, %6.2f M draws/s\n", handleTime / frames, draws / handleTime / 1e3);
+            else
+                printf("\tbindless       : unsupported, fell back to a texture array\n");
+            printf("\ttexture array  : %8.3f ms/frame, %6.2f M draws/s\n", layerTime / frames, draws / layerTime / 1e3);
+            return 0;
+        }
+
+        /// Zooms into a virtual texture and reports how much of it had to be streamed
+        static int virtualTexture(int argc, char **argv)
+        {
+            const char *path = argc > 0 ? argv[0] : "res/wall.vtx";
+            const int frames = argc > 1 ? atoi(argv[1]) : 300;
+            const int cachePages = argc > 2 ? atoi(argv[2]) : 16;
+
+            VirtualTexture image(path, cachePages);
+            if (!image.IsOpen())
+                return 1;
+
+            Shader feedback, sampling;
+            image.Configure(feedback, true);
+            feedback.attach("fullscreen.vert").attach("virtual.frag").link();
+            image.Configure(sampling, false);
+            sampling.attach("fullscreen.vert").attach("virtual.frag").link();
+            SamplerCache samplers;
+            Mirage::VertexArray empty;
+            empty.Bind();
+            GLState::Disable(GL_DEPTH_TEST);
+            GLState::Disable(GL_BLEND);
+
+            Stopwatch watch;
+            double feedbackTime = 0.0, updateTime = 0.0;
+            for (int frame = 0; frame < frames; frame++)
+            {
+                // Zoom from the whole image into a corner sixteen times magnified and pan across
+                const float t = static_cast<float>(frame) / frames;
+                const float zoom = std::pow(16.0f, -t);
+                const glm::vec2 offset(t * (1.0f - zoom), 0.5f * t * (1.0f - zoom));
+
+                Stopwatch step;
+                feedback.activate();
+                feedback.bind("scale", glm::vec2(zoom));
+                feedback.bind("offset", offset);
+                image.Bind(feedback, samplers, 0, true);
+                image.BeginFeedback();
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+                image.EndFeedback();
+                feedbackTime += step.ElapsedMs();
+
+                step.Reset();
+                image.Update();
+                updateTime += step.ElapsedMs();
+
+                sampling.activate();
+                sampling.bind("scale", glm::vec2(zoom));
+                sampling.bind("offset", offset);
+                image.Bind(sampling, samplers, 0, false);
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+                glFinish();
+            }
+            const double total = watch.ElapsedMs();
+
+            VirtualTexture::Stats const &stats = image.GetStats();
+            printf("%s through a %d page %s cache, %d frames\n", path, image.GetPageCapacity(),
+                   image.IsSparse() ? "sparse texture" : "indirection", frames);
+            printf("\tframe %8.3f ms, feedback %8.3f ms, update %8.3f ms\n", total / frames, feedbackTime / frames, updateTime / frames);
+            printf("\t%u tiles uploaded, %u evicted, %u resident, %u requested in the last feedback\n", stats.uploads,
+                   stats.evictions, stats.resident, stats.requests);
+            printf("\tvideo memory %.2f MB, fully loaded mip chain %.2f MB\n", image.GetMemoryUsage() / 1e6,
+                   image.GetVirtualSize() / 1e6);
+            return 0;
+        }
+
+        /// Mip chain generation on the CPU per filter and instruction set, against glGenerateMipmap
+        static int mips(int argc, char **argv)
+        {
+            const int size = argc > 0 ? atoi(argv[0]) : 2048;
+            const int runs = argc > 1 ? atoi(argv[1]) : 5;
+
+            // Smooth gradients with a hard edged alpha mask, so every mode has real work to do
+            std::vector<unsigned char> pixels(static_cast<std::size_t>(size) * size * 4);
+            for (int y = 0; y < size; y++)
+                for (int x = 0; x < size; x++)
+                {
+                    unsigned char *texel = &pixels[(static_cast<std::size_t>(y) * size + x) * 4];
+                    texel[0] = static_cast<unsigned char>(x * 255 / size);
+                    texel[1] = static_cast<unsigned char>(y * 255 / size);
+                    texel[2] = static_cast<unsigned char>((x ^ y) & 0xff);
+                    texel[3] = ((x / 16 + y / 16) & 1) ? 255 : 0;
+                }
+            std::vector<unsigned char> chain(MipGenerator::GetChainSize(size, size));
+
+            struct Mode
+            {
+                const char *name;
+                MipGenerator::Filter filter;
+                bool srgb;
+                bool premultiplied;
+            };
+            const Mode modes[] = {
+                {"box           ", MipGenerator::Box, false, false},
+                {"box sRGB      ", MipGenerator::Box, true, false},
+                {"box premul    ", MipGenerator::Box, false, true},
+                {"kaiser sRGB   ", MipGenerator::Kaiser, true, false},
+            };
+
+            // Scratch memory comes from an arena the way it does on the loader workers
+            ScratchArena arena;
+            ScratchArena::Scope scope(arena);
+            printf("mip chain of a %dx%d RGBA image, best of %d runs\n", size, size, runs);
+            for (auto const &mode : modes)
+            {
+                printf("\t%s:", mode.name);
+                for (int simd = MipGenerator::Scalar; simd <= MipGenerator::GetSupportedSimd(); simd++)
+                {
+                    MipGenerator generator(mode.filter, static_cast<MipGenerator::Simd>(simd));
+                    generator.SetSRGB(mode.srgb);
+                    generator.SetPremultipliedAlpha(mode.premultiplied);
+                    double best = 1e30;
+                    for (int run = 0; run < runs; run++)
+                    {
+                        arena.Reset();
+                        Stopwatch watch;
+                        generator.Generate(pixels.data(), size, size, chain.data());
+                        best = std::min(best, watch.ElapsedMs());
+                    }
+                    printf(" %s %8.2f ms", MipGenerator::GetSimdName(generator.GetSimd()), best);
+                }
+                printf("\n");
+            }
+
+            // The driver only gets level 0, upload it first so only the generation is timed
+            printf("\tglGenerateMipmap on %s:", reinterpret_cast<const char *>(glGetString(GL_RENDERER)));
+            for (int srgb = 0; srgb < 2; srgb++)
+            {
+                Texture2D texture(0);
+                texture.SetSRGB(srgb != 0);
+                texture.Allocate(size, size, 4);
+                texture.UploadRegion(0, 0, size, size, 4, pixels.data());
+                double best = 1e30;
+                for (int run = 0; run < runs; run++)
+                {
+                    glFinish();
+                    Stopwatch watch;
+                    texture.GenerateMipmaps();
+                    glFinish();
+                    best = std::min(best, watch.ElapsedMs());
+                }
+                printf(" %s %8.2f ms", srgb ? "sRGB" : "RGBA", best);
+            }
+            printf("\n");
+            return 0;
+        }
+
+        /// Per frame vertex streaming through glBufferSubData, orphaning and a persistently mapped StreamBuffer
+        static int streaming(int argc, char **argv)
+        {
+            const int frames = argc > 0 ? atoi(argv[0]) : 300;
+            const int vertices = argc > 1 ? atoi(argv[1]) : 65536;
+            const int chunks = argc > 2 ? atoi(argv[2]) : 16;
+
+            // Small triangles scattered over the screen, each chunk is written then drawn right away
+            VertexBufferLayout layout;
+            layout.push<float>(3);
+            layout.push<float>(2);
+            const unsigned int stride = layout.GetStride();
+            const int chunkVertices = vertices / chunks / 3 * 3;
+            const unsigned int chunkSize = chunkVertices * stride;
+            std::vector<float> data(static_cast<std::size_t>(chunkVertices) * 5);
+            for (std::size_t i = 0; i < data.size(); i++)
+                data[i] = static_cast<float>(static_cast<int>(i * 2654435761u % 2001) - 1000) / 1000.0f;
+
+            Shader shader;
+            shader.attach("main.frag").attach("main.vert").link().activate();
+            shader.bind("model", glm::mat4(1.0f)).bind("view", glm::mat4(1.0f)).bind("projection", glm::mat4(1.0f));
+            GLState::Disable(GL_DEPTH_TEST);
+            const double megabytes = static_cast<double>(chunkSize) * chunks * frames / 1e6;
+
+            // glBufferSubData into one buffer, each write waits for the draw reading the previous chunk
+            VertexBuffer single(nullptr, chunkSize, GL_DYNAMIC_DRAW);
+            VertexArray singleArray;
+            singleArray.AddBuffer(single, layout);
+            singleArray.Bind();
+            glFinish();
+            Stopwatch watch;
+            for (int frame = 0; frame < frames; frame++)
+            {
+                for (int chunk = 0; chunk < chunks; chunk++)
+                {
+                    single.Update(data.data(), chunkSize);
+                    glDrawArrays(GL_TRIANGLES, 0, chunkVertices);
+                }
+                glFlush();
+            }
+            const double subDataIssue = watch.ElapsedMs();
+            glFinish();
+            const double subData = watch.ElapsedMs();
+
+            // Orphaning, the driver hands out fresh storage for every chunk
+            VertexBuffer orphaned(nullptr, chunkSize, GL_STREAM_DRAW);
+            VertexArray orphanedArray;
+            orphanedArray.AddBuffer(orphaned, layout);
+            orphanedArray.Bind();
+            glFinish();
+            watch.Reset();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                for (int chunk = 0; chunk < chunks; chunk++)
+                {
+                    orphaned.Orphan(data.data(), chunkSize);
+                    glDrawArrays(GL_TRIANGLES, 0, chunkVertices);
+                }
+                glFlush();
+            }
+            const double orphanIssue = watch.ElapsedMs();
+            glFinish();
+            const double orphan = watch.ElapsedMs();
+
+            // Persistent mapping, plain memcpy and a fence per frame
+            StreamBuffer stream(GL_ARRAY_BUFFER, static_cast<std::size_t>(chunkSize) * chunks);
+            VertexArray streamArray;
+            streamArray.AddBuffer(stream, layout);
+            streamArray.Bind();
+            glFinish();
+            watch.Reset();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                for (int chunk = 0; chunk < chunks; chunk++)
+                {
+                    const std::ptrdiff_t offset = stream.Write(data.data(), chunkSize, stride);
+                    stream.Flush();
+                    glDrawArrays(GL_TRIANGLES, static_cast<GLint>(offset / stride), chunkVertices);
+                }
+                stream.EndFrame();
+                glFlush();
+            }
+            const double streamIssue = watch.ElapsedMs();
+            glFinish();
+            const double streamed = watch.ElapsedMs();
+
+            StreamBuffer::Stats const &stats = stream.GetStats();
+            printf("streaming %d vertices per frame in %d chunks, %d frames (%.1f MB)\n", chunkVertices * chunks,
+                   chunks, frames, megabytes);
+            printf("\tglBufferSubData : issue %8.3f ms/frame, complete %8.3f ms/frame, %8.1f MB/s\n",
+                   subDataIssue / frames, subData / frames, megabytes * 1000.0 / subData);
+            printf("\torphaning       : issue %8.3f ms/frame, complete %8.3f ms/frame, %8.1f MB/s\n",
+                   orphanIssue / frames, orphan / frames, megabytes * 1000.0 / orphan);
+            printf("\tstream buffer   : issue %8.3f ms/frame, complete %8.3f ms/frame, %8.1f MB/s\n",
+                   streamIssue / frames, streamed / frames, megabytes * 1000.0 / streamed);
+            printf("\t                  %s, %u stalls (%.2f ms), %u overflows\n",
+                   stream.IsPersistent() ? "persistently mapped" : "glBufferSubData fallback", stats.stalls,
+                   stats.stallMs, stats.overflows);
+            return 0;
+        }
+
+        /// A buffer, index buffer and VAO per mesh against one BufferArena drawn with base vertices
+        static int arena(int argc, char **argv)
+        {
+            const int meshes = argc > 0 ? atoi(argv[0]) : 4096;
+            const int frames = argc > 1 ? atoi(argv[1]) : 100;
+
+            VertexBufferLayout layout;
+            layout.push<float>(3);
+            layout.push<float>(2);
+            // One small quad per mesh scattered over the screen, indices relative to its first vertex
+            const unsigned int quad[] = {0, 1, 2, 2, 3, 0};
+            std::vector<float> vertices(static_cast<std::size_t>(meshes) * 20);
+            for (int i = 0; i < meshes; i++)
+            {
+                const float x = (i % 64) / 32.0f - 1.0f, y = (i / 64 % 64) / 32.0f - 1.0f, size = 1.0f / 40.0f;
+                const float corners[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+                for (int v = 0; v < 4; v++)
+                {
+                    float *vertex = &vertices[(static_cast<std::size_t>(i) * 4 + v) * 5];
+                    vertex[0] = x + corners[v][0] * size;
+                    vertex[1] = y + corners[v][1] * size;
+                    vertex[2] = 0.0f;
+                    vertex[3] = corners[v][0];
+                    vertex[4] = corners[v][1];
+                }
+            }
+
+            Shader shader;
+            shader.attach("main.frag").attach("main.vert").link().activate();
+            shader.bind("model", glm::mat4(1.0f)).bind("view", glm::mat4(1.0f)).bind("projection", glm::mat4(1.0f));
+            GLState::Disable(GL_DEPTH_TEST);
+
+            // Separate objects, every draw switches the VAO and with it both buffers
+            struct Separate
+            {
+                std::unique_ptr<VertexBuffer> vertices;
+                std::unique_ptr<IndexBuffer> indices;
+                std::unique_ptr<VertexArray> array;
+            };
+            std::vector<Separate> separate(meshes);
+            Stopwatch watch;
+            for (int i = 0; i < meshes; i++)
+            {
+                separate[i].vertices.reset(new VertexBuffer(&vertices[static_cast<std::size_t>(i) * 20], 4 * layout.GetStride()));
+                separate[i].array.reset(new VertexArray());
+                separate[i].array->AddBuffer(*separate[i].vertices, layout);
+                separate[i].indices.reset(new IndexBuffer(quad, 6));
+                separate[i].array->SetIndexBuffer(*separate[i].indices);
+            }
+            glFinish();
+            const double separateCreate = watch.ElapsedMs();
+            watch.Reset();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                for (auto const &mesh : separate)
+                {
+                    mesh.array->Bind();
+                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+                }
+                glFinish();
+            }
+            const double separateDraw = watch.ElapsedMs();
+            separate.clear();
+
+            // The arena starts small so the fill grows it a few times
+            BufferArena pool(layout, 1024, 1536);
+            std::vector<BufferArena::Handle> handles;
+            watch.Reset();
+            for (int i = 0; i < meshes; i++)
+                handles.push_back(pool.Add(&vertices[static_cast<std::size_t>(i) * 20], 4, quad, 6));
+            glFinish();
+            const double arenaCreate = watch.ElapsedMs();
+            watch.Reset();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                pool.Bind();
+                for (BufferArena::Handle handle : handles)
+                    pool.Draw(handle);
+                glFinish();
+            }
+            const double arenaDraw = watch.ElapsedMs();
+
+            // Churn: drop every other mesh and add larger ones, then pack
+            for (std::size_t i = 0; i < handles.size(); i += 2)
+                pool.Remove(handles[i]);
+            std::vector<float> larger(vertices.begin(), vertices.begin() + 3 * 20);
+            const unsigned int strip[] = {0, 1, 2, 2, 3, 0, 4, 5, 6, 6, 7, 4, 8, 9, 10, 10, 11, 8};
+            for (int i = 0; i < meshes / 4; i++)
+                pool.Add(larger.data(), 12, strip, 18);
+            const float fragmented = pool.GetVertexRanges().GetFragmentation();
+            watch.Reset();
+            pool.Defragment();
+            glFinish();
+            const double defragment = watch.ElapsedMs();
+
+            const double draws = static_cast<double>(meshes) * frames;
+            BufferArena::Stats const &stats = pool.GetStats();
+            printf("%d quad meshes, %d frames\n", meshes, frames);
+            printf("\tseparate buffers : create %8.2f ms, %8.3f ms/frame, %6.2f M draws/s, %d buffer objects\n",
+                   separateCreate, separateDraw / frames, draws / separateDraw / 1e3, meshes * 2);
+            printf("\tbuffer arena     : create %8.2f ms, %8.3f ms/frame, %6.2f M draws/s, 2 buffer objects\n",
+                   arenaCreate, arenaDraw / frames, draws / arenaDraw / 1e3);
+            printf("\t                   %u grows, %.2f MB, after churn %.0f%% fragmented, defragment %.2f ms\n",
+                   stats.grows, pool.GetMemoryUsage() / 1e6, fragmented * 100.0f, defragment);
+            return 0;
+        }
+
+        /// Binds and state per draw passed straight to GL versus filtered through the state cache
+        static int state(int argc, char **argv)
+        {
+            const int frames = argc > 0 ? atoi(argv[0]) : 200;
+            const int objects = argc > 1 ? atoi(argv[1]) : 4096;
+            const int materials = 8;
+
+            const float vertices[] = {-0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f,
+                                      0.5f, 0.5f, 0.0f, 1.0f, 1.0f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f};
+            const unsigned int quad[] = {0, 1, 2, 2, 3, 0};
+            VertexBufferLayout layout;
+            layout.push<float>(3);
+            layout.push<float>(2);
+            VertexBuffer vbo(vertices, sizeof(vertices));
+            VertexArray vao;
+            vao.AddBuffer(vbo, layout);
+            IndexBuffer ibo(quad, 6);
+
+            // Two programs and a flat coloured texture per material, objects sorted by material
+            Shader programs[2];
+            for (Shader &program : programs)
+            {
+                program.attach("main.frag").attach("main.vert").link().activate();
+                program.bind("texture1", 0).bind("texture2", 1);
+                program.bind("view", glm::mat4(1.0f)).bind("projection", glm::mat4(1.0f));
+            }
+            std::vector<std::unique_ptr<Texture2D>> textures;
+            for (int i = 0; i < materials; i++)
+            {
+                const unsigned char pixel[] = {static_cast<unsigned char>(i * 31), static_cast<unsigned char>(i * 67), 128, 255};
+                textures.emplace_back(new Texture2D(0));
+                textures.back()->Upload(pixel, 1, 1, 4);
+            }
+            SamplerCache samplers;
+
+            // The loop a scene without sorting or batching runs: every object sets everything it needs
+            auto drawFrame = [&]() {
+                for (int i = 0; i < objects; i++)
+                {
+                    const int material = i * materials / objects;
+                    Shader &program = programs[material & 1];
+                    program.activate();
+                    textures[material]->Bind(0);
+                    textures[(material + 1) % materials]->Bind(1);
+                    samplers.Bind(0, SamplerState::Trilinear());
+                    samplers.Bind(1, SamplerState::Trilinear());
+                    GLState::Enable(GL_BLEND);
+                    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                    GLState::Disable(GL_DEPTH_TEST);
+                    vao.Bind();
+                    ibo.Bind();
+                    program.bind("model", glm::translate(glm::mat4(1.0f), glm::vec3((i % 64) / 32.0f - 1.0f, (i / 64 % 64) / 32.0f - 1.0f, 0.0f)) *
+                                              glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / 40.0f)));
+                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+                }
+                GLState::EndFrame();
+            };
+
+            printf("%d objects, %d materials, %d frames\n", objects, materials, frames);
+            const bool enabled[] = {false, true};
+            for (bool cached : enabled)
+            {
+                GLState::SetEnabled(cached);
+                GLState::Invalidate();
+                drawFrame(); // warm up
+                glFinish();
+                Stopwatch watch;
+                for (int frame = 0; frame < frames; frame++)
+                    drawFrame();
+                const double issue = watch.ElapsedMs();
+                glFinish();
+                const double total = watch.ElapsedMs();
+                GLState::Counters const &counters = GLState::GetFrameCounters();
+                printf("\t%-14s: %8.3f ms/frame issued, %8.3f ms/frame total, %7u calls issued, %7u elided per frame\n",
+                       cached ? "state cache" : "direct", issue / frames, total / frames, counters.issued, counters.elided);
+            }
+            GLState::SetEnabled(true);
+            return 0;
+        }
+
+        /// Draws in submission order versus sorted by key through the render queue
+        static int queue(int argc, char **argv)
+        {
+            const int objects = argc > 0 ? atoi(argv[0]) : 10000;
+            const int frames = argc > 1 ? atoi(argv[1]) : 100;
+            const int programCount = 4, meshCount = 8, textureCount = 16;
+
+            // A few quads with slightly different shapes stand in for meshes
+            VertexBufferLayout layout;
+            layout.push<float>(3);
+            layout.push<float>(2);
+            std::vector<std::unique_ptr<VertexBuffer>> buffers;
+            std::vector<std::unique_ptr<VertexArray>> meshes;
+            for (int i = 0; i < meshCount; i++)
+            {
+                const float h = 0.5f + 0.05f * i;
+                const float vertices[] = {-0.5f, -h, 0.0f, 0.0f, 0.0f, 0.5f, -h, 0.0f, 1.0f, 0.0f,
+                                          -0.5f, h, 0.0f, 0.0f, 1.0f, 0.5f, h, 0.0f, 1.0f, 1.0f};
+                buffers.emplace_back(new VertexBuffer(vertices, sizeof(vertices)));
+                meshes.emplace_back(new VertexArray());
+                meshes.back()->AddBuffer(*buffers.back(), layout);
+            }
+            Shader programs[programCount];
+            for (Shader &program : programs)
+            {
+                program.attach("main.frag").attach("main.vert").link().activate();
+                program.bind("texture1", 0).bind("texture2", 1);
+                program.bind("view", glm::mat4(1.0f)).bind("projection", glm::mat4(1.0f));
+            }
+            std::vector<std::unique_ptr<Texture2D>> textures;
+            for (int i = 0; i < textureCount; i++)
+            {
+                const unsigned char pixel[] = {static_cast<unsigned char>(i * 15), static_cast<unsigned char>(255 - i * 15), 64, 255};
+                textures.emplace_back(new Texture2D(0));
+                textures.back()->Upload(pixel, 1, 1, 4);
+            }
+            SamplerCache samplers;
+            samplers.Bind(0, SamplerState::Trilinear());
+            samplers.Bind(1, SamplerState::Trilinear());
+            GLState::Disable(GL_DEPTH_TEST);
+
+            // Objects pick their program, mesh and textures at random, as a scene graph walk would visit them
+            srand(1);
+            std::vector<DrawCommand> commands(objects);
+            std::vector<std::uint64_t> keys(objects);
+            for (int i = 0; i < objects; i++)
+            {
+                DrawCommand &command = commands[i];
+                const int program = rand() % programCount, mesh = rand() % meshCount, texture = rand() % textureCount;
+                command.program = &programs[program];
+                command.vertexArray = meshes[mesh]->GetRendererID();
+                std::fill(command.textures, command.textures + DrawCommand::MaxTextures, 0u);
+                command.textures[0] = textures[texture]->getTexture();
+                command.textures[1] = textures[(texture + 1) % textureCount]->getTexture();
+                command.mode = GL_TRIANGLE_STRIP;
+                command.indexed = false;
+                command.first = 0;
+                command.count = 4;
+                command.model = glm::translate(glm::mat4(1.0f), glm::vec3((i % 100) / 50.0f - 1.0f, (i / 100 % 100) / 50.0f - 1.0f, 0.0f)) *
+                                glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / 60.0f));
+                keys[i] = RenderQueue::MakeKey(0, program, mesh, texture, static_cast<float>(rand()) / RAND_MAX);
+            }
+
+            RenderQueue queue;
+            printf("%d objects, %d programs, %d meshes, %d textures, %d frames\n", objects, programCount, meshCount,
+                   textureCount, frames);
+            const bool sorting[] = {false, true};
+            for (bool sorted : sorting)
+            {
+                double sortTime = 0.0;
+                GLState::Invalidate();
+                glFinish();
+                Stopwatch watch;
+                for (int frame = 0; frame < frames; frame++)
+                {
+                    queue.Clear();
+                    for (int i = 0; i < objects; i++)
+                        queue.Submit(keys[i], commands[i]);
+                    if (sorted)
+                    {
+                        Stopwatch sortWatch;
+                        queue.Sort();
+                        sortTime += sortWatch.ElapsedMs();
+                    }
+                    queue.Dispatch();
+                    GLState::EndFrame();
+                }
+                glFinish();
+                const double total = watch.ElapsedMs();
+                RenderQueue::Stats const &stats = queue.GetStats();
+                GLState::Counters const &counters = GLState::GetFrameCounters();
+                printf("\t%-10s: %8.3f ms/frame (sort %6.3f), switches per frame: %6u programs, %6u VAOs, %6u textures, "
+                       "%7u GL state calls\n",
+                       sorted ? "sorted" : "submitted", total / frames, sortTime / frames, stats.dispatched.programs,
+                       stats.dispatched.vertexArrays, stats.dispatched.textures, counters.issued);
+            }
+            return 0;
+        }
+
+        /// A draw call per mesh versus one multi-draw indirect call for all of them
+        static int indirect(int argc, char **argv)
+        {
+            const int objects = argc > 0 ? atoi(argv[0]) : 10000;
+            const int frames = argc > 1 ? atoi(argv[1]) : 100;
+            const int layers = 16;
+
+            // Every object is its own mesh, a quad with a slightly different shape
+            VertexBufferLayout layout;
+            layout.push<float>(3);
+            layout.push<float>(2);
+            BufferArena arena(layout, static_cast<std::uint32_t>(objects) * 4, static_cast<std::uint32_t>(objects) * 6);
+            const unsigned int quad[] = {0, 1, 2, 2, 3, 0};
+            std::vector<BufferArena::Handle> meshes;
+            std::vector<glm::mat4> models;
+            for (int i = 0; i < objects; i++)
+            {
+                const float h = 0.5f + 0.5f * (i % 97) / 97.0f;
+                const float vertices[] = {-0.5f, -h, 0.0f, 0.0f, 0.0f, 0.5f, -h, 0.0f, 1.0f, 0.0f,
+                                          0.5f, h, 0.0f, 1.0f, 1.0f, -0.5f, h, 0.0f, 0.0f, 1.0f};
+                meshes.push_back(arena.Add(vertices, 4, quad, 6));
+                models.push_back(glm::translate(glm::mat4(1.0f), glm::vec3((i % 128) / 64.0f - 1.0f, (i / 128 % 128) / 64.0f - 1.0f, 0.0f)) *
+                                 glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / 80.0f)));
+            }
+
+            TextureArray colours(1, 1, layers);
+            for (int i = 0; i < layers; i++)
+            {
+                const unsigned char pixel[] = {static_cast<unsigned char>(i * 16), 200, static_cast<unsigned char>(255 - i * 16), 255};
+                colours.Add(pixel, 1, 1, 4);
+            }
+            colours.GenerateMipmaps();
+            SamplerCache samplers;
+            samplers.Bind(0, SamplerState::Trilinear());
+            GLState::Disable(GL_DEPTH_TEST);
+
+            // One draw and one model upload per object
+            Shader single;
+            single.attach("main.frag").attach("main.vert").link().activate();
+            single.bind("view", glm::mat4(1.0f)).bind("projection", glm::mat4(1.0f));
+            arena.Bind();
+            glFinish();
+            Stopwatch watch;
+            for (int frame = 0; frame < frames; frame++)
+            {
+                for (int i = 0; i < objects; i++)
+                {
+                    single.bind("model", models[i]);
+                    arena.Draw(meshes[i]);
+                }
+                glFinish();
+            }
+            const double singleTime = watch.ElapsedMs();
+
+            // One multi-draw, the per-draw data lives in a storage buffer
+            Shader batched;
+            batched.attach("layers.frag").attach("indirect.vert").link().activate();
+            batched.bind("view", glm::mat4(1.0f)).bind("projection", glm::mat4(1.0f)).bind("images", 0);
+            colours.Bind(0);
+            IndirectBatch batch(arena);
+            for (int i = 0; i < objects; i++)
+                batch.Add(meshes[i], models[i], static_cast<std::uint32_t>(i % layers));
+            batch.Draw(); // first upload
+            glFinish();
+            watch.Reset();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                batch.Draw();
+                glFinish();
+            }
+            const double staticTime = watch.ElapsedMs();
+
+            // Every object moves, the whole storage buffer is uploaded per frame
+            watch.Reset();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                const glm::mat4 offset = glm::translate(glm::mat4(1.0f), glm::vec3(0.001f * frame, 0.0f, 0.0f));
+                for (int i = 0; i < objects; i++)
+                    batch.SetModel(static_cast<std::uint32_t>(i), offset * models[i]);
+                batch.Draw();
+                glFinish();
+            }
+            const double movingTime = watch.ElapsedMs();
+
+            const double draws = static_cast<double>(objects) * frames;
+            printf("%d distinct meshes from one arena, %d frames\n", objects, frames);
+            printf("\tdraw per mesh      : %8.3f ms/frame, %6.2f M draws/s\n", singleTime / frames, draws / singleTime / 1e3);
+            printf("\tmulti-draw, static : %8.3f ms/frame, %6.2f M draws/s\n", staticTime / frames, draws / staticTime / 1e3);
+            printf("\tmulti-draw, moving : %8.3f ms/frame, %6.2f M draws/s\n", movingTime / frames, draws / movingTime / 1e3);
+            return 0;
+        }
+
+        /// A draw and model upload per cube versus one instanced draw with a per-instance matrix stream
+        static int instancing(int argc, char **argv)
+        {
+            const int instances = argc > 0 ? atoi(argv[0]) : 100000;
+            const int frames = argc > 1 ? atoi(argv[1]) : 20;
+
+            // The demo's cube, position and texture coordinates per vertex
+            std::vector<float> cube;
+            const float corners[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+            const int quad[] = {0, 1, 2, 2, 3, 0};
+            for (int face = 0; face < 6; face++)
+                for (int corner : quad)
+                {
+                    float position[3];
+                    const int axis = face / 2;
+                    position[axis] = face % 2 ? 0.5f : -0.5f;
+                    position[(axis + 1) % 3] = corners[corner][0] - 0.5f;
+                    position[(axis + 2) % 3] = corners[corner][1] - 0.5f;
+                    cube.insert(cube.end(), position, position + 3);
+                    cube.push_back(corners[corner][0]);
+                    cube.push_back(corners[corner][1]);
+                }
+            const GLsizei vertexCount = static_cast<GLsizei>(cube.size() / 5);
+
+            std::vector<glm::mat4> models(instances);
+            int side = 1;
+            while (side * side * side < instances)
+                side++;
+            for (int i = 0; i < instances; i++)
+            {
+                const glm::vec3 cell(i % side, i / side % side, i / (side * side));
+                models[i] = glm::scale(glm::translate(glm::mat4(1.0f), cell * (2.0f / side) - glm::vec3(1.0f)), glm::vec3(0.5f / side));
+            }
+
+            VertexBufferLayout vertexLayout;
+            vertexLayout.push<float>(3);
+            vertexLayout.push<float>(2);
+            VertexBufferLayout instanceLayout(1);
+            instanceLayout.push<float>(16);
+            VertexBuffer vertices(cube.data(), static_cast<unsigned int>(cube.size() * sizeof(float)));
+            VertexBuffer matrices(models.data(), static_cast<unsigned int>(models.size() * sizeof(glm::mat4)), GL_DYNAMIC_DRAW);
+            VertexArray single, instanced;
+            single.AddBuffer(vertices, vertexLayout);
+            instanced.AddBuffer(vertices, vertexLayout);
+            instanced.AddBuffer(matrices, instanceLayout);
+            GLState::Enable(GL_DEPTH_TEST);
+
+            // A model uniform and a draw per cube
+            Shader perDraw;
+            perDraw.attach("main.frag").attach("main.vert").link().activate();
+            perDraw.bind("view", glm::mat4(1.0f)).bind("projection", glm::mat4(1.0f));
+            single.Bind();
+            glFinish();
+            Stopwatch watch;
+            for (int frame = 0; frame < frames; frame++)
+            {
+                glClear(GL_DEPTH_BUFFER_BIT);
+                for (int i = 0; i < instances; i++)
+                {
+                    perDraw.bind("model", models[i]);
+                    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+                }
+                glFinish();
+            }
+            const double singleTime = watch.ElapsedMs();
+
+            // The matrices come from the instance stream, one draw for every cube
+            Shader perInstance;
+            perInstance.attach("main.frag").attach("instanced.vert").link().activate();
+            perInstance.bind("view", glm::mat4(1.0f)).bind("projection", glm::mat4(1.0f));
+            instanced.Bind();
+            glFinish();
+            watch.Reset();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                glClear(GL_DEPTH_BUFFER_BIT);
+                glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, instances);
+                glFinish();
+            }
+            const double staticTime = watch.ElapsedMs();
+
+            // Moving cubes rewrite the stream every frame
+            watch.Reset();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                const glm::mat4 offset = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.001f * frame, 0.0f));
+                for (int i = 0; i < instances; i++)
+                    models[i] = offset * models[i];
+                matrices.Orphan(models.data(), static_cast<unsigned int>(models.size() * sizeof(glm::mat4)));
+                glClear(GL_DEPTH_BUFFER_BIT);
+                glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, instances);
+                glFinish();
+            }
+            const double movingTime = watch.ElapsedMs();
+
+            printf("%d cubes, %d frames\n", instances, frames);
+            printf("\tdraw per cube       : %9.3f ms/frame, %d draw calls\n", singleTime / frames, instances);
+            printf("\tinstanced, static   : %9.3f ms/frame, 1 draw call\n", staticTime / frames);
+            printf("\tinstanced, moving   : %9.3f ms/frame, 1 draw call, %.2f MB streamed per frame\n", movingTime / frames,
+                   models.size() * sizeof(glm::mat4) / 1e6);
+            return 0;
+        }
+
+        /// Vertex fetch of full float vertices versus half floats, packed normals and byte colours
+        static int layouts(int argc, char **argv)
+        {
+            const int triangles = argc > 0 ? atoi(argv[0]) : 1000000;
+            const int frames = argc > 1 ? atoi(argv[1]) : 50;
+
+            // Same attributes in the same locations, main.vert reads the first two
+            struct FullVertex
+            {
+                glm::vec3 position;
+                glm::vec2 texCoord;
+                glm::vec3 normal;
+                glm::vec4 colour;
+            };
+            struct PackedVertex
+            {
+                glm::vec3 position;
+                Half texCoord[2];
+                PackedNormal normal;
+                Unorm8x4 colour;
+            };
+            typedef VertexFormat<FullVertex, MIRAGE_ATTRIBUTE(FullVertex, position), MIRAGE_ATTRIBUTE(FullVertex, texCoord),
+                                 MIRAGE_ATTRIBUTE(FullVertex, normal), MIRAGE_ATTRIBUTE(FullVertex, colour)>
+                FullFormat;
+            typedef VertexFormat<PackedVertex, MIRAGE_ATTRIBUTE(PackedVertex, position), MIRAGE_ATTRIBUTE(PackedVertex, texCoord),
+                                 MIRAGE_ATTRIBUTE(PackedVertex, normal), MIRAGE_ATTRIBUTE(PackedVertex, colour)>
+                PackedFormat;
+
+            // Tiny triangles scattered over the screen, so fetching dominates over rasterising
+            const std::size_t count = static_cast<std::size_t>(triangles) * 3;
+            std::vector<FullVertex> full(count);
+            std::vector<PackedVertex> packed(count);
+            srand(1);
+            for (std::size_t i = 0; i < count; i++)
+            {
+                const float x = static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f, y = static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f;
+                const float corner = static_cast<float>(i % 3);
+                FullVertex &vertex = full[i];
+                vertex.position = glm::vec3(x, y, 0.0f);
+                vertex.texCoord = glm::vec2(corner * 0.5f, 1.0f - corner * 0.5f);
+                vertex.normal = glm::vec3(0.0f, 0.0f, 1.0f);
+                vertex.colour = glm::vec4(1.0f, 0.5f, 0.25f, 1.0f);
+
+                PackedVertex &small = packed[i];
+                small.position = vertex.position;
+                small.texCoord[0] = Half::From(vertex.texCoord.x);
+                small.texCoord[1] = Half::From(vertex.texCoord.y);
+                small.normal = PackedNormal::From(vertex.normal);
+                const Unorm8x4 colour = {{255, 128, 64, 255}};
+                small.colour = colour;
+            }
+
+            VertexBuffer fullBuffer(full.data(), static_cast<unsigned int>(full.size() * sizeof(FullVertex)));
+            VertexBuffer packedBuffer(packed.data(), static_cast<unsigned int>(packed.size() * sizeof(PackedVertex)));
+            VertexArray fullArray, packedArray;
+            fullArray.AddBuffer<FullFormat>(fullBuffer);
+            packedArray.AddBuffer<PackedFormat>(packedBuffer);
+
+            Shader shader;
+            shader.attach("main.frag").attach("main.vert").link().activate();
+            shader.bind("model", glm::mat4(1.0f)).bind("view", glm::mat4(1.0f)).bind("projection", glm::mat4(1.0f));
+            GLState::Disable(GL_DEPTH_TEST);
+
+            printf("%d triangles, %d frames\n", triangles, frames);
+            const VertexArray *arrays[] = {&fullArray, &packedArray};
+            const char *names[] = {"float", "packed"};
+            const std::size_t strides[] = {FullFormat::stride, PackedFormat::stride};
+            for (int i = 0; i < 2; i++)
+            {
+                arrays[i]->Bind();
+                glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(count)); // warm up
+                glFinish();
+                Stopwatch watch;
+                for (int frame = 0; frame < frames; frame++)
+                    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(count));
+                glFinish();
+                const double time = watch.ElapsedMs();
+                printf("\t%-7s: %2zu bytes/vertex, %7.2f MB, %8.3f ms/frame, %7.2f M vertices/s\n", names[i], strides[i],
+                       count * strides[i] / 1e6, time / frames, count * static_cast<double>(frames) / time / 1e3);
+            }
+            return 0;
+        }
+
+        /// A VAO per mesh versus one VAO per vertex format whose buffers are rebound per mesh
+        static int formats(int argc, char **argv)
+        {
+            const int meshCount = argc > 0 ? atoi(argv[0]) : 4096;
+            const int frames = argc > 1 ? atoi(argv[1]) : 100;
+
+            VertexBufferLayout layout;
+            layout.push<float>(3);
+            layout.push<float>(2);
+            const unsigned int indices[] = {0, 1, 2, 2, 1, 3};
+            // Index buffers bind on creation, keep them out of whichever VAO is bound
+            GLState::BindVertexArray(0);
+            std::vector<std::unique_ptr<VertexBuffer>> vertexBuffers;
+            std::vector<std::unique_ptr<IndexBuffer>> indexBuffers;
+            std::vector<std::unique_ptr<VertexArray>> separate;
+            for (int i = 0; i < meshCount; i++)
+            {
+                const float x = (i % 64) / 32.0f - 1.0f, y = (i / 64 % 64) / 32.0f - 1.0f, size = 1.0f / 40.0f;
+                const float vertices[] = {x, y, 0.0f, 0.0f, 0.0f, x + size, y, 0.0f, 1.0f, 0.0f,
+                                          x, y + size, 0.0f, 0.0f, 1.0f, x + size, y + size, 0.0f, 1.0f, 1.0f};
+                vertexBuffers.emplace_back(new VertexBuffer(vertices, sizeof(vertices)));
+                indexBuffers.emplace_back(new IndexBuffer(indices, 6));
+            }
+            for (int i = 0; i < meshCount; i++)
+            {
+                separate.emplace_back(new VertexArray());
+                separate.back()->AddBuffer(*vertexBuffers[i], layout);
+                separate.back()->SetIndexBuffer(*indexBuffers[i]);
+            }
+            VertexArrayCache cache;
+            for (int i = 0; i < meshCount; i++)
+                cache.Get(layout);
+
+            Shader shader;
+            shader.attach("main.frag").attach("main.vert").link().activate();
+            shader.bind("model", glm::mat4(1.0f)).bind("view", glm::mat4(1.0f)).bind("projection", glm::mat4(1.0f));
+            GLState::Disable(GL_DEPTH_TEST);
+
+            printf("%d meshes, %d frames, %zu shared VAO(s) for %u requests\n", meshCount, frames, cache.GetCount(),
+                   cache.GetRequests());
+            const bool sharing[] = {false, true};
+            for (bool shared : sharing)
+            {
+                GLState::Invalidate();
+                glFinish();
+                Stopwatch watch;
+                for (int frame = 0; frame < frames; frame++)
+                {
+                    for (int i = 0; i < meshCount; i++)
+                    {
+                        if (shared)
+                        {
+                            VertexArray &array = cache.Get(layout);
+                            array.Bind();
+                            array.SetBuffer(0, *vertexBuffers[i]);
+                            array.SetIndexBuffer(*indexBuffers[i]);
+                        }
+                        else
+                            separate[i]->Bind();
+                        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+                    }
+                    GLState::EndFrame();
+                }
+                const double issue = watch.ElapsedMs();
+                glFinish();
+                const double total = watch.ElapsedMs();
+                printf("\t%-15s: %5zu VAOs, %8.3f ms/frame issued, %8.3f ms/frame total\n",
+                       shared ? "VAO per format" : "VAO per mesh", shared ? cache.GetCount() : separate.size(),
+                       issue / frames, total / frames);
+            }
+            return 0;
+        }
+
+        /// Vertex cache and fetch efficiency of a few meshes as exported versus after the mesh optimizer
+        static int meshopt(int argc, char **argv)
+        {
+            const int segments = argc > 0 ? std::max(atoi(argv[0]), 3) : 64;
+            const int frames = argc > 1 ? atoi(argv[1]) : 100;
+            const int drawsPerFrame = 16;
+
+            // Position and texture coordinate, as the demo cube
+            struct Corpus
+            {
+                const char *name;
+                std::vector<float> vertices;
+                std::vector<unsigned int> indices; // empty for a non-indexed triangle soup
+            };
+            std::vector<Corpus> corpus(5);
+            corpus[0].name = "grid";
+            for (int y = 0; y <= segments; y++)
+                for (int x = 0; x <= segments; x++)
+                {
+                    const float u = static_cast<float>(x) / segments, v = static_cast<float>(y) / segments;
+                    corpus[0].vertices.insert(corpus[0].vertices.end(), {u * 1.6f - 0.8f, v * 1.6f - 0.8f, 0.0f, u, v});
+                }
+            corpus[1].name = "sphere";
+            const int rings = segments / 2;
+            for (int ring = 0; ring <= rings; ring++)
+                for (int x = 0; x <= segments; x++)
+                {
+                    const float theta = 3.14159265f * ring / rings, phi = 6.28318531f * x / segments;
+                    corpus[1].vertices.insert(corpus[1].vertices.end(),
+                                              {0.8f * std::sin(theta) * std::cos(phi), 0.8f * std::cos(theta),
+                                               0.8f * std::sin(theta) * std::sin(phi), static_cast<float>(x) / segments,
+                                               static_cast<float>(ring) / rings});
+                }
+            for (int row = 0; row < segments; row++)
+                for (int x = 0; x < segments; x++)
+                {
+                    const unsigned int a = row * (segments + 1) + x, b = a + 1, c = a + segments + 1, d = c + 1;
+                    corpus[0].indices.insert(corpus[0].indices.end(), {a, b, c, c, b, d});
+                    if (row < rings)
+                        corpus[1].indices.insert(corpus[1].indices.end(), {a, c, b, b, c, d});
+                }
+
+            // The sphere with triangles and vertices shuffled, as some exporters leave them
+            srand(1);
+            corpus[2].name = "shuffled";
+            const std::size_t sphereVertices = corpus[1].vertices.size() / 5, sphereTriangles = corpus[1].indices.size() / 3;
+            std::vector<unsigned int> vertexOrder(sphereVertices), triangleOrder(sphereTriangles);
+            for (std::size_t i = 0; i < vertexOrder.size(); i++)
+                vertexOrder[i] = static_cast<unsigned int>(i);
+            for (std::size_t i = 0; i < triangleOrder.size(); i++)
+                triangleOrder[i] = static_cast<unsigned int>(i);
+            auto shuffle = [](std::vector<unsigned int> &order)
+            {
+                for (std::size_t i = order.size(); i > 1; i--)
+                    std::swap(order[i - 1], order[static_cast<std::size_t>(rand()) % i]);
+            };
+            shuffle(vertexOrder);
+            shuffle(triangleOrder);
+            corpus[2].vertices.resize(corpus[1].vertices.size());
+            for (std::size_t i = 0; i < sphereVertices; i++)
+                std::copy(&corpus[1].vertices[i * 5], &corpus[1].vertices[i * 5] + 5, &corpus[2].vertices[vertexOrder[i] * 5]);
+            for (unsigned int triangle : triangleOrder)
+                for (int k = 0; k < 3; k++)
+                    corpus[2].indices.push_back(vertexOrder[corpus[1].indices[triangle * 3 + k]]);
+
+            // Triangle soups, every corner its own vertex like the demo cube used to be
+            corpus[3].name = "sphere soup";
+            for (unsigned int index : corpus[1].indices)
+                corpus[3].vertices.insert(corpus[3].vertices.end(), &corpus[1].vertices[index * 5], &corpus[1].vertices[index * 5] + 5);
+            corpus[4].name = "cube soup";
+            for (int face = 0; face < 6; face++)
+            {
+                const int axis = face / 2;
+                const float side = face % 2 ? 0.5f : -0.5f;
+                const float corners[6][2] = {{-0.5f, -0.5f}, {0.5f, -0.5f}, {0.5f, 0.5f}, {0.5f, 0.5f}, {-0.5f, 0.5f}, {-0.5f, -0.5f}};
+                for (auto const &corner : corners)
+                {
+                    float vertex[5];
+                    vertex[axis] = side;
+                    vertex[(axis + 1) % 3] = corner[0];
+                    vertex[(axis + 2) % 3] = corner[1];
+                    vertex[3] = corner[0] + 0.5f;
+                    vertex[4] = corner[1] + 0.5f;
+                    corpus[4].vertices.insert(corpus[4].vertices.end(), vertex, vertex + 5);
+                }
+            }
+
+            VertexBufferLayout layout;
+            layout.push<float>(3);
+            layout.push<float>(2);
+            const std::size_t stride = layout.GetStride();
+            Shader shader;
+            shader.attach("main.frag").attach("main.vert").link().activate();
+            shader.bind("model", glm::mat4(1.0f)).bind("view", glm::mat4(1.0f)).bind("projection", glm::mat4(1.0f));
+            GLState::Enable(GL_DEPTH_TEST);
+            GLState::Disable(GL_BLEND);
+
+            // Times drawing the mesh a few times per frame, the meshes are small so vertex work dominates
+            auto drawTime = [&](std::vector<float> const &vertices, std::vector<unsigned int> const &indices)
+            {
+                GLState::BindVertexArray(0);
+                VertexBuffer vbo(vertices.data(), static_cast<unsigned int>(vertices.size() * sizeof(float)));
+                IndexBuffer ibo(indices.data(), static_cast<unsigned int>(indices.size()));
+                VertexArray vao;
+                vao.AddBuffer(vbo, layout);
+                vao.SetIndexBuffer(ibo);
+                vao.Bind();
+                glFinish();
+                Stopwatch watch;
+                for (int frame = 0; frame < frames; frame++)
+                {
+                    glClear(GL_DEPTH_BUFFER_BIT);
+                    for (int draw = 0; draw < drawsPerFrame; draw++)
+                        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, nullptr);
+                }
+                glFinish();
+                return watch.ElapsedMs() / frames;
+            };
+
+            printf("%d segments, %d frames of %d draws, FIFO of %u vertices\n", segments, frames, drawsPerFrame,
+                   MeshOptimizer::CacheSize);
+            for (Corpus &mesh : corpus)
+            {
+                std::size_t vertexCount = mesh.vertices.size() / 5;
+                if (mesh.indices.empty())
+                    for (std::size_t i = 0; i < vertexCount; i++)
+                        mesh.indices.push_back(static_cast<unsigned int>(i));
+                const std::size_t indexCount = mesh.indices.size();
+                const MeshOptimizer::CacheStats cacheBefore = MeshOptimizer::AnalyzeVertexCache(mesh.indices.data(), indexCount, vertexCount);
+                const MeshOptimizer::FetchStats fetchBefore = MeshOptimizer::AnalyzeVertexFetch(mesh.indices.data(), indexCount, vertexCount, stride);
+                const double timeBefore = drawTime(mesh.vertices, mesh.indices);
+
+                Stopwatch watch;
+                std::vector<unsigned int> remap(vertexCount);
+                const std::size_t unique = MeshOptimizer::Deduplicate(mesh.vertices.data(), vertexCount, stride, remap.data());
+                std::vector<float> vertices(unique * 5), fetchOrdered(unique * 5);
+                MeshOptimizer::RemapVertices(vertices.data(), mesh.vertices.data(), vertexCount, stride, remap.data());
+                std::vector<unsigned int> indices(indexCount), cacheOrdered(indexCount);
+                MeshOptimizer::RemapIndices(indices.data(), mesh.indices.data(), indexCount, remap.data());
+                MeshOptimizer::OptimizeVertexCache(cacheOrdered.data(), indices.data(), indexCount, unique);
+                MeshOptimizer::OptimizeOverdraw(indices.data(), cacheOrdered.data(), indexCount, vertices.data(), unique, stride);
+                vertexCount = MeshOptimizer::OptimizeVertexFetch(fetchOrdered.data(), indices.data(), indexCount,
+                                                                 vertices.data(), unique, stride);
+                fetchOrdered.resize(vertexCount * 5);
+                const double optimizeTime = watch.ElapsedMs();
+
+                const MeshOptimizer::CacheStats cacheAfter = MeshOptimizer::AnalyzeVertexCache(indices.data(), indexCount, vertexCount);
+                const MeshOptimizer::FetchStats fetchAfter = MeshOptimizer::AnalyzeVertexFetch(indices.data(), indexCount, vertexCount, stride);
+                const double timeAfter = drawTime(fetchOrdered, indices);
+                printf("\t%-11s: %6zu triangles, %6zu -> %6zu vertices, ACMR %5.3f -> %5.3f, ATVR %5.3f -> %5.3f, "
+                       "fetch %6.3f -> %5.3f, %7.3f -> %7.3f ms/frame, optimised in %.2f ms\n",
+                       mesh.name, indexCount / 3, mesh.vertices.size() / 5, vertexCount, cacheBefore.acmr, cacheAfter.acmr,
+                       cacheBefore.atvr, cacheAfter.atvr, fetchBefore.overfetch, fetchAfter.overfetch, timeBefore, timeAfter,
+                       optimizeTime);
+            }
+            return 0;
+        }
+
+        struct Benchmark
+        {
+            const char *name;
+            int (*function)(int argc, char **argv);
+        };
+
+        static const Benchmark benchmarks[] = {
+            {"--bench-uniforms", uniforms},
+            {"--bench-shaders", shaders},
+            {"--bench-textures", textures},
+            {"--bench-uploads", uploads},
+            {"--bench-compressed", compressed},
+            {"--bench-batching", batching},
+            {"--bench-bindless", bindless},
+            {"--bench-virtual", virtualTexture},
+            {"--bench-mips", mips},
+            {"--bench-streaming", streaming},
+            {"--bench-arena", arena},
+            {"--bench-state", state},
+            {"--bench-queue", queue},
+            {"--bench-indirect", indirect},
+            {"--bench-instancing", instancing},
+            {"--bench-layouts", layouts},
+            {"--bench-formats", formats},
+            {"--bench-meshopt", meshopt},
+        };
+
+        int run(int argc, char **argv)
+        {
+            for (auto const &benchmark : benchmarks)
+                if (strcmp(argv[0], benchmark.name) == 0)
+                    return benchmark.function(argc - 1, argv + 1);
+
+            fprintf(stderr, "Unknown benchmark: %s\nAvailable:\n", argv[0]);
+            for (auto const &benchmark : benchmarks)
+                fprintf(stderr, "\t%s\n", benchmark.name);
+            return 1;
+        }
+    };
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+namespace Mirage
+{
+    namespace Bench
+    {
+        /// Runs the benchmark named on the command line (e.g. --bench-uniforms)
+        /// against the current OpenGL context and prints its report
+        ///
+        /// @param argc The number of arguments after the program name
+        /// @param argv The arguments after the program name
+        /// @return The process exit code
+        int run(int argc, char **argv);
+    };
+};
@@ -0,0 +1,217 @@
+#include "BufferArena.h"
+#include "GLCaps.h"
+#include "GLState.h"
+
+// Standard Headers
+#include <algorithm>
+
+namespace Mirage
+{
+    const BufferArena::Handle BufferArena::Invalid;
+
+    /// Copies between two buffer objects, by name or through the copy targets, which no VAO captures
+    static void CopyRange(GLuint from, GLuint to, std::size_t source, std::size_t destination, std::size_t size)
+    {
+#ifdef GL_VERSION_4_5
+        if (GLCaps::Get().directStateAccess)
+        {
+            glCopyNamedBufferSubData(from, to, source, destination, size);
+            return;
+        }
+#endif
+        GLState::BindBuffer(GL_COPY_READ_BUFFER, from);
+        GLState::BindBuffer(GL_COPY_WRITE_BUFFER, to);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, source, destination, size);
+    }
+
+    /// Doubles a capacity, or adds what is needed when that is more, saturating at the largest
+    /// count whose bytes still fit the unsigned int size the buffers take
+    static std::uint32_t GrowCapacity(std::uint32_t capacity, std::uint32_t needed, std::size_t elementSize)
+    {
+        const std::uint64_t grown = std::max(static_cast<std::uint64_t>(capacity) * 2,
+                                             static_cast<std::uint64_t>(capacity) + needed);
+        return static_cast<std::uint32_t>(std::min<std::uint64_t>(grown, 0xffffffffu / elementSize));
+    }
+
+    BufferArena::BufferArena(VertexBufferLayout const &layout, std::uint32_t vertexCapacity, std::uint32_t indexCapacity)
+        : m_Layout(layout), m_VertexRanges(0), m_IndexRanges(0)
+    {
+        m_Stats.grows = 0;
+        m_Stats.defragmentations = 0;
+        Rebuild(vertexCapacity, indexCapacity, false);
+    }
+
+    BufferArena::Handle BufferArena::Add(const void *vertices, std::uint32_t vertexCount, const unsigned int *indices,
+                                         std::uint32_t indexCount)
+    {
+        // Make room first: pack when the free space adds up to enough, otherwise grow
+        const bool vertexFits = m_VertexRanges.GetLargestFree() >= vertexCount;
+        const bool indexFits = m_IndexRanges.GetLargestFree() >= indexCount;
+        if (!vertexFits || !indexFits)
+        {
+            const std::uint32_t vertexCapacity = m_VertexRanges.GetCapacity(), indexCapacity = m_IndexRanges.GetCapacity();
+            if (vertexCapacity - m_VertexRanges.GetUsed() >= vertexCount &&
+                indexCapacity - m_IndexRanges.GetUsed() >= indexCount)
+                Defragment();
+            else
+            {
+                Rebuild(vertexFits ? vertexCapacity : GrowCapacity(vertexCapacity, vertexCount, m_Layout.GetStride()),
+                        indexFits ? indexCapacity : GrowCapacity(indexCapacity, indexCount, sizeof(unsigned int)),
+                        false);
+                m_Stats.grows++;
+            }
+        }
+
+        const RangeAllocator::Allocation vertexRange = m_VertexRanges.Allocate(vertexCount);
+        const RangeAllocator::Allocation indexRange = m_IndexRanges.Allocate(indexCount);
+        // Only when the capacity saturated and still can't hold the mesh
+        if (vertexRange.node == RangeAllocator::Invalid || indexRange.node == RangeAllocator::Invalid)
+        {
+            if (vertexRange.node != RangeAllocator::Invalid)
+                m_VertexRanges.Free(vertexRange.node);
+            if (indexRange.node != RangeAllocator::Invalid)
+                m_IndexRanges.Free(indexRange.node);
+            return Invalid;
+        }
+        Mesh mesh = {vertexRange.node, indexRange.node, vertexRange.offset, indexRange.offset, vertexCount, indexCount};
+
+        const unsigned int stride = m_Layout.GetStride();
+        m_Vertices->Update(vertices, vertexCount * stride, mesh.baseVertex * stride);
+        m_Indices->Update(indices, indexCount, mesh.firstIndex);
+
+        Handle handle;
+        if (!m_FreeHandles.empty())
+        {
+            handle = m_FreeHandles.back();
+            m_FreeHandles.pop_back();
+            m_Meshes[handle] = mesh;
+        }
+        else
+        {
+            handle = static_cast<Handle>(m_Meshes.size());
+            m_Meshes.push_back(mesh);
+        }
+        return handle;
+    }
+
+    void BufferArena::Remove(Handle handle)
+    {
+        Mesh &mesh = m_Meshes[handle];
+        if (mesh.vertexNode == RangeAllocator::Invalid)
+            return;
+        m_VertexRanges.Free(mesh.vertexNode);
+        m_IndexRanges.Free(mesh.indexNode);
+        mesh.vertexNode = RangeAllocator::Invalid;
+        mesh.indexNode = RangeAllocator::Invalid;
+        m_FreeHandles.push_back(handle);
+    }
+
+    void BufferArena::Bind() const
+    {
+        m_Array->Bind();
+    }
+
+    void BufferArena::Draw(Handle handle, GLenum mode) const
+    {
+        Mesh const &mesh = m_Meshes[handle];
+        glDrawElementsBaseVertex(mode, mesh.indexCount, GL_UNSIGNED_INT,
+                                 reinterpret_cast<const void *>(static_cast<std::size_t>(mesh.firstIndex) * sizeof(unsigned int)),
+                                 mesh.baseVertex);
+    }
+
+    void BufferArena::DrawInstanced(Handle handle, GLsizei instances, GLuint baseInstance, GLenum mode) const
+    {
+        Mesh const &mesh = m_Meshes[handle];
+        glDrawElementsInstancedBaseVertexBaseInstance(
+            mode, mesh.indexCount, GL_UNSIGNED_INT,
+            reinterpret_cast<const void *>(static_cast<std::size_t>(mesh.firstIndex) * sizeof(unsigned int)), instances,
+            mesh.baseVertex, baseInstance);
+    }
+
+    void BufferArena::Defragment()
+    {
+        Rebuild(m_VertexRanges.GetCapacity(), m_IndexRanges.GetCapacity(), true);
+        m_Stats.defragmentations++;
+    }
+
+    std::size_t BufferArena::GetMemoryUsage() const
+    {
+        return static_cast<std::size_t>(m_VertexRanges.GetCapacity()) * m_Layout.GetStride() +
+               static_cast<std::size_t>(m_IndexRanges.GetCapacity()) * sizeof(unsigned int);
+    }
+
+    void BufferArena::Rebuild(std::uint32_t vertexCapacity, std::uint32_t indexCapacity, bool pack)
+    {
+        const unsigned int stride = m_Layout.GetStride();
+        // Without direct state access creating an IndexBuffer binds it, keep it out of whichever VAO the caller has bound
+        GLint previous = 0;
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous);
+        const bool wasBound = m_Array && static_cast<GLuint>(previous) == m_Array->GetRendererID();
+        GLState::BindVertexArray(0);
+        std::unique_ptr<VertexBuffer> vertices(new VertexBuffer(nullptr, vertexCapacity * stride));
+        std::unique_ptr<IndexBuffer> indices(new IndexBuffer(nullptr, indexCapacity));
+
+        if (m_Vertices && !pack)
+        {
+            CopyRange(m_Vertices->GetRendererID(), vertices->GetRendererID(), 0, 0,
+                      static_cast<std::size_t>(m_VertexRanges.GetCapacity()) * stride);
+            CopyRange(m_Indices->GetRendererID(), indices->GetRendererID(), 0, 0,
+                      static_cast<std::size_t>(m_IndexRanges.GetCapacity()) * sizeof(unsigned int));
+            m_VertexRanges.Grow(vertexCapacity);
+            m_IndexRanges.Grow(indexCapacity);
+        }
+        else if (m_Vertices)
+        {
+            // A fresh allocator hands out ranges back to back, visit the meshes in address order
+            std::vector<Handle> live;
+            for (Handle handle = 0; handle < m_Meshes.size(); handle++)
+                if (m_Meshes[handle].vertexNode != RangeAllocator::Invalid)
+                    live.push_back(handle);
+
+            RangeAllocator vertexRanges(vertexCapacity), indexRanges(indexCapacity);
+            std::sort(live.begin(), live.end(), [this](Handle a, Handle b)
+                      { return m_Meshes[a].baseVertex < m_Meshes[b].baseVertex; });
+            for (Handle handle : live)
+            {
+                Mesh &mesh = m_Meshes[handle];
+                const RangeAllocator::Allocation range = vertexRanges.Allocate(mesh.vertexCount);
+                CopyRange(m_Vertices->GetRendererID(), vertices->GetRendererID(),
+                          static_cast<std::size_t>(mesh.baseVertex) * stride,
+                          static_cast<std::size_t>(range.offset) * stride,
+                          static_cast<std::size_t>(mesh.vertexCount) * stride);
+                mesh.vertexNode = range.node;
+                mesh.baseVertex = range.offset;
+            }
+            std::sort(live.begin(), live.end(), [this](Handle a, Handle b)
+                      { return m_Meshes[a].firstIndex < m_Meshes[b].firstIndex; });
+            for (Handle handle : live)
+            {
+                Mesh &mesh = m_Meshes[handle];
+                const RangeAllocator::Allocation range = indexRanges.Allocate(mesh.indexCount);
+                CopyRange(m_Indices->GetRendererID(), indices->GetRendererID(),
+                          static_cast<std::size_t>(mesh.firstIndex) * sizeof(unsigned int),
+                          static_cast<std::size_t>(range.offset) * sizeof(unsigned int),
+                          static_cast<std::size_t>(mesh.indexCount) * sizeof(unsigned int));
+                mesh.indexNode = range.node;
+                mesh.firstIndex = range.offset;
+            }
+            m_VertexRanges = vertexRanges;
+            m_IndexRanges = indexRanges;
+        }
+        else
+        {
+            m_VertexRanges = RangeAllocator(vertexCapacity);
+            m_IndexRanges = RangeAllocator(indexCapacity);
+        }
+        GLState::BindBuffer(GL_COPY_READ_BUFFER, 0);
+        GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        m_Vertices.swap(vertices);
+        m_Indices.swap(indices);
+        m_Array.reset(new VertexArray());
+        m_Array->AddBuffer(*m_Vertices, m_Layout);
+        m_Array->SetIndexBuffer(*m_Indices);
+        // Put back what the caller had bound, the replacement when that was the old VAO
+        GLState::BindVertexArray(wasBound ? m_Array->GetRendererID() : static_cast<GLuint>(previous));
+    }
+};
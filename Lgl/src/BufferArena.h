@@ -0,0 +1,106 @@
+#pragma once
+
+#include "IndexBuffer.h"
+#include "RangeAllocator.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+// GLAD
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Mirage
+{
+    /// Packs many meshes of one vertex layout into a shared vertex and index buffer
+    ///
+    /// Vertex and index ranges come from RangeAllocators counting in vertices
+    /// and indices, so every mesh starts on a whole vertex and draws through
+    /// glDrawElementsBaseVertex with its indices left relative to its first
+    /// vertex. All meshes share one VAO binding. Meshes are referred to by
+    /// handles that stay valid while ranges move, the buffers double when full
+    /// and Defragment() packs the live ranges to the front.
+    class BufferArena
+    {
+    public:
+        typedef std::uint32_t Handle;
+        static const Handle Invalid = 0xffffffffu;
+
+        struct Mesh
+        {
+            std::uint32_t vertexNode; // RangeAllocator nodes, Invalid for removed meshes
+            std::uint32_t indexNode;
+            std::uint32_t baseVertex;
+            std::uint32_t firstIndex;
+            std::uint32_t vertexCount;
+            std::uint32_t indexCount;
+        };
+
+        struct Stats
+        {
+            unsigned int grows;            // buffer reallocations because a range didn't fit
+            unsigned int defragmentations; // Defragment() calls, explicit or to avoid a grow
+        };
+
+    private:
+        VertexBufferLayout m_Layout;
+        std::unique_ptr<VertexBuffer> m_Vertices;
+        std::unique_ptr<IndexBuffer> m_Indices;
+        std::unique_ptr<VertexArray> m_Array;
+        RangeAllocator m_VertexRanges;
+        RangeAllocator m_IndexRanges;
+        std::vector<Mesh> m_Meshes;
+        std::vector<Handle> m_FreeHandles;
+        Stats m_Stats;
+
+    public:
+        /// @param layout The vertex layout every mesh uses
+        /// @param vertexCapacity The initial number of vertices
+        /// @param indexCapacity The initial number of 32 bit indices
+        BufferArena(VertexBufferLayout const &layout, std::uint32_t vertexCapacity = 1 << 16,
+                    std::uint32_t indexCapacity = 1 << 18);
+
+        BufferArena(BufferArena const &) = delete;
+        BufferArena &operator=(BufferArena const &) = delete;
+
+        /// Copies a mesh into the arena
+        ///
+        /// @param vertices Tightly packed vertices in the arena's layout
+        /// @param vertexCount The number of vertices
+        /// @param indices Indices relative to the mesh's first vertex
+        /// @param indexCount The number of indices
+        /// @return The mesh's handle, Invalid when the buffers can't grow large enough to hold it.
+        ///         Growing or packing replaces the VAO, if the arena's was bound the new one is bound instead
+        Handle Add(const void *vertices, std::uint32_t vertexCount, const unsigned int *indices,
+                   std::uint32_t indexCount);
+        void Remove(Handle handle);
+
+        /// Binds the shared VAO, every Draw() afterwards reuses it
+        void Bind() const;
+        void Draw(Handle handle, GLenum mode = GL_TRIANGLES) const;
+        /// Draws copies of a mesh, per-instance attributes start at the base instance's entry
+        void DrawInstanced(Handle handle, GLsizei instances, GLuint baseInstance = 0, GLenum mode = GL_TRIANGLES) const;
+
+        /// Moves the live ranges to the front of each buffer, leaving one free range at the end
+        void Defragment();
+
+        inline Mesh const &Get(Handle handle) const { return m_Meshes[handle]; }
+        inline VertexBufferLayout const &GetLayout() const { return m_Layout; }
+        /// The shared VAO, replaced along with the buffers whenever the arena grows or defragments
+        inline VertexArray const &GetVertexArray() const { return *m_Array; }
+        inline std::uint32_t GetMeshCount() const { return m_VertexRanges.GetAllocationCount(); }
+        inline RangeAllocator const &GetVertexRanges() const { return m_VertexRanges; }
+        inline RangeAllocator const &GetIndexRanges() const { return m_IndexRanges; }
+        inline Stats const &GetStats() const { return m_Stats; }
+        /// Bytes of both buffers
+        std::size_t GetMemoryUsage() const;
+
+    private:
+        /// Replaces the buffers with ones of the given capacity and copies the meshes over,
+        /// either to the same offsets or packed to the front
+        void Rebuild(std::uint32_t vertexCapacity, std::uint32_t indexCapacity, bool pack);
+    };
+};
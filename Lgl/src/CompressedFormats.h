@@ -0,0 +1,56 @@
+#pragma once
+
+// GLAD
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstddef>
+
+// S3TC is an extension, glad only defines its enums when generated with it
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+namespace Mirage
+{
+    /// Bytes per 4x4 block of a block compressed format, 0 for uncompressed formats
+    ///
+    /// BC1 and ETC2 RGB store 8 bytes per block (4 bits per texel), BC3, BC7 and
+    /// ETC2 with EAC alpha store 16 (8 bits per texel)
+    inline std::size_t GetCompressedBlockSize(GLenum internalFormat)
+    {
+        switch (internalFormat)
+        {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+            return 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+        case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
+    inline bool IsCompressedFormat(GLenum internalFormat)
+    {
+        return GetCompressedBlockSize(internalFormat) != 0;
+    }
+
+    /// Size of one level of a block compressed image, partial blocks are padded to 4x4
+    inline std::size_t GetCompressedLevelSize(GLenum internalFormat, int width, int height)
+    {
+        return static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * GetCompressedBlockSize(internalFormat);
+    }
+};
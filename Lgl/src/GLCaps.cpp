@@ -0,0 +1,64 @@
+#include "GLCaps.h"
+
+// Standard Headers
+#include <cstring>
+
+// Core in GL 4.6, glad only defines it when generated for that version or the extension
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY 0x84FF
+#endif
+
+namespace Mirage
+{
+    static GLCaps Query()
+    {
+        GLCaps caps;
+        glGetIntegerv(GL_MAJOR_VERSION, &caps.major);
+        glGetIntegerv(GL_MINOR_VERSION, &caps.minor);
+        caps.bufferStorage = caps.AtLeast(4, 4) || GLCaps::HasExtension("GL_ARB_buffer_storage");
+        caps.anisotropicFiltering = caps.AtLeast(4, 6) || GLCaps::HasExtension("GL_ARB_texture_filter_anisotropic") ||
+                                    GLCaps::HasExtension("GL_EXT_texture_filter_anisotropic");
+        caps.maxAnisotropy = 1.0f;
+        if (caps.anisotropicFiltering)
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &caps.maxAnisotropy);
+#ifdef GL_ARB_bindless_texture
+        caps.bindlessTexture = GLCaps::HasExtension("GL_ARB_bindless_texture");
+#else
+        caps.bindlessTexture = false;
+#endif
+#ifdef GL_ARB_sparse_texture
+        caps.sparseTexture = GLCaps::HasExtension("GL_ARB_sparse_texture");
+#else
+        caps.sparseTexture = false;
+#endif
+#ifdef GL_VERSION_4_5
+        caps.directStateAccess = caps.AtLeast(4, 5);
+#else
+        caps.directStateAccess = false;
+#endif
+        return caps;
+    }
+
+    GLCaps const &GLCaps::Get()
+    {
+        static GLCaps caps = Query();
+        return caps;
+    }
+
+    bool GLCaps::HasExtension(const char *name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++)
+            if (strcmp(reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i)), name) == 0)
+                return true;
+        return false;
+    }
+
+    bool GLCaps::IsFormatSupported(GLenum internalFormat)
+    {
+        GLint supported = GL_FALSE;
+        glGetInternalformativ(GL_TEXTURE_2D, internalFormat, GL_INTERNALFORMAT_SUPPORTED, 1, &supported);
+        return supported == GL_TRUE;
+    }
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+// GLAD
+#include <glad/glad.h>
+
+namespace Mirage
+{
+    /// Optional OpenGL features of the current context, queried once after the loader ran
+    struct GLCaps
+    {
+        int major;
+        int minor;
+        bool bufferStorage;        // GL 4.4 or ARB_buffer_storage
+        bool bindlessTexture;      // ARB_bindless_texture, and the loader knows its entry points
+        bool anisotropicFiltering; // GL 4.6, ARB_ or EXT_texture_filter_anisotropic
+        float maxAnisotropy;       // GL_MAX_TEXTURE_MAX_ANISOTROPY, 1 without anisotropic filtering
+        bool sparseTexture;        // ARB_sparse_texture, and the loader knows its entry points
+        bool directStateAccess;    // GL 4.5, and the loader knows its entry points
+
+        /// Returns the capabilities of the current context, the first call queries the driver
+        static GLCaps const &Get();
+
+        /// Checks the extension list of the current context
+        static bool HasExtension(const char *name);
+
+        /// Asks the driver whether a GL_TEXTURE_2D internal format can be used (ARB_internalformat_query2)
+        static bool IsFormatSupported(GLenum internalFormat);
+
+        inline bool AtLeast(int wantMajor, int wantMinor) const
+        {
+            return major > wantMajor || (major == wantMajor && minor >= wantMinor);
+        }
+    };
+};
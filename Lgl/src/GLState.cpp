@@ -0,0 +1,316 @@
+#include "GLState.h"
+
+// Standard Headers
+#include <algorithm>
+
+namespace Mirage
+{
+    static const GLuint Unknown = 0xffffffffu;
+    static const int TextureUnits = 32;
+
+    // Targets and capabilities outside these lists are passed through uncached
+    static const GLenum s_BufferTargets[] = {
+        GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+        GL_PIXEL_PACK_BUFFER, GL_PIXEL_UNPACK_BUFFER, GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER,
+        GL_DRAW_INDIRECT_BUFFER, GL_DISPATCH_INDIRECT_BUFFER, GL_TEXTURE_BUFFER, GL_ATOMIC_COUNTER_BUFFER};
+    static const GLenum s_TextureTargets[] = {GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_3D, GL_TEXTURE_CUBE_MAP};
+    static const GLenum s_TextureBindings[] = {GL_TEXTURE_BINDING_2D, GL_TEXTURE_BINDING_2D_ARRAY,
+                                               GL_TEXTURE_BINDING_3D, GL_TEXTURE_BINDING_CUBE_MAP};
+    static const GLenum s_Capabilities[] = {GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST, GL_STENCIL_TEST,
+                                           GL_FRAMEBUFFER_SRGB, GL_PRIMITIVE_RESTART};
+
+    static const int BufferTargetCount = sizeof(s_BufferTargets) / sizeof(s_BufferTargets[0]);
+    static const int TextureTargetCount = sizeof(s_TextureTargets) / sizeof(s_TextureTargets[0]);
+    static const int CapabilityCount = sizeof(s_Capabilities) / sizeof(s_Capabilities[0]);
+
+    struct CachedState
+    {
+        GLuint program;
+        GLuint vertexArray;
+        GLuint readFramebuffer;
+        GLuint drawFramebuffer;
+        GLuint activeUnit; // index, not GL_TEXTUREi
+        GLuint buffers[BufferTargetCount];
+        GLuint textures[TextureUnits][TextureTargetCount];
+        GLuint samplers[TextureUnits];
+        GLuint capabilities[CapabilityCount];
+        GLuint blendSource;
+        GLuint blendDestination;
+        GLuint depthFunction;
+        GLuint depthMask;
+    };
+
+    static CachedState UnknownState()
+    {
+        CachedState state;
+        GLuint *first = reinterpret_cast<GLuint *>(&state);
+        std::fill(first, first + sizeof(CachedState) / sizeof(GLuint), Unknown);
+        return state;
+    }
+
+    static CachedState s_State = UnknownState();
+    static bool s_Enabled = true;
+    static GLState::Counters s_Counters = {0, 0};
+    static GLState::Counters s_FrameCounters = {0, 0};
+
+    template <typename T, std::size_t N>
+    static int IndexOf(const T (&list)[N], T value)
+    {
+        const T *found = std::find(list, list + N, value);
+        return found == list + N ? -1 : static_cast<int>(found - list);
+    }
+
+    /// True when the call can be dropped, otherwise records the new value and counts the call as issued
+    static bool Elide(GLuint &cached, GLuint value)
+    {
+        if (s_Enabled && cached == value)
+        {
+            s_Counters.elided++;
+            return true;
+        }
+        cached = value;
+        s_Counters.issued++;
+        return false;
+    }
+
+    /// Replaces a deleted name with 0 wherever it is cached
+    static void Forget(GLuint *first, std::size_t count, GLuint name)
+    {
+        if (name)
+            std::replace(first, first + count, name, 0u);
+    }
+
+    void GLState::UseProgram(GLuint program)
+    {
+        if (!Elide(s_State.program, program))
+            glUseProgram(program);
+    }
+
+    void GLState::BindVertexArray(GLuint array)
+    {
+        if (Elide(s_State.vertexArray, array))
+            return;
+        glBindVertexArray(array);
+        // The element array binding is part of the VAO
+        s_State.buffers[IndexOf(s_BufferTargets, static_cast<GLenum>(GL_ELEMENT_ARRAY_BUFFER))] = Unknown;
+    }
+
+    void GLState::BindBuffer(GLenum target, GLuint buffer)
+    {
+        const int index = IndexOf(s_BufferTargets, target);
+        GLuint untracked = Unknown;
+        if (!Elide(index >= 0 ? s_State.buffers[index] : untracked, buffer))
+            glBindBuffer(target, buffer);
+    }
+
+    void GLState::BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+    {
+        glBindBufferBase(target, index, buffer);
+        s_Counters.issued++;
+        const int slot = IndexOf(s_BufferTargets, target);
+        if (slot >= 0)
+            s_State.buffers[slot] = buffer;
+    }
+
+    void GLState::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+    {
+        glBindBufferRange(target, index, buffer, offset, size);
+        s_Counters.issued++;
+        const int slot = IndexOf(s_BufferTargets, target);
+        if (slot >= 0)
+            s_State.buffers[slot] = buffer;
+    }
+
+    void GLState::BindFramebuffer(GLenum target, GLuint framebuffer)
+    {
+        if (target == GL_FRAMEBUFFER)
+        {
+            if (s_Enabled && s_State.readFramebuffer == framebuffer && s_State.drawFramebuffer == framebuffer)
+            {
+                s_Counters.elided++;
+                return;
+            }
+            s_State.readFramebuffer = s_State.drawFramebuffer = framebuffer;
+            s_Counters.issued++;
+            glBindFramebuffer(target, framebuffer);
+            return;
+        }
+        if (!Elide(target == GL_READ_FRAMEBUFFER ? s_State.readFramebuffer : s_State.drawFramebuffer, framebuffer))
+            glBindFramebuffer(target, framebuffer);
+    }
+
+    void GLState::ActiveTexture(GLenum unit)
+    {
+        if (!Elide(s_State.activeUnit, unit - GL_TEXTURE0))
+            glActiveTexture(unit);
+    }
+
+    void GLState::BindTexture(GLenum target, GLuint texture)
+    {
+        const int slot = IndexOf(s_TextureTargets, target);
+        const GLuint unit = s_State.activeUnit;
+        GLuint untracked = Unknown;
+        if (!Elide(slot >= 0 && unit < static_cast<GLuint>(TextureUnits) ? s_State.textures[unit][slot] : untracked, texture))
+            glBindTexture(target, texture);
+    }
+
+    void GLState::BindTextureUnit(GLuint unit, GLenum target, GLuint texture)
+    {
+        const int slot = IndexOf(s_TextureTargets, target);
+        if (s_Enabled && slot >= 0 && unit < static_cast<GLuint>(TextureUnits) && s_State.textures[unit][slot] == texture)
+        {
+            s_Counters.elided++;
+            return;
+        }
+        ActiveTexture(GL_TEXTURE0 + unit);
+        BindTexture(target, texture);
+    }
+
+    GLuint GLState::GetTexture(GLenum target)
+    {
+        const int slot = IndexOf(s_TextureTargets, target);
+        const GLuint unit = s_State.activeUnit;
+        if (slot >= 0 && unit < static_cast<GLuint>(TextureUnits) && s_State.textures[unit][slot] != Unknown)
+            return s_State.textures[unit][slot];
+        GLint texture = 0;
+        if (slot >= 0)
+            glGetIntegerv(s_TextureBindings[slot], &texture);
+        return static_cast<GLuint>(texture);
+    }
+
+    void GLState::BindSampler(GLuint unit, GLuint sampler)
+    {
+        GLuint untracked = Unknown;
+        if (!Elide(unit < static_cast<GLuint>(TextureUnits) ? s_State.samplers[unit] : untracked, sampler))
+            glBindSampler(unit, sampler);
+    }
+
+    void GLState::Enable(GLenum capability)
+    {
+        const int index = IndexOf(s_Capabilities, capability);
+        GLuint untracked = Unknown;
+        if (!Elide(index >= 0 ? s_State.capabilities[index] : untracked, GL_TRUE))
+            glEnable(capability);
+    }
+
+    void GLState::Disable(GLenum capability)
+    {
+        const int index = IndexOf(s_Capabilities, capability);
+        GLuint untracked = Unknown;
+        if (!Elide(index >= 0 ? s_State.capabilities[index] : untracked, GL_FALSE))
+            glDisable(capability);
+    }
+
+    void GLState::BlendFunc(GLenum source, GLenum destination)
+    {
+        if (s_Enabled && s_State.blendSource == source && s_State.blendDestination == destination)
+        {
+            s_Counters.elided++;
+            return;
+        }
+        s_State.blendSource = source;
+        s_State.blendDestination = destination;
+        s_Counters.issued++;
+        glBlendFunc(source, destination);
+    }
+
+    void GLState::DepthFunc(GLenum function)
+    {
+        if (!Elide(s_State.depthFunction, function))
+            glDepthFunc(function);
+    }
+
+    void GLState::DepthMask(GLboolean mask)
+    {
+        if (!Elide(s_State.depthMask, mask))
+            glDepthMask(mask);
+    }
+
+    void GLState::VertexArrayElementBuffer(GLuint array, GLuint buffer)
+    {
+#ifdef GL_VERSION_4_5
+        glVertexArrayElementBuffer(array, buffer);
+        s_Counters.issued++;
+        if (array && s_State.vertexArray == array)
+            s_State.buffers[IndexOf(s_BufferTargets, static_cast<GLenum>(GL_ELEMENT_ARRAY_BUFFER))] = buffer;
+#else
+        (void)array;
+        (void)buffer;
+#endif
+    }
+
+    void GLState::DeleteBuffers(GLsizei count, const GLuint *buffers)
+    {
+        for (GLsizei i = 0; i < count; i++)
+            Forget(s_State.buffers, BufferTargetCount, buffers[i]);
+        glDeleteBuffers(count, buffers);
+    }
+
+    void GLState::DeleteTextures(GLsizei count, const GLuint *textures)
+    {
+        for (GLsizei i = 0; i < count; i++)
+            Forget(&s_State.textures[0][0], TextureUnits * TextureTargetCount, textures[i]);
+        glDeleteTextures(count, textures);
+    }
+
+    void GLState::DeleteVertexArrays(GLsizei count, const GLuint *arrays)
+    {
+        for (GLsizei i = 0; i < count; i++)
+            if (arrays[i] && s_State.vertexArray == arrays[i])
+            {
+                // GL falls back to VAO 0, whose element array binding isn't known
+                s_State.vertexArray = 0;
+                s_State.buffers[IndexOf(s_BufferTargets, static_cast<GLenum>(GL_ELEMENT_ARRAY_BUFFER))] = Unknown;
+            }
+        glDeleteVertexArrays(count, arrays);
+    }
+
+    void GLState::DeleteSamplers(GLsizei count, const GLuint *samplers)
+    {
+        for (GLsizei i = 0; i < count; i++)
+            Forget(s_State.samplers, TextureUnits, samplers[i]);
+        glDeleteSamplers(count, samplers);
+    }
+
+    void GLState::DeleteFramebuffers(GLsizei count, const GLuint *framebuffers)
+    {
+        for (GLsizei i = 0; i < count; i++)
+        {
+            Forget(&s_State.readFramebuffer, 1, framebuffers[i]);
+            Forget(&s_State.drawFramebuffer, 1, framebuffers[i]);
+        }
+        glDeleteFramebuffers(count, framebuffers);
+    }
+
+    void GLState::Invalidate()
+    {
+        s_State = UnknownState();
+    }
+
+    void GLState::SetEnabled(bool enabled)
+    {
+        s_Enabled = enabled;
+    }
+
+    bool GLState::IsEnabled()
+    {
+        return s_Enabled;
+    }
+
+    void GLState::EndFrame()
+    {
+        s_FrameCounters = s_Counters;
+        s_Counters.issued = 0;
+        s_Counters.elided = 0;
+    }
+
+    GLState::Counters const &GLState::GetFrameCounters()
+    {
+        return s_FrameCounters;
+    }
+
+    GLState::Counters const &GLState::GetCounters()
+    {
+        return s_Counters;
+    }
+};
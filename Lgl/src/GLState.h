@@ -0,0 +1,76 @@
+#pragma once
+
+// GLAD
+#include <glad/glad.h>
+
+namespace Mirage
+{
+    /// Shadow copy of the context's bindings and fixed function state that drops redundant calls
+    ///
+    /// Every bind, enable and blend/depth call of the engine goes through here.
+    /// A call that would set what is already set is elided, anything else is
+    /// issued and remembered. State starts out unknown, so the first call of a
+    /// kind is always issued. The cache is only right while nobody changes the
+    /// state behind its back: code calling GL directly must Invalidate() it, and
+    /// objects are deleted through it so bindings to recycled names are forgotten.
+    /// The element array binding belongs to the VAO and is forgotten on every VAO
+    /// switch. Direct state access edits objects without binding them and needs no
+    /// tracking, except for the element array of the bound VAO, which goes through
+    /// VertexArrayElementBuffer(). There is one cache, for the one context the
+    /// engine renders with.
+    class GLState
+    {
+    public:
+        struct Counters
+        {
+            unsigned int issued; // calls that reached the driver
+            unsigned int elided; // calls dropped because the state was already set
+        };
+
+        // Bindings and state
+        static void UseProgram(GLuint program);
+        static void BindVertexArray(GLuint array);
+        static void BindBuffer(GLenum target, GLuint buffer);
+        /// Also sets the generic binding of the target, like GL does
+        static void BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+        static void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+        static void BindFramebuffer(GLenum target, GLuint framebuffer);
+        static void ActiveTexture(GLenum unit);
+        /// Binds to the active unit, for uploads and parameter changes
+        static void BindTexture(GLenum target, GLuint texture);
+        /// Binds to a unit for sampling, the active unit only changes if the binding does
+        static void BindTextureUnit(GLuint unit, GLenum target, GLuint texture);
+        /// The texture bound to the target of the active unit, asked from the driver when not tracked,
+        /// so edits that bind a texture can put the previous one back
+        static GLuint GetTexture(GLenum target);
+        static void BindSampler(GLuint unit, GLuint sampler);
+        static void Enable(GLenum capability);
+        static void Disable(GLenum capability);
+        static void BlendFunc(GLenum source, GLenum destination);
+        static void DepthFunc(GLenum function);
+        static void DepthMask(GLboolean mask);
+        /// Direct state access version of binding an element array buffer into a VAO (GL 4.5),
+        /// updates the cached binding when the VAO is the bound one
+        static void VertexArrayElementBuffer(GLuint array, GLuint buffer);
+
+        // Deletion forgets the names wherever they are cached, GL unbinds them as well
+        static void DeleteBuffers(GLsizei count, const GLuint *buffers);
+        static void DeleteTextures(GLsizei count, const GLuint *textures);
+        static void DeleteVertexArrays(GLsizei count, const GLuint *arrays);
+        static void DeleteSamplers(GLsizei count, const GLuint *samplers);
+        static void DeleteFramebuffers(GLsizei count, const GLuint *framebuffers);
+
+        /// Forgets everything, the next call of every kind is issued
+        static void Invalidate();
+        /// Passes every call through while disabled, for comparisons and debugging
+        static void SetEnabled(bool enabled);
+        static bool IsEnabled();
+
+        /// Closes the counters of the current frame, call once per frame
+        static void EndFrame();
+        /// Counters of the last frame closed by EndFrame()
+        static Counters const &GetFrameCounters();
+        /// Counters of the frame in progress
+        static Counters const &GetCounters();
+    };
+};
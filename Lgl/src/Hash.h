@@ -0,0 +1,30 @@
+#pragma once
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+
+namespace Mirage
+{
+    /// 32-bit FNV-1a hash of a null-terminated string, usable in constant expressions
+    ///
+    /// @param str The string to hash
+    /// @param hash The running hash value
+    constexpr std::uint32_t fnv1a(const char *str, std::uint32_t hash = 2166136261u)
+    {
+        return *str ? fnv1a(str + 1, (hash ^ static_cast<unsigned char>(*str)) * 16777619u) : hash;
+    }
+
+    /// 64-bit FNV-1a hash of a block of memory, chain calls through the seed
+    ///
+    /// @param data Pointer to the bytes to hash
+    /// @param size The number of bytes
+    /// @param hash The running hash value
+    inline std::uint64_t fnv1a64(const void *data, std::size_t size, std::uint64_t hash = 14695981039346656037ull)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < size; i++)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return hash;
+    }
+};
@@ -1,23 +1,67 @@
 #include "IndexBuffer.h"
+#include "GLCaps.h"
+#include "GLState.h"
 
 namespace Mirage
 {
     IndexBuffer::IndexBuffer(const unsigned int *data, unsigned int count) : m_Count(count)
     {
+#ifdef GL_VERSION_4_5
+        if (GLCaps::Get().directStateAccess)
+        {
+            // Nothing is bound, so creating one no longer attaches it to the bound VAO. An empty
+            // buffer gets no storage, which glNamedBufferStorage would reject.
+            glCreateBuffers(1, &m_RendererID);
+            if (count > 0)
+                glNamedBufferStorage(m_RendererID, count * sizeof(unsigned int), data, GL_DYNAMIC_STORAGE_BIT);
+            return;
+        }
+#endif
         glGenBuffers(1, &m_RendererID);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+        GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW);
     }
     IndexBuffer::~IndexBuffer()
     {
-        glDeleteBuffers(1, &m_RendererID);
+        GLState::DeleteBuffers(1, &m_RendererID);
+    }
+    IndexBuffer::IndexBuffer(IndexBuffer &&other) noexcept
+        : m_RendererID(other.m_RendererID), m_Count(other.m_Count)
+    {
+        other.m_RendererID = 0;
+        other.m_Count = 0;
+    }
+    IndexBuffer &IndexBuffer::operator=(IndexBuffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            GLState::DeleteBuffers(1, &m_RendererID);
+            m_RendererID = other.m_RendererID;
+            m_Count = other.m_Count;
+            other.m_RendererID = 0;
+            other.m_Count = 0;
+        }
+        return *this;
+    }
+    void IndexBuffer::Update(const unsigned int *data, unsigned int count, unsigned int first)
+    {
+#ifdef GL_VERSION_4_5
+        if (GLCaps::Get().directStateAccess)
+        {
+            glNamedBufferSubData(m_RendererID, first * sizeof(unsigned int), count * sizeof(unsigned int), data);
+            return;
+        }
+#endif
+        // The copy target belongs to no VAO, unlike GL_ELEMENT_ARRAY_BUFFER
+        GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, first * sizeof(unsigned int), count * sizeof(unsigned int), data);
     }
     void IndexBuffer::Bind()
     {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+        GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
     }
     void IndexBuffer::Unbind()
     {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 };
\ No newline at end of file
@@ -13,9 +13,19 @@ namespace Mirage
         IndexBuffer(const unsigned int *data, unsigned int count);
         ~IndexBuffer();
 
+        IndexBuffer(IndexBuffer const &) = delete;
+        IndexBuffer &operator=(IndexBuffer const &) = delete;
+        /// Moves hand the buffer name over, the source is left empty and deletes nothing
+        IndexBuffer(IndexBuffer &&other) noexcept;
+        IndexBuffer &operator=(IndexBuffer &&other) noexcept;
+
+        /// Overwrites indices first to first + count
+        void Update(const unsigned int *data, unsigned int count, unsigned int first = 0);
+
         void Bind();
         void Unbind();
 
         inline unsigned int GetCount() const { return m_Count; }
+        inline unsigned int GetRendererID() const { return m_RendererID; }
     };
 };
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "IndirectBatch.h"
+#include "GLState.h"
+
+// Standard Headers
+#include <algorithm>
+
+namespace Mirage
+{
+    const GLuint IndirectBatch::DrawIndexAttribute;
+
+    IndirectBatch::IndirectBatch(BufferArena &arena)
+        : m_Arena(arena), m_CommandBuffer(0), m_DrawBuffer(0), m_DrawIndexBuffer(0), m_DrawCapacity(0),
+          m_DrawIndexCapacity(0), m_AttributeArray(0), m_ArenaVersion(0), m_CommandsDirty(true), m_DirtyFirst(0),
+          m_DirtyLast(0)
+    {
+        glGenBuffers(1, &m_CommandBuffer);
+        glGenBuffers(1, &m_DrawBuffer);
+        glGenBuffers(1, &m_DrawIndexBuffer);
+    }
+
+    IndirectBatch::~IndirectBatch()
+    {
+        const GLuint buffers[] = {m_CommandBuffer, m_DrawBuffer, m_DrawIndexBuffer};
+        GLState::DeleteBuffers(3, buffers);
+    }
+
+    std::uint32_t IndirectBatch::Add(BufferArena::Handle mesh, glm::mat4 const &model, std::uint32_t layer)
+    {
+        DrawData draw;
+        draw.model = model;
+        draw.layer = layer;
+        std::fill(draw.padding, draw.padding + 3, 0u);
+        m_Meshes.push_back(mesh);
+        m_Draws.push_back(draw);
+        m_CommandsDirty = true;
+        MarkDirty(m_Draws.size() - 1);
+        return static_cast<std::uint32_t>(m_Draws.size() - 1);
+    }
+
+    void IndirectBatch::SetModel(std::uint32_t draw, glm::mat4 const &model)
+    {
+        m_Draws[draw].model = model;
+        MarkDirty(draw);
+    }
+
+    void IndirectBatch::Clear()
+    {
+        m_Meshes.clear();
+        m_Draws.clear();
+        m_CommandsDirty = true;
+        m_DirtyFirst = m_DirtyLast = 0;
+    }
+
+    void IndirectBatch::Draw(GLuint binding, GLenum mode)
+    {
+        if (m_Draws.empty())
+            return;
+        Upload();
+        if (m_AttributeArray != m_Arena.GetVertexArray().GetRendererID())
+            SetUpAttribute();
+
+        m_Arena.Bind();
+        GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer);
+        GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_DrawBuffer);
+        glMultiDrawElementsIndirect(mode, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(m_Commands.size()), 0);
+    }
+
+    void IndirectBatch::BuildCommands()
+    {
+        m_Commands.resize(m_Meshes.size());
+        for (std::size_t i = 0; i < m_Meshes.size(); i++)
+        {
+            BufferArena::Mesh const &mesh = m_Arena.Get(m_Meshes[i]);
+            Command &command = m_Commands[i];
+            command.count = mesh.indexCount;
+            command.instanceCount = 1;
+            command.firstIndex = mesh.firstIndex;
+            command.baseVertex = static_cast<std::int32_t>(mesh.baseVertex);
+            command.baseInstance = static_cast<std::uint32_t>(i);
+        }
+        GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, m_Commands.size() * sizeof(Command), m_Commands.data(), GL_STATIC_DRAW);
+
+        // The draw index attribute reads entry baseInstance, which must exist for every draw
+        if (m_DrawIndexCapacity < m_Commands.size())
+        {
+            m_DrawIndexCapacity = std::max(m_Commands.size(), m_DrawIndexCapacity * 2);
+            std::vector<std::uint32_t> indices(m_DrawIndexCapacity);
+            for (std::size_t i = 0; i < indices.size(); i++)
+                indices[i] = static_cast<std::uint32_t>(i);
+            GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_DrawIndexBuffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(std::uint32_t), indices.data(), GL_STATIC_DRAW);
+        }
+    }
+
+    void IndirectBatch::Upload()
+    {
+        // Growing or defragmenting the arena moves the meshes
+        BufferArena::Stats const &stats = m_Arena.GetStats();
+        const unsigned int version = stats.grows + stats.defragmentations;
+        if (version != m_ArenaVersion)
+            m_AttributeArray = 0; // a new VAO may reuse the old one's name
+        if (m_CommandsDirty || version != m_ArenaVersion)
+        {
+            BuildCommands();
+            m_ArenaVersion = version;
+            m_CommandsDirty = false;
+        }
+
+        if (m_DirtyFirst >= m_DirtyLast)
+            return;
+        GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_DrawBuffer);
+        if (m_DrawCapacity < m_Draws.size())
+        {
+            // Reallocating throws the old contents away, upload everything
+            m_DrawCapacity = std::max(m_Draws.size(), m_DrawCapacity * 2);
+            glBufferData(GL_COPY_WRITE_BUFFER, m_DrawCapacity * sizeof(DrawData), nullptr, GL_DYNAMIC_DRAW);
+            m_DirtyFirst = 0;
+            m_DirtyLast = m_Draws.size();
+        }
+        glBufferSubData(GL_COPY_WRITE_BUFFER, m_DirtyFirst * sizeof(DrawData), (m_DirtyLast - m_DirtyFirst) * sizeof(DrawData),
+                        &m_Draws[m_DirtyFirst]);
+        m_DirtyFirst = m_DirtyLast = 0;
+    }
+
+    void IndirectBatch::SetUpAttribute()
+    {
+        VertexArray const &array = m_Arena.GetVertexArray();
+        array.Bind();
+        GLState::BindBuffer(GL_ARRAY_BUFFER, m_DrawIndexBuffer);
+        glEnableVertexAttribArray(DrawIndexAttribute);
+        glVertexAttribIPointer(DrawIndexAttribute, 1, GL_UNSIGNED_INT, sizeof(std::uint32_t), nullptr);
+        // Advances once per instance, starting at the draw's base instance
+        glVertexAttribDivisor(DrawIndexAttribute, 1);
+        m_AttributeArray = array.GetRendererID();
+    }
+
+    void IndirectBatch::MarkDirty(std::size_t draw)
+    {
+        if (m_DirtyFirst >= m_DirtyLast)
+        {
+            m_DirtyFirst = draw;
+            m_DirtyLast = draw + 1;
+            return;
+        }
+        m_DirtyFirst = std::min(m_DirtyFirst, draw);
+        m_DirtyLast = std::max(m_DirtyLast, draw + 1);
+    }
+};
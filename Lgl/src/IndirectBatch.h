@@ -0,0 +1,95 @@
+#pragma once
+
+#include "BufferArena.h"
+// GLAD
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstdint>
+#include <vector>
+
+namespace Mirage
+{
+    /// Draws every mesh of a BufferArena placed in the batch with one glMultiDrawElementsIndirect
+    ///
+    /// Each draw becomes a DrawElementsIndirectCommand pointing at its mesh's
+    /// ranges of the shared buffers, with its index in the batch as base
+    /// instance. Per-draw data sits in a shader storage buffer; shaders find
+    /// their entry through an integer attribute with divisor 1 that reads the
+    /// draw's base instance from a 0, 1, 2, ... buffer (GL 4.3 has no
+    /// gl_DrawID without ARB_shader_draw_parameters). See indirect.vert for the
+    /// shader side. Only what changed is uploaded, so static scenes cost one
+    /// call per frame, and commands are rebuilt when the arena moves meshes.
+    class IndirectBatch
+    {
+    public:
+        /// Layout glMultiDrawElementsIndirect reads
+        struct Command
+        {
+            std::uint32_t count;
+            std::uint32_t instanceCount;
+            std::uint32_t firstIndex;
+            std::int32_t baseVertex;
+            std::uint32_t baseInstance;
+        };
+
+        /// One std430 entry of the per-draw storage buffer
+        struct DrawData
+        {
+            glm::mat4 model;
+            std::uint32_t layer; // e.g. the texture array layer to sample
+            std::uint32_t padding[3];
+        };
+
+        /// Attribute location of the draw index, vertex layouts must leave it free
+        static const GLuint DrawIndexAttribute = 7;
+
+    private:
+        BufferArena &m_Arena;
+        std::vector<BufferArena::Handle> m_Meshes;
+        std::vector<DrawData> m_Draws;
+        std::vector<Command> m_Commands;
+        GLuint m_CommandBuffer;
+        GLuint m_DrawBuffer;
+        GLuint m_DrawIndexBuffer;
+        std::size_t m_DrawCapacity;      // entries allocated in the draw buffer
+        std::size_t m_DrawIndexCapacity; // entries in the draw index buffer
+        GLuint m_AttributeArray;         // the arena VAO the draw index attribute was set up on
+        unsigned int m_ArenaVersion;     // arena rebuilds when the commands were last built
+        bool m_CommandsDirty;
+        std::size_t m_DirtyFirst; // range of m_Draws to upload, empty when first >= last
+        std::size_t m_DirtyLast;
+
+    public:
+        explicit IndirectBatch(BufferArena &arena);
+        ~IndirectBatch();
+
+        IndirectBatch(IndirectBatch const &) = delete;
+        IndirectBatch &operator=(IndirectBatch const &) = delete;
+
+        /// Places a mesh of the arena in the batch
+        ///
+        /// @param mesh A handle from the batch's arena
+        /// @param model The model matrix of this draw
+        /// @param layer Free for the shader, indirect.vert passes it on as the texture layer
+        /// @return The index of the draw
+        std::uint32_t Add(BufferArena::Handle mesh, glm::mat4 const &model, std::uint32_t layer = 0);
+        void SetModel(std::uint32_t draw, glm::mat4 const &model);
+        /// Drops every draw, the buffers are kept
+        void Clear();
+
+        /// Uploads what changed and issues the multi-draw, the program must be active
+        ///
+        /// @param binding The shader storage binding of the per-draw data
+        void Draw(GLuint binding = 1, GLenum mode = GL_TRIANGLES);
+
+        inline std::size_t GetCount() const { return m_Draws.size(); }
+
+    private:
+        void BuildCommands();
+        void Upload();
+        void SetUpAttribute();
+        void MarkDirty(std::size_t draw);
+    };
+};
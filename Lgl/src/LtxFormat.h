@@ -0,0 +1,43 @@
+#pragma once
+
+// Standard Headers
+#include <cstdint>
+
+namespace Mirage
+{
+    /// On-disk layout of cooked textures (.ltx) written by LglCooker
+    ///
+    /// A Header, then `levels` Level records, then the level payloads in their
+    /// final upload layout (rows tightly packed or 4x4 blocks, bottom row first),
+    /// each starting on a PayloadAlignment boundary so they can be uploaded
+    /// straight from a memory mapping.
+    namespace Ltx
+    {
+        const std::uint32_t Magic = 0x3158544c; // "LTX1"
+        const std::uint32_t Version = 1;
+        const std::uint32_t MaxLevels = 16;
+        const std::uint32_t PayloadAlignment = 16;
+
+        struct Header
+        {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint32_t width;
+            std::uint32_t height;
+            std::uint32_t levels;
+            std::uint32_t internalFormat; // sized or block compressed GL internal format
+            std::uint32_t format;         // pixel transfer format, e.g. GL_RGBA, 0 when compressed
+            std::uint32_t type;           // pixel transfer type, e.g. GL_UNSIGNED_BYTE, 0 when compressed
+            std::uint32_t channels;
+            std::uint32_t reserved;
+        };
+
+        struct Level
+        {
+            std::uint64_t offset; // from the start of the file
+            std::uint64_t size;   // in bytes
+            std::uint32_t width;
+            std::uint32_t height;
+        };
+    };
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+// Standard Headers
+#include <cstddef>
+#include <string>
+
+namespace Mirage
+{
+    /// Read-only memory mapping of a whole file
+    class MappedFile
+    {
+    private:
+        const unsigned char *m_Data;
+        std::size_t m_Size;
+#ifdef _WIN32
+        void *m_File;
+        void *m_Mapping;
+#endif
+
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        MappedFile(MappedFile const &) = delete;
+        MappedFile &operator=(MappedFile const &) = delete;
+
+        /// Maps the file, replacing any previous mapping
+        ///
+        /// @return false if the file can't be opened or is empty
+        bool Open(std::string const &path);
+        void Close();
+
+        inline const unsigned char *GetData() const { return m_Data; }
+        inline std::size_t GetSize() const { return m_Size; }
+        inline bool IsOpen() const { return m_Data != nullptr; }
+    };
+};
@@ -0,0 +1,458 @@
+#include "MeshOptimizer.h"
+#include "Hash.h"
+
+// GLM
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace Mirage
+{
+    const unsigned int MeshOptimizer::CacheSize;
+
+    /// The triangles around every vertex, a triangle with a repeated vertex is listed twice
+    struct Adjacency
+    {
+        std::vector<unsigned int> offsets; // triangles of vertex v start at offsets[v]
+        std::vector<unsigned int> counts;
+        std::vector<unsigned int> triangles;
+
+        Adjacency(const unsigned int *indices, std::size_t indexCount, std::size_t vertexCount)
+            : offsets(vertexCount + 1, 0), counts(vertexCount, 0), triangles(indexCount)
+        {
+            for (std::size_t i = 0; i < indexCount; i++)
+                counts[indices[i]]++;
+            for (std::size_t v = 0; v < vertexCount; v++)
+                offsets[v + 1] = offsets[v] + counts[v];
+            std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+            for (std::size_t i = 0; i < indexCount; i++)
+                triangles[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+        }
+    };
+
+    /// A FIFO cache simulated with timestamps: a vertex is cached while fewer than size misses followed its own
+    class FifoCache
+    {
+    private:
+        std::vector<unsigned int> m_Stamps;
+        unsigned int m_Time;
+        unsigned int m_Size;
+
+    public:
+        FifoCache(std::size_t vertexCount, unsigned int size) : m_Stamps(vertexCount, 0), m_Time(size + 1), m_Size(size) {}
+
+        /// True on a miss, which pushes the vertex
+        inline bool Access(unsigned int vertex)
+        {
+            if (m_Time - m_Stamps[vertex] <= m_Size)
+                return false;
+            m_Stamps[vertex] = m_Time++;
+            return true;
+        }
+        /// Ages everything out, as if the cache was flushed
+        inline void Flush() { m_Time += m_Size + 1; }
+    };
+
+    std::size_t MeshOptimizer::Deduplicate(const void *vertices, std::size_t vertexCount, std::size_t stride,
+                                           unsigned int *remap)
+    {
+        // Open addressing on the vertex bytes, the table holds the first vertex of each kind
+        const unsigned char *bytes = static_cast<const unsigned char *>(vertices);
+        std::size_t tableSize = 16;
+        while (tableSize < vertexCount * 2)
+            tableSize *= 2;
+        const unsigned int empty = 0xffffffffu;
+        std::vector<unsigned int> table(tableSize, empty);
+
+        std::size_t unique = 0;
+        for (std::size_t i = 0; i < vertexCount; i++)
+        {
+            const unsigned char *vertex = bytes + i * stride;
+            std::size_t slot = static_cast<std::size_t>(fnv1a64(vertex, stride)) & (tableSize - 1);
+            while (table[slot] != empty && std::memcmp(bytes + table[slot] * stride, vertex, stride) != 0)
+                slot = (slot + 1) & (tableSize - 1);
+            if (table[slot] == empty)
+            {
+                table[slot] = static_cast<unsigned int>(i);
+                remap[i] = static_cast<unsigned int>(unique++);
+            }
+            else
+                remap[i] = remap[table[slot]];
+        }
+        return unique;
+    }
+
+    void MeshOptimizer::RemapVertices(void *destination, const void *vertices, std::size_t vertexCount,
+                                      std::size_t stride, const unsigned int *remap)
+    {
+        unsigned char *to = static_cast<unsigned char *>(destination);
+        const unsigned char *from = static_cast<const unsigned char *>(vertices);
+        for (std::size_t i = 0; i < vertexCount; i++)
+            std::memcpy(to + static_cast<std::size_t>(remap[i]) * stride, from + i * stride, stride);
+    }
+
+    void MeshOptimizer::RemapIndices(unsigned int *destination, const unsigned int *indices, std::size_t indexCount,
+                                     const unsigned int *remap)
+    {
+        for (std::size_t i = 0; i < indexCount; i++)
+            destination[i] = remap[indices ? indices[i] : i];
+    }
+
+    void MeshOptimizer::OptimizeVertexCache(unsigned int *destination, const unsigned int *indices,
+                                            std::size_t indexCount, std::size_t vertexCount, Algorithm algorithm)
+    {
+        if (algorithm == Tipsify)
+            OptimizeTipsify(destination, indices, indexCount, vertexCount);
+        else
+            OptimizeForsyth(destination, indices, indexCount, vertexCount);
+    }
+
+    // Tom Forsyth, Linear-Speed Vertex Cache Optimisation, 2006. The modelled cache is LRU and
+    // larger than the FIFO being optimised for, which his tests found to work best.
+    static const int ForsythCacheSize = 32;
+
+    static float ForsythScore(int position, unsigned int live)
+    {
+        if (live == 0)
+            return -1.0f; // no triangles left to draw through this vertex
+        float score = 0.0f;
+        if (position >= 0 && position < 3)
+            score = 0.75f; // the last triangle's vertices, deliberately below the next ones to avoid strips
+        else if (position >= 0)
+            score = std::pow(1.0f - static_cast<float>(position - 3) / (ForsythCacheSize - 3), 1.5f);
+        // Vertices with few triangles left are finished off first, so they don't linger as dead ends
+        return score + 2.0f / std::sqrt(static_cast<float>(live));
+    }
+
+    void MeshOptimizer::OptimizeForsyth(unsigned int *destination, const unsigned int *indices, std::size_t indexCount,
+                                        std::size_t vertexCount)
+    {
+        const std::size_t triangleCount = indexCount / 3;
+        if (triangleCount == 0)
+            return;
+        Adjacency adjacency(indices, indexCount, vertexCount);
+        std::vector<unsigned int> &live = adjacency.counts; // shrinks as triangles are emitted
+        std::vector<float> scores(vertexCount);
+        for (std::size_t v = 0; v < vertexCount; v++)
+            scores[v] = ForsythScore(-1, live[v]);
+        auto triangleScore = [&scores, indices](std::size_t t)
+        { return scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]]; };
+        std::vector<char> emitted(triangleCount, 0);
+        std::size_t best = 0;
+        for (std::size_t t = 1; t < triangleCount; t++)
+            if (triangleScore(t) > triangleScore(best))
+                best = t;
+
+        unsigned int cache[ForsythCacheSize + 3], next[ForsythCacheSize + 3];
+        int cacheCount = 0;
+        std::size_t cursor = 0; // dead ends restart at the first triangle left in input order
+        const std::size_t none = ~std::size_t(0);
+        for (std::size_t out = 0; out < triangleCount; out++)
+        {
+            if (best == none)
+            {
+                while (emitted[cursor])
+                    cursor++;
+                best = cursor;
+            }
+            const unsigned int *triangle = indices + best * 3;
+            std::copy(triangle, triangle + 3, destination + out * 3);
+            emitted[best] = 1;
+
+            // Take the triangle out of its vertices' lists, the live ones stay in front
+            for (int k = 0; k < 3; k++)
+            {
+                const unsigned int v = triangle[k];
+                unsigned int *list = &adjacency.triangles[adjacency.offsets[v]];
+                unsigned int *found = std::find(list, list + live[v], static_cast<unsigned int>(best));
+                std::swap(*found, list[live[v] - 1]);
+                live[v]--;
+            }
+
+            // The triangle's vertices move to the front of the LRU, the rest shift back
+            int nextCount = 0;
+            for (int k = 0; k < 3; k++)
+                if (std::find(next, next + nextCount, triangle[k]) == next + nextCount)
+                    next[nextCount++] = triangle[k];
+            for (int i = 0; i < cacheCount; i++)
+                if (cache[i] != triangle[0] && cache[i] != triangle[1] && cache[i] != triangle[2])
+                    next[nextCount++] = cache[i];
+            for (int i = 0; i < nextCount; i++)
+                scores[next[i]] = ForsythScore(i < ForsythCacheSize ? i : -1, live[next[i]]);
+
+            // Only triangles of cached vertices changed score, the best of them goes next
+            best = none;
+            float bestScore = -1.0f;
+            for (int i = 0; i < nextCount; i++)
+            {
+                const unsigned int v = next[i];
+                const unsigned int *list = &adjacency.triangles[adjacency.offsets[v]];
+                for (unsigned int j = 0; j < live[v]; j++)
+                {
+                    const unsigned int t = list[j];
+                    const float score = triangleScore(t);
+                    if (score > bestScore)
+                    {
+                        bestScore = score;
+                        best = t;
+                    }
+                }
+            }
+            cacheCount = std::min(nextCount, ForsythCacheSize);
+            std::copy(next, next + cacheCount, cache);
+        }
+    }
+
+    // Sander, Nehab and Barczak, Fast Triangle Reordering for Vertex Locality and Reduced Overdraw, 2007
+    void MeshOptimizer::OptimizeTipsify(unsigned int *destination, const unsigned int *indices, std::size_t indexCount,
+                                        std::size_t vertexCount)
+    {
+        const std::size_t triangleCount = indexCount / 3;
+        if (triangleCount == 0)
+            return;
+        Adjacency adjacency(indices, indexCount, vertexCount);
+        std::vector<unsigned int> live(adjacency.counts);
+        std::vector<unsigned int> stamps(vertexCount, 0);
+        std::vector<char> emitted(triangleCount, 0);
+        std::vector<unsigned int> deadEnds, candidates;
+        unsigned int time = CacheSize + 1;
+        std::size_t cursor = 0, out = 0;
+
+        long fan = static_cast<long>(indices[0]);
+        while (fan >= 0)
+        {
+            // Emit every triangle left around the fanning vertex
+            candidates.clear();
+            const unsigned int *list = &adjacency.triangles[adjacency.offsets[fan]];
+            for (unsigned int j = 0; j < adjacency.counts[fan]; j++)
+            {
+                const unsigned int t = list[j];
+                if (emitted[t])
+                    continue;
+                emitted[t] = 1;
+                for (int k = 0; k < 3; k++)
+                {
+                    const unsigned int v = indices[t * 3 + k];
+                    destination[out++] = v;
+                    deadEnds.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+                    if (time - stamps[v] > CacheSize)
+                        stamps[v] = time++;
+                }
+            }
+
+            // Fan next around the candidate that has been cached longest and will still be
+            // cached after emitting its triangles, any live candidate beats a dead end
+            fan = -1;
+            long bestPriority = -1;
+            for (unsigned int v : candidates)
+            {
+                if (live[v] == 0)
+                    continue;
+                long priority = 0;
+                if (time - stamps[v] + 2 * live[v] <= CacheSize)
+                    priority = static_cast<long>(time - stamps[v]);
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    fan = static_cast<long>(v);
+                }
+            }
+            if (fan >= 0)
+                continue;
+            // Dead end, back off to a recently used vertex, then to the input order
+            while (!deadEnds.empty() && fan < 0)
+            {
+                const unsigned int v = deadEnds.back();
+                deadEnds.pop_back();
+                if (live[v] > 0)
+                    fan = static_cast<long>(v);
+            }
+            while (fan < 0 && cursor < vertexCount)
+            {
+                if (live[cursor] > 0)
+                    fan = static_cast<long>(cursor);
+                cursor++;
+            }
+        }
+    }
+
+    void MeshOptimizer::OptimizeOverdraw(unsigned int *destination, const unsigned int *indices, std::size_t indexCount,
+                                         const float *positions, std::size_t vertexCount, std::size_t positionStride,
+                                         float threshold)
+    {
+        const std::size_t triangleCount = indexCount / 3;
+        if (triangleCount == 0)
+            return;
+
+        // Hard boundaries: triangles missing the cache on every vertex, the cache starts over there anyway
+        std::vector<std::size_t> hard;
+        FifoCache cache(vertexCount, CacheSize);
+        for (std::size_t t = 0; t < triangleCount; t++)
+        {
+            int misses = 0;
+            for (int k = 0; k < 3; k++)
+                misses += cache.Access(indices[t * 3 + k]);
+            if (t == 0 || misses == 3)
+                hard.push_back(t);
+        }
+        hard.push_back(triangleCount);
+
+        // Soft boundaries: cut a cluster as soon as its running ACMR is within the threshold of the whole cluster's
+        std::vector<std::size_t> clusters;
+        for (std::size_t c = 0; c + 1 < hard.size(); c++)
+        {
+            const std::size_t first = hard[c], end = hard[c + 1];
+            cache.Flush();
+            unsigned int misses = 0;
+            for (std::size_t i = first * 3; i < end * 3; i++)
+                misses += cache.Access(indices[i]);
+            const float limit = static_cast<float>(misses) / (end - first) * threshold;
+
+            cache.Flush();
+            std::size_t start = first;
+            misses = 0;
+            clusters.push_back(first);
+            for (std::size_t t = first; t + 1 < end; t++)
+            {
+                for (int k = 0; k < 3; k++)
+                    misses += cache.Access(indices[t * 3 + k]);
+                if (static_cast<float>(misses) / (t + 1 - start) <= limit)
+                {
+                    clusters.push_back(t + 1);
+                    start = t + 1;
+                    misses = 0;
+                    cache.Flush();
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+
+        auto position = [positions, positionStride](unsigned int v)
+        {
+            const float *p = reinterpret_cast<const float *>(reinterpret_cast<const char *>(positions) + v * positionStride);
+            return glm::vec3(p[0], p[1], p[2]);
+        };
+        glm::vec3 meshCentroid(0.0f);
+        for (std::size_t v = 0; v < vertexCount; v++)
+            meshCentroid += position(static_cast<unsigned int>(v));
+        meshCentroid = meshCentroid / static_cast<float>(std::max<std::size_t>(vertexCount, 1));
+
+        // Clusters facing away from the centre and far out along their normal are likely in front of the rest
+        struct Cluster
+        {
+            std::size_t first, end;
+            float key;
+        };
+        std::vector<Cluster> sorted(clusters.size() - 1);
+        for (std::size_t i = 0; i + 1 < clusters.size(); i++)
+        {
+            glm::vec3 centroid(0.0f), normal(0.0f);
+            float area = 0.0f;
+            for (std::size_t t = clusters[i]; t < clusters[i + 1]; t++)
+            {
+                const glm::vec3 a = position(indices[t * 3]), b = position(indices[t * 3 + 1]), c = position(indices[t * 3 + 2]);
+                const glm::vec3 cross = glm::cross(b - a, c - a); // twice the area along the normal
+                const float weight = glm::length(cross);
+                centroid += (a + b + c) * (weight / 3.0f);
+                normal += cross;
+                area += weight;
+            }
+            Cluster &cluster = sorted[i];
+            cluster.first = clusters[i];
+            cluster.end = clusters[i + 1];
+            const float normalLength = glm::length(normal);
+            cluster.key = area > 0.0f && normalLength > 0.0f
+                              ? glm::dot(centroid / area - meshCentroid, normal / normalLength)
+                              : 0.0f;
+        }
+        std::stable_sort(sorted.begin(), sorted.end(), [](Cluster const &a, Cluster const &b)
+                         { return a.key > b.key; });
+
+        for (Cluster const &cluster : sorted)
+        {
+            std::copy(indices + cluster.first * 3, indices + cluster.end * 3, destination);
+            destination += (cluster.end - cluster.first) * 3;
+        }
+    }
+
+    std::size_t MeshOptimizer::OptimizeVertexFetch(void *destination, unsigned int *indices, std::size_t indexCount,
+                                                   const void *vertices, std::size_t vertexCount, std::size_t stride)
+    {
+        const unsigned int unused = 0xffffffffu;
+        std::vector<unsigned int> remap(vertexCount, unused);
+        const unsigned char *from = static_cast<const unsigned char *>(vertices);
+        unsigned char *to = static_cast<unsigned char *>(destination);
+        unsigned int next = 0;
+        for (std::size_t i = 0; i < indexCount; i++)
+        {
+            unsigned int &index = remap[indices[i]];
+            if (index == unused)
+            {
+                std::memcpy(to + static_cast<std::size_t>(next) * stride, from + static_cast<std::size_t>(indices[i]) * stride,
+                            stride);
+                index = next++;
+            }
+            indices[i] = index;
+        }
+        return next;
+    }
+
+    MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache(const unsigned int *indices, std::size_t indexCount,
+                                                                std::size_t vertexCount, unsigned int cacheSize)
+    {
+        FifoCache cache(vertexCount, cacheSize);
+        std::vector<char> referenced(vertexCount, 0);
+        std::size_t unique = 0;
+        CacheStats stats = {0, 0.0f, 0.0f};
+        for (std::size_t i = 0; i < indexCount; i++)
+        {
+            stats.transformed += cache.Access(indices[i]);
+            if (!referenced[indices[i]])
+            {
+                referenced[indices[i]] = 1;
+                unique++;
+            }
+        }
+        if (indexCount >= 3)
+            stats.acmr = static_cast<float>(stats.transformed) / (indexCount / 3);
+        if (unique)
+            stats.atvr = static_cast<float>(stats.transformed) / unique;
+        return stats;
+    }
+
+    MeshOptimizer::FetchStats MeshOptimizer::AnalyzeVertexFetch(const unsigned int *indices, std::size_t indexCount,
+                                                                std::size_t vertexCount, std::size_t stride)
+    {
+        const std::size_t lineSize = 64, lineCount = 256;
+        FifoCache transformed(vertexCount, CacheSize);
+        // Lines are tracked by address, the vertex range is small enough to give every line a stamp
+        FifoCache lines((vertexCount * stride + lineSize - 1) / lineSize, lineCount);
+        std::vector<char> referenced(vertexCount, 0);
+        std::size_t unique = 0;
+        FetchStats stats = {0, 0.0f};
+        for (std::size_t i = 0; i < indexCount; i++)
+        {
+            const unsigned int v = indices[i];
+            if (!referenced[v])
+            {
+                referenced[v] = 1;
+                unique++;
+            }
+            if (!transformed.Access(v))
+                continue;
+            const std::size_t first = v * stride / lineSize, last = (v * stride + stride - 1) / lineSize;
+            for (std::size_t line = first; line <= last; line++)
+                if (lines.Access(static_cast<unsigned int>(line)))
+                    stats.bytesFetched += lineSize;
+        }
+        if (unique)
+            stats.overfetch = static_cast<float>(stats.bytesFetched) / (unique * stride);
+        return stats;
+    }
+};
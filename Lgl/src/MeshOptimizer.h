@@ -0,0 +1,129 @@
+#pragma once
+
+// Standard Headers
+#include <cstddef>
+#include <vector>
+
+namespace Mirage
+{
+    /// Reorders triangle lists and their vertices for the GPU's vertex caches
+    ///
+    /// The stages run in this order on an indexed mesh:
+    ///
+    ///     unique = Deduplicate(soup, count, stride, remap)      // soup to indexed mesh
+    ///     RemapVertices / RemapIndices
+    ///     OptimizeVertexCache                                   // post-transform cache
+    ///     OptimizeOverdraw                                      // front clusters first
+    ///     OptimizeVertexFetch                                   // pre-transform cache
+    ///
+    /// Every function writes to a separate destination, which may alias the
+    /// source only where noted. Indices are 32 bit, as IndexBuffer stores them.
+    /// Optimize() runs them all on vectors of vertex structs.
+    class MeshOptimizer
+    {
+    public:
+        enum Algorithm
+        {
+            Forsyth, // scores vertices by LRU position and remaining valence, independent of the cache size
+            Tipsify  // fans around vertices still in a FIFO of CacheSize, usually the lower ACMR on such caches
+        };
+
+        /// Post-transform cache behaviour of an index buffer, simulated as a FIFO
+        struct CacheStats
+        {
+            unsigned int transformed; // vertex shader invocations
+            float acmr;               // average cache miss ratio, transformed vertices per triangle (0.5 to 3)
+            float atvr;               // average transformed vertex ratio, transformed per referenced vertex (1 is ideal)
+        };
+
+        /// Pre-transform (memory) behaviour, cache lines read for the vertices that miss the post-transform cache
+        struct FetchStats
+        {
+            std::size_t bytesFetched;
+            float overfetch; // bytes fetched per byte of referenced vertices (1 is ideal)
+        };
+
+        /// Size of the post-transform FIFO the analysis simulates, and the Tipsify target
+        static const unsigned int CacheSize = 16;
+
+        /// Merges vertices that are bitwise equal
+        ///
+        /// @param vertices The vertices, e.g. a non-indexed triangle soup
+        /// @param remap Receives for every vertex its index among the unique ones, numbered by first occurrence
+        /// @return The number of unique vertices
+        static std::size_t Deduplicate(const void *vertices, std::size_t vertexCount, std::size_t stride,
+                                       unsigned int *remap);
+        /// Moves every vertex to remap[i], destination holds the unique vertex count
+        static void RemapVertices(void *destination, const void *vertices, std::size_t vertexCount, std::size_t stride,
+                                  const unsigned int *remap);
+        /// Translates indices through the remap table, null indices stand for 0 to indexCount - 1.
+        /// The destination may be the source.
+        static void RemapIndices(unsigned int *destination, const unsigned int *indices, std::size_t indexCount,
+                                 const unsigned int *remap);
+
+        /// Reorders triangles so vertices are reused while still transformed
+        static void OptimizeVertexCache(unsigned int *destination, const unsigned int *indices, std::size_t indexCount,
+                                        std::size_t vertexCount, Algorithm algorithm = Tipsify);
+
+        /// Reorders clusters of a cache optimised index buffer so triangles likely to be in front come
+        /// first, which lets early depth testing reject more of what follows (Sander et al. 2007)
+        ///
+        /// The buffer is cut where the cache starts over anyway, and where the ACMR reached so far is
+        /// within the threshold of the cluster's, so the ACMR grows by at most about the threshold.
+        ///
+        /// @param positions The x, y and z floats of vertex 0
+        /// @param positionStride Bytes from one vertex's position to the next
+        /// @param threshold ACMR increase allowed to get more, smaller clusters, e.g. 1.05
+        static void OptimizeOverdraw(unsigned int *destination, const unsigned int *indices, std::size_t indexCount,
+                                     const float *positions, std::size_t vertexCount, std::size_t positionStride,
+                                     float threshold = 1.05f);
+
+        /// Orders vertices by first use so each fetch likely hits a cache line the last one loaded,
+        /// and rewrites the indices in place. Unreferenced vertices are dropped.
+        ///
+        /// @param destination Receives the reordered vertices, must not alias vertices
+        /// @return The number of vertices written
+        static std::size_t OptimizeVertexFetch(void *destination, unsigned int *indices, std::size_t indexCount,
+                                               const void *vertices, std::size_t vertexCount, std::size_t stride);
+
+        static CacheStats AnalyzeVertexCache(const unsigned int *indices, std::size_t indexCount, std::size_t vertexCount,
+                                             unsigned int cacheSize = CacheSize);
+        /// Simulates a 16 KB FIFO of 64 byte lines behind the post-transform cache
+        static FetchStats AnalyzeVertexFetch(const unsigned int *indices, std::size_t indexCount, std::size_t vertexCount,
+                                             std::size_t stride);
+
+        /// Runs every stage on a mesh of vertex structs
+        ///
+        /// @param vertices Replaced by the unique, referenced vertices in fetch order
+        /// @param indices Replaced by the optimised indices, empty for a triangle soup
+        /// @param positionOffset Offset of the x, y and z floats in Vertex
+        template <typename Vertex>
+        static void Optimize(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices,
+                             std::size_t positionOffset = 0)
+        {
+            const std::size_t indexCount = indices.empty() ? vertices.size() : indices.size();
+            std::vector<unsigned int> remap(vertices.size());
+            const std::size_t unique = Deduplicate(vertices.data(), vertices.size(), sizeof(Vertex), remap.data());
+            std::vector<Vertex> merged(unique);
+            RemapVertices(merged.data(), vertices.data(), vertices.size(), sizeof(Vertex), remap.data());
+
+            std::vector<unsigned int> remapped(indexCount), ordered(indexCount);
+            RemapIndices(remapped.data(), indices.empty() ? nullptr : indices.data(), indexCount, remap.data());
+            OptimizeVertexCache(ordered.data(), remapped.data(), indexCount, unique);
+            const float *positions =
+                reinterpret_cast<const float *>(reinterpret_cast<const char *>(merged.data()) + positionOffset);
+            OptimizeOverdraw(remapped.data(), ordered.data(), indexCount, positions, unique, sizeof(Vertex));
+
+            vertices.resize(unique);
+            vertices.resize(OptimizeVertexFetch(vertices.data(), remapped.data(), indexCount, merged.data(), unique,
+                                                sizeof(Vertex)));
+            indices.swap(remapped);
+        }
+
+    private:
+        static void OptimizeForsyth(unsigned int *destination, const unsigned int *indices, std::size_t indexCount,
+                                    std::size_t vertexCount);
+        static void OptimizeTipsify(unsigned int *destination, const unsigned int *indices, std::size_t indexCount,
+                                    std::size_t vertexCount);
+    };
+};
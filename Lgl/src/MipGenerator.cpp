@@ -0,0 +1,835 @@
+#include "MipGenerator.h"
+#include "ScratchArena.h"
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MIRAGE_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// AVX2 kernels are compiled for AVX2 individually, the rest of the build stays baseline
+#if defined(MIRAGE_X86) && defined(__GNUC__)
+#define MIRAGE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MIRAGE_TARGET_AVX2
+#endif
+
+namespace Mirage
+{
+    static const int KaiserTaps = 6;
+
+    /// Kaiser windowed sinc for a 2:1 reduction, tap k reads source texel 2x - 2 + k
+    static std::vector<float> KaiserWeights()
+    {
+        // Zeroth order modified Bessel function of the first kind
+        auto bessel = [](double x)
+        {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 20; k++)
+            {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }
+            return sum;
+        };
+
+        const double pi = 3.14159265358979323846, beta = 4.0, radius = 3.0;
+        std::vector<float> weights(KaiserTaps);
+        double total = 0.0;
+        for (int k = 0; k < KaiserTaps; k++)
+        {
+            // Distance from the destination texel centre in source texels
+            const double t = k - 2.5, x = t / 2.0;
+            const double sinc = std::sin(pi * x) / (pi * x);
+            const double window = bessel(beta * std::sqrt(1.0 - (t / radius) * (t / radius))) / bessel(beta);
+            weights[k] = static_cast<float>(sinc * window);
+            total += weights[k];
+        }
+        for (auto &weight : weights)
+            weight = static_cast<float>(weight / total);
+        return weights;
+    }
+
+    static const std::vector<float> s_Kaiser = KaiserWeights();
+
+    /// sRGB decode of every 8 bit value, followed by the plain i / 255 conversion
+    static std::vector<float> DecodeTable()
+    {
+        std::vector<float> table(512);
+        for (int i = 0; i < 256; i++)
+        {
+            const float c = i / 255.0f;
+            table[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            table[256 + i] = c;
+        }
+        return table;
+    }
+
+    /// sRGB encode of linear values quantised to 12 bits, finer than the 8 bit output needs
+    static std::vector<unsigned char> EncodeTable()
+    {
+        std::vector<unsigned char> table(4096);
+        for (int i = 0; i < 4096; i++)
+        {
+            const float c = i / 4095.0f;
+            const float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            table[i] = static_cast<unsigned char>(std::min(255.0f, s * 255.0f + 0.5f));
+        }
+        return table;
+    }
+
+    static const std::vector<float> s_Decode = DecodeTable();
+    static const std::vector<unsigned char> s_Encode = EncodeTable();
+
+    static inline int LevelSize(int size) { return std::max(1, size / 2); }
+
+    /// Float buffer from the arena bound to the thread, the loader workers reuse its memory between images
+    struct Scratch
+    {
+        float *data;
+
+        explicit Scratch(std::size_t count)
+            : data(static_cast<float *>(ScratchArena::Malloc(count * sizeof(float))))
+        {
+        }
+        ~Scratch() { ScratchArena::Release(data); }
+
+        Scratch(Scratch const &) = delete;
+        Scratch &operator=(Scratch const &) = delete;
+    };
+
+    // ---------------------------------------------------------------------
+    // 8 bit box filter, plain data only
+
+    static void BoxBytesRowScalar(const unsigned char *row0, const unsigned char *row1, int width, unsigned char *dst,
+                                  int begin, int end)
+    {
+        for (int x = begin; x < end; x++)
+        {
+            const int x0 = 2 * x, x1 = std::min(2 * x + 1, width - 1);
+            for (int c = 0; c < 4; c++)
+                dst[x * 4 + c] = static_cast<unsigned char>(
+                    (row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c] + 2) >> 2);
+        }
+    }
+
+#ifdef MIRAGE_X86
+    /// 4 destination texels per iteration
+    static int BoxBytesRowSSE2(const unsigned char *row0, const unsigned char *row1, unsigned char *dst, int count)
+    {
+        const __m128i zero = _mm_setzero_si128(), two = _mm_set1_epi16(2);
+        int x = 0;
+        for (; x + 4 <= count; x += 4)
+        {
+            const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + x * 8));
+            const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + x * 8 + 16));
+            const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + x * 8));
+            const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + x * 8 + 16));
+
+            // Vertical sums in 16 bits, two texels per register
+            const __m128i p01 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+            const __m128i p23 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+            const __m128i p45 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+            const __m128i p67 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+            // Horizontal pairs: even texels plus odd texels
+            __m128i d01 = _mm_add_epi16(_mm_unpacklo_epi64(p01, p23), _mm_unpackhi_epi64(p01, p23));
+            __m128i d23 = _mm_add_epi16(_mm_unpacklo_epi64(p45, p67), _mm_unpackhi_epi64(p45, p67));
+            d01 = _mm_srli_epi16(_mm_add_epi16(d01, two), 2);
+            d23 = _mm_srli_epi16(_mm_add_epi16(d23, two), 2);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x * 4), _mm_packus_epi16(d01, d23));
+        }
+        return x;
+    }
+
+    /// 8 destination texels per iteration
+    MIRAGE_TARGET_AVX2 static int BoxBytesRowAVX2(const unsigned char *row0, const unsigned char *row1, unsigned char *dst, int count)
+    {
+        const __m256i zero = _mm256_setzero_si256(), two = _mm256_set1_epi16(2);
+        int x = 0;
+        for (; x + 8 <= count; x += 8)
+        {
+            const __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row0 + x * 8));
+            const __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row0 + x * 8 + 32));
+            const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row1 + x * 8));
+            const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row1 + x * 8 + 32));
+
+            // Unpacks work per 128 bit lane: [p0 p1 | p4 p5] and [p2 p3 | p6 p7]
+            const __m256i lo0 = _mm256_add_epi16(_mm256_unpacklo_epi8(a0, zero), _mm256_unpacklo_epi8(b0, zero));
+            const __m256i hi0 = _mm256_add_epi16(_mm256_unpackhi_epi8(a0, zero), _mm256_unpackhi_epi8(b0, zero));
+            const __m256i lo1 = _mm256_add_epi16(_mm256_unpacklo_epi8(a1, zero), _mm256_unpacklo_epi8(b1, zero));
+            const __m256i hi1 = _mm256_add_epi16(_mm256_unpackhi_epi8(a1, zero), _mm256_unpackhi_epi8(b1, zero));
+
+            // [d0 d1 | d2 d3] and [d4 d5 | d6 d7]
+            __m256i d0 = _mm256_add_epi16(_mm256_unpacklo_epi64(lo0, hi0), _mm256_unpackhi_epi64(lo0, hi0));
+            __m256i d1 = _mm256_add_epi16(_mm256_unpacklo_epi64(lo1, hi1), _mm256_unpackhi_epi64(lo1, hi1));
+            d0 = _mm256_srli_epi16(_mm256_add_epi16(d0, two), 2);
+            d1 = _mm256_srli_epi16(_mm256_add_epi16(d1, two), 2);
+
+            // The pack interleaves lanes as d0 d1 d4 d5 | d2 d3 d6 d7, restore the order
+            const __m256i packed = _mm256_packus_epi16(d0, d1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x * 4), _mm256_permute4x64_epi64(packed, 0xd8));
+        }
+        return x;
+    }
+#endif
+
+    static void BoxBytes(const unsigned char *src, int width, int height, unsigned char *dst, MipGenerator::Simd simd)
+    {
+        const int dw = LevelSize(width), dh = LevelSize(height);
+        for (int y = 0; y < dh; y++)
+        {
+            const unsigned char *row0 = src + static_cast<std::size_t>(2 * y) * width * 4;
+            const unsigned char *row1 = src + static_cast<std::size_t>(std::min(2 * y + 1, height - 1)) * width * 4;
+            unsigned char *out = dst + static_cast<std::size_t>(y) * dw * 4;
+
+            // The vector kernels read texel pairs, a single column is left to the scalar loop
+            int done = 0;
+#ifdef MIRAGE_X86
+            if (width > 1 && simd == MipGenerator::AVX2)
+                done = BoxBytesRowAVX2(row0, row1, out, dw);
+            if (width > 1 && simd >= MipGenerator::SSE2)
+                done += BoxBytesRowSSE2(row0 + done * 8, row1 + done * 8, out + done * 4, dw - done);
+#else
+            (void)simd;
+#endif
+            BoxBytesRowScalar(row0, row1, width, out, done, dw);
+        }
+    }
+
+    // ---------------------------------------------------------------------
+    // Float filters on linear RGBA, 4 floats per texel
+
+    static void BoxFloatRowScalar(const float *row0, const float *row1, int width, float *dst, int begin, int end)
+    {
+        for (int x = begin; x < end; x++)
+        {
+            const int x0 = 2 * x, x1 = std::min(2 * x + 1, width - 1);
+            for (int c = 0; c < 4; c++)
+                dst[x * 4 + c] = 0.25f * (row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c]);
+        }
+    }
+
+#ifdef MIRAGE_X86
+    static int BoxFloatRowSSE2(const float *row0, const float *row1, float *dst, int count)
+    {
+        const __m128 quarter = _mm_set1_ps(0.25f);
+        for (int x = 0; x < count; x++)
+        {
+            __m128 sum = _mm_add_ps(_mm_loadu_ps(row0 + x * 8), _mm_loadu_ps(row0 + x * 8 + 4));
+            sum = _mm_add_ps(sum, _mm_add_ps(_mm_loadu_ps(row1 + x * 8), _mm_loadu_ps(row1 + x * 8 + 4)));
+            _mm_storeu_ps(dst + x * 4, _mm_mul_ps(sum, quarter));
+        }
+        return count;
+    }
+
+    /// 2 destination texels per iteration
+    MIRAGE_TARGET_AVX2 static int BoxFloatRowAVX2(const float *row0, const float *row1, float *dst, int count)
+    {
+        const __m256 quarter = _mm256_set1_ps(0.25f);
+        int x = 0;
+        for (; x + 2 <= count; x += 2)
+        {
+            // [p0 p1] and [p2 p3] summed over both rows
+            const __m256 a = _mm256_add_ps(_mm256_loadu_ps(row0 + x * 8), _mm256_loadu_ps(row1 + x * 8));
+            const __m256 b = _mm256_add_ps(_mm256_loadu_ps(row0 + x * 8 + 8), _mm256_loadu_ps(row1 + x * 8 + 8));
+            // [p0 p2] + [p1 p3]
+            const __m256 sum = _mm256_add_ps(_mm256_permute2f128_ps(a, b, 0x20), _mm256_permute2f128_ps(a, b, 0x31));
+            _mm256_storeu_ps(dst + x * 4, _mm256_mul_ps(sum, quarter));
+        }
+        return x;
+    }
+#endif
+
+    static void BoxFloats(const float *src, int width, int height, float *dst, MipGenerator::Simd simd)
+    {
+        const int dw = LevelSize(width), dh = LevelSize(height);
+        for (int y = 0; y < dh; y++)
+        {
+            const float *row0 = src + static_cast<std::size_t>(2 * y) * width * 4;
+            const float *row1 = src + static_cast<std::size_t>(std::min(2 * y + 1, height - 1)) * width * 4;
+            float *out = dst + static_cast<std::size_t>(y) * dw * 4;
+
+            int done = 0;
+#ifdef MIRAGE_X86
+            if (width > 1 && simd == MipGenerator::AVX2)
+                done = BoxFloatRowAVX2(row0, row1, out, dw);
+            if (width > 1 && simd >= MipGenerator::SSE2)
+                done += BoxFloatRowSSE2(row0 + done * 8, row1 + done * 8, out + done * 4, dw - done);
+#else
+            (void)simd;
+#endif
+            BoxFloatRowScalar(row0, row1, width, out, done, dw);
+        }
+    }
+
+    /// Horizontal Kaiser pass of one row, clamped at the edges
+    static void KaiserRowScalar(const float *row, int width, float *dst, int begin, int end)
+    {
+        for (int x = begin; x < end; x++)
+        {
+            float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (int k = 0; k < KaiserTaps; k++)
+            {
+                const float *texel = row + std::min(std::max(2 * x - 2 + k, 0), width - 1) * 4;
+                for (int c = 0; c < 4; c++)
+                    sum[c] += s_Kaiser[k] * texel[c];
+            }
+            for (int c = 0; c < 4; c++)
+                dst[x * 4 + c] = sum[c];
+        }
+    }
+
+    /// Vertical Kaiser pass over whole rows, the rows are clamped by the caller
+    static void KaiserColumnScalar(const float *const *rows, float *dst, int begin, int count)
+    {
+        for (int i = begin * 4; i < count * 4; i++)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < KaiserTaps; k++)
+                sum += s_Kaiser[k] * rows[k][i];
+            dst[i] = sum;
+        }
+    }
+
+#ifdef MIRAGE_X86
+    /// Texels whose taps are all inside the row, from 1 to (width - 4) / 2
+    static int KaiserRowSSE2(const float *row, float *dst, int begin, int end)
+    {
+        for (int x = begin; x < end; x++)
+        {
+            const float *taps = row + (2 * x - 2) * 4;
+            __m128 sum = _mm_mul_ps(_mm_set1_ps(s_Kaiser[0]), _mm_loadu_ps(taps));
+            for (int k = 1; k < KaiserTaps; k++)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(s_Kaiser[k]), _mm_loadu_ps(taps + k * 4)));
+            _mm_storeu_ps(dst + x * 4, sum);
+        }
+        return end;
+    }
+
+    /// 2 destination texels per iteration, their taps are 2 texels apart
+    MIRAGE_TARGET_AVX2 static int KaiserRowAVX2(const float *row, float *dst, int begin, int end)
+    {
+        int x = begin;
+        for (; x + 2 <= end; x += 2)
+        {
+            const float *taps = row + (2 * x - 2) * 4;
+            __m256 sum = _mm256_setzero_ps();
+            for (int k = 0; k < KaiserTaps; k++)
+            {
+                const __m256 texels = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(taps + k * 4)),
+                                                           _mm_loadu_ps(taps + (k + 2) * 4), 1);
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(s_Kaiser[k]), texels));
+            }
+            _mm256_storeu_ps(dst + x * 4, sum);
+        }
+        return x;
+    }
+
+    static int KaiserColumnSSE2(const float *const *rows, float *dst, int begin, int count)
+    {
+        for (int i = begin * 4; i < count * 4; i += 4)
+        {
+            __m128 sum = _mm_mul_ps(_mm_set1_ps(s_Kaiser[0]), _mm_loadu_ps(rows[0] + i));
+            for (int k = 1; k < KaiserTaps; k++)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(s_Kaiser[k]), _mm_loadu_ps(rows[k] + i)));
+            _mm_storeu_ps(dst + i, sum);
+        }
+        return count;
+    }
+
+    MIRAGE_TARGET_AVX2 static int KaiserColumnAVX2(const float *const *rows, float *dst, int count)
+    {
+        int x = 0;
+        for (; x + 2 <= count; x += 2)
+        {
+            __m256 sum = _mm256_mul_ps(_mm256_set1_ps(s_Kaiser[0]), _mm256_loadu_ps(rows[0] + x * 4));
+            for (int k = 1; k < KaiserTaps; k++)
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(s_Kaiser[k]), _mm256_loadu_ps(rows[k] + x * 4)));
+            _mm256_storeu_ps(dst + x * 4, sum);
+        }
+        return x;
+    }
+#endif
+
+    /// Separable Kaiser reduction, horizontal into a temporary then vertical
+    ///
+    /// @param temp dw * height texels for the horizontal pass
+    static void KaiserFloats(const float *src, int width, int height, float *dst, float *temp, MipGenerator::Simd simd)
+    {
+        const int dw = LevelSize(width), dh = LevelSize(height);
+
+        // Texels from 1 up to here have every tap inside the row
+        const int inner = std::max(1, std::min(dw, (width - 4) / 2 + 1));
+        for (int y = 0; y < height; y++)
+        {
+            const float *row = src + static_cast<std::size_t>(y) * width * 4;
+            float *out = &temp[static_cast<std::size_t>(y) * dw * 4];
+            KaiserRowScalar(row, width, out, 0, std::min(1, dw));
+            int done = 1;
+#ifdef MIRAGE_X86
+            if (simd == MipGenerator::AVX2)
+                done = KaiserRowAVX2(row, out, done, inner);
+            if (simd >= MipGenerator::SSE2)
+                done = KaiserRowSSE2(row, out, done, inner);
+#else
+            (void)simd;
+#endif
+            KaiserRowScalar(row, width, out, std::min(done, dw), dw);
+        }
+
+        for (int y = 0; y < dh; y++)
+        {
+            const float *rows[KaiserTaps];
+            for (int k = 0; k < KaiserTaps; k++)
+                rows[k] = &temp[static_cast<std::size_t>(std::min(std::max(2 * y - 2 + k, 0), height - 1)) * dw * 4];
+            float *out = dst + static_cast<std::size_t>(y) * dw * 4;
+            int done = 0;
+#ifdef MIRAGE_X86
+            if (simd == MipGenerator::AVX2)
+                done = KaiserColumnAVX2(rows, out, dw);
+            if (simd >= MipGenerator::SSE2)
+                done = KaiserColumnSSE2(rows, out, done, dw);
+#endif
+            KaiserColumnScalar(rows, out, done, dw);
+        }
+    }
+
+    // ---------------------------------------------------------------------
+    // Conversion between RGBA8 and linear floats, alpha is never sRGB encoded
+
+    static void DecodeScalar(const unsigned char *src, float *dst, std::size_t begin, std::size_t count, bool srgb,
+                             bool premultiplied)
+    {
+        const float *colour = &s_Decode[srgb ? 0 : 256], *linear = &s_Decode[256];
+        for (std::size_t i = begin; i < count; i++)
+        {
+            const float alpha = linear[src[i * 4 + 3]];
+            const float weight = premultiplied ? alpha : 1.0f;
+            for (int c = 0; c < 3; c++)
+                dst[i * 4 + c] = colour[src[i * 4 + c]] * weight;
+            dst[i * 4 + 3] = alpha;
+        }
+    }
+
+    static void EncodeScalar(const float *src, unsigned char *dst, std::size_t begin, std::size_t count, bool srgb,
+                             bool premultiplied)
+    {
+        // The Kaiser lobes can overshoot, everything is clamped
+        for (std::size_t i = begin; i < count; i++)
+        {
+            const float alpha = std::min(std::max(src[i * 4 + 3], 0.0f), 1.0f);
+            const float weight = premultiplied ? (alpha > 0.0f ? 1.0f / alpha : 0.0f) : 1.0f;
+            for (int c = 0; c < 3; c++)
+            {
+                const float value = std::min(std::max(src[i * 4 + c] * weight, 0.0f), 1.0f);
+                dst[i * 4 + c] = srgb ? s_Encode[static_cast<int>(value * 4095.0f + 0.5f)]
+                                      : static_cast<unsigned char>(static_cast<int>(value * 255.0f + 0.5f));
+            }
+            dst[i * 4 + 3] = static_cast<unsigned char>(static_cast<int>(alpha * 255.0f + 0.5f));
+        }
+    }
+
+#ifdef MIRAGE_X86
+    static std::size_t DecodeSSE2(const unsigned char *src, float *dst, std::size_t count, bool srgb, bool premultiplied)
+    {
+        const float *colour = &s_Decode[srgb ? 0 : 256], *linear = &s_Decode[256];
+        const __m128 rgb = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const unsigned char *texel = src + i * 4;
+            __m128 value = _mm_setr_ps(colour[texel[0]], colour[texel[1]], colour[texel[2]], linear[texel[3]]);
+            if (premultiplied)
+            {
+                const __m128 weighted = _mm_mul_ps(value, _mm_shuffle_ps(value, value, 0xff));
+                value = _mm_or_ps(_mm_and_ps(rgb, weighted), _mm_andnot_ps(rgb, value));
+            }
+            _mm_storeu_ps(dst + i * 4, value);
+        }
+        return count;
+    }
+
+    /// Clamps and unpremultiplies one texel, returns it scaled for the 8 bit or 12 bit lookup
+    static inline __m128 EncodePrepareSSE2(__m128 value, bool premultiplied)
+    {
+        const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+        const __m128 rgb = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+        const __m128 alpha = _mm_min_ps(_mm_max_ps(_mm_shuffle_ps(value, value, 0xff), zero), one);
+        if (premultiplied)
+        {
+            const __m128 weight = _mm_and_ps(_mm_cmpgt_ps(alpha, zero), _mm_div_ps(one, alpha));
+            value = _mm_mul_ps(value, weight);
+        }
+        value = _mm_min_ps(_mm_max_ps(value, zero), one);
+        return _mm_or_ps(_mm_and_ps(rgb, value), _mm_andnot_ps(rgb, alpha));
+    }
+
+    static std::size_t EncodeSSE2(const float *src, unsigned char *dst, std::size_t count, bool srgb, bool premultiplied)
+    {
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 scale = srgb ? _mm_setr_ps(4095.0f, 4095.0f, 4095.0f, 255.0f) : _mm_set1_ps(255.0f);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i texels[4];
+            for (int t = 0; t < 4; t++)
+            {
+                const __m128 value = EncodePrepareSSE2(_mm_loadu_ps(src + (i + t) * 4), premultiplied);
+                texels[t] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half));
+            }
+            if (srgb)
+            {
+                // 12 bit indices don't pack, look the colour up one channel at a time
+                for (int t = 0; t < 4; t++)
+                {
+                    int index[4];
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(index), texels[t]);
+                    for (int c = 0; c < 3; c++)
+                        dst[(i + t) * 4 + c] = s_Encode[index[c]];
+                    dst[(i + t) * 4 + 3] = static_cast<unsigned char>(index[3]);
+                }
+                continue;
+            }
+            const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(texels[0], texels[1]), _mm_packs_epi32(texels[2], texels[3]));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), packed);
+        }
+        return i;
+    }
+
+    /// 2 texels per iteration, the lookups are gathered
+    MIRAGE_TARGET_AVX2 static std::size_t DecodeAVX2(const unsigned char *src, float *dst, std::size_t count, bool srgb,
+                                                     bool premultiplied)
+    {
+        // Colour lanes index the sRGB or the linear half of the table, alpha always the linear one
+        const __m256i offset = srgb ? _mm256_setr_epi32(0, 0, 0, 256, 0, 0, 0, 256) : _mm256_set1_epi32(256);
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i * 4));
+            const __m256i index = _mm256_add_epi32(_mm256_cvtepu8_epi32(bytes), offset);
+            __m256 value = _mm256_i32gather_ps(s_Decode.data(), index, 4);
+            if (premultiplied)
+                value = _mm256_blend_ps(_mm256_mul_ps(value, _mm256_permute_ps(value, 0xff)), value, 0x88);
+            _mm256_storeu_ps(dst + i * 4, value);
+        }
+        return i;
+    }
+
+    MIRAGE_TARGET_AVX2 static std::size_t EncodeAVX2(const float *src, unsigned char *dst, std::size_t count, bool srgb,
+                                                     bool premultiplied)
+    {
+        const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), half = _mm256_set1_ps(0.5f);
+        const __m256 scale = srgb ? _mm256_setr_ps(4095.0f, 4095.0f, 4095.0f, 255.0f, 4095.0f, 4095.0f, 4095.0f, 255.0f)
+                                  : _mm256_set1_ps(255.0f);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256i texels[2];
+            for (int t = 0; t < 2; t++)
+            {
+                __m256 value = _mm256_loadu_ps(src + (i + t * 2) * 4);
+                const __m256 alpha = _mm256_min_ps(_mm256_max_ps(_mm256_permute_ps(value, 0xff), zero), one);
+                if (premultiplied)
+                {
+                    const __m256 weight = _mm256_and_ps(_mm256_cmp_ps(alpha, zero, _CMP_GT_OQ), _mm256_div_ps(one, alpha));
+                    value = _mm256_mul_ps(value, weight);
+                }
+                value = _mm256_blend_ps(_mm256_min_ps(_mm256_max_ps(value, zero), one), alpha, 0x88);
+                texels[t] = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(value, scale), half));
+            }
+            if (srgb)
+            {
+                for (int t = 0; t < 2; t++)
+                {
+                    int index[8];
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(index), texels[t]);
+                    for (int c = 0; c < 8; c++)
+                        dst[(i + t * 2) * 4 + c] = (c & 3) == 3 ? static_cast<unsigned char>(index[c]) : s_Encode[index[c]];
+                }
+                continue;
+            }
+            // Packs work per lane, the bytes come out as [t0 t2 t0 t2 | t1 t3 t1 t3] ...
+            const __m256i words = _mm256_packs_epi32(texels[0], texels[1]);
+            const __m256i bytes = _mm256_packus_epi16(words, words);
+            // ... so dwords 0, 4, 1, 5 hold texels 0, 1, 2, 3
+            const __m256i ordered = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 0, 0, 0, 0));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm256_castsi256_si128(ordered));
+        }
+        return i;
+    }
+#endif
+
+    static void Decode(const unsigned char *src, float *dst, std::size_t count, bool srgb, bool premultiplied,
+                       MipGenerator::Simd simd)
+    {
+        std::size_t done = 0;
+#ifdef MIRAGE_X86
+        if (simd == MipGenerator::AVX2)
+            done = DecodeAVX2(src, dst, count, srgb, premultiplied);
+        else if (simd == MipGenerator::SSE2)
+            done = DecodeSSE2(src, dst, count, srgb, premultiplied);
+#else
+        (void)simd;
+#endif
+        DecodeScalar(src, dst, done, count, srgb, premultiplied);
+    }
+
+    static void Encode(const float *src, unsigned char *dst, std::size_t count, bool srgb, bool premultiplied,
+                       MipGenerator::Simd simd)
+    {
+        std::size_t done = 0;
+#ifdef MIRAGE_X86
+        if (simd == MipGenerator::AVX2)
+            done = EncodeAVX2(src, dst, count, srgb, premultiplied);
+        else if (simd == MipGenerator::SSE2)
+            done = EncodeSSE2(src, dst, count, srgb, premultiplied);
+#else
+        (void)simd;
+#endif
+        EncodeScalar(src, dst, done, count, srgb, premultiplied);
+    }
+
+    // ---------------------------------------------------------------------
+
+    MipGenerator::MipGenerator(Filter filter, Simd simd)
+        : m_Filter(filter), m_Simd(std::min(simd, GetSupportedSimd())), m_SRGB(false), m_Premultiplied(false),
+          m_AlphaCutoff(0.0f)
+    {
+    }
+
+    std::size_t MipGenerator::GetChainSize(int width, int height)
+    {
+        std::size_t size = 0;
+        while (width > 1 || height > 1)
+        {
+            width = LevelSize(width);
+            height = LevelSize(height);
+            size += static_cast<std::size_t>(width) * height * 4;
+        }
+        return size;
+    }
+
+    void MipGenerator::Generate(const unsigned char *rgba, int width, int height, unsigned char *chain) const
+    {
+        // Plain box filtering never leaves 8 bits, it's exact there and twice as wide per register
+        if (m_Filter == Box && !m_SRGB && !m_Premultiplied)
+            GenerateBytes(rgba, width, height, chain);
+        else
+            GenerateFloats(rgba, width, height, chain);
+    }
+
+    static float Coverage(const unsigned char *rgba, std::size_t pixels, float cutoff, float scale)
+    {
+        std::size_t passed = 0;
+        for (std::size_t i = 0; i < pixels; i++)
+            if (rgba[i * 4 + 3] * scale > cutoff * 255.0f)
+                passed++;
+        return static_cast<float>(passed) / pixels;
+    }
+
+    void MipGenerator::GenerateBytes(const unsigned char *rgba, int width, int height, unsigned char *chain) const
+    {
+        const float coverage = m_AlphaCutoff > 0.0f ? Coverage(rgba, static_cast<std::size_t>(width) * height, m_AlphaCutoff, 1.0f) : 0.0f;
+        const unsigned char *src = rgba;
+        while (width > 1 || height > 1)
+        {
+            BoxBytes(src, width, height, chain, m_Simd);
+            width = LevelSize(width);
+            height = LevelSize(height);
+            if (m_AlphaCutoff > 0.0f)
+                PreserveCoverage(chain, static_cast<std::size_t>(width) * height, coverage);
+            src = chain;
+            chain += static_cast<std::size_t>(width) * height * 4;
+        }
+    }
+
+    void MipGenerator::GenerateFloats(const unsigned char *rgba, int width, int height, unsigned char *chain) const
+    {
+        const std::size_t pixels = static_cast<std::size_t>(width) * height;
+        const float coverage = m_AlphaCutoff > 0.0f ? Coverage(rgba, pixels, m_AlphaCutoff, 1.0f) : 0.0f;
+
+        // Decode once, the levels are filtered from each other without requantising. Levels ping-pong between the
+        // level 0 buffer and one sized for level 1, the Kaiser passes also need one for the horizontal pass
+        const std::size_t second = static_cast<std::size_t>(LevelSize(width)) * LevelSize(height);
+        const Scratch first(pixels * 4), other(second * 4);
+        const Scratch temp(m_Filter == Kaiser ? static_cast<std::size_t>(LevelSize(width)) * height * 4 : 0);
+        float *current = first.data, *next = other.data;
+        Decode(rgba, current, pixels, m_SRGB, m_Premultiplied, m_Simd);
+
+        while (width > 1 || height > 1)
+        {
+            const int dw = LevelSize(width), dh = LevelSize(height);
+            if (m_Filter == Kaiser)
+                KaiserFloats(current, width, height, next, temp.data, m_Simd);
+            else
+                BoxFloats(current, width, height, next, m_Simd);
+            width = dw;
+            height = dh;
+
+            const std::size_t count = static_cast<std::size_t>(width) * height;
+            Encode(next, chain, count, m_SRGB, m_Premultiplied, m_Simd);
+            if (m_AlphaCutoff > 0.0f)
+                PreserveCoverage(chain, count, coverage);
+            chain += count * 4;
+            std::swap(current, next);
+        }
+    }
+
+    void MipGenerator::PreserveCoverage(unsigned char *rgba, std::size_t pixels, float coverage) const
+    {
+        // Binary search the alpha scale whose coverage matches level 0
+        float low = 0.0f, high = 4.0f, scale = 1.0f;
+        for (int step = 0; step < 10; step++)
+        {
+            scale = 0.5f * (low + high);
+            if (Coverage(rgba, pixels, m_AlphaCutoff, scale) < coverage)
+                low = scale;
+            else
+                high = scale;
+        }
+        for (std::size_t i = 0; i < pixels; i++)
+            rgba[i * 4 + 3] = static_cast<unsigned char>(std::min(255.0f, rgba[i * 4 + 3] * scale + 0.5f));
+    }
+
+    // ---------------------------------------------------------------------
+    // Channel conversions
+
+#ifdef MIRAGE_X86
+    /// 4 texels per iteration, reads 16 bytes so the last 2 texels are left over
+    MIRAGE_TARGET_AVX2 static std::size_t ExpandRGBAVX2(const unsigned char *rgb, unsigned char *rgba, std::size_t pixels)
+    {
+        const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000u));
+        std::size_t i = 0;
+        for (; i + 6 <= pixels; i += 4)
+        {
+            const __m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgb + i * 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(rgba + i * 4), _mm_or_si128(_mm_shuffle_epi8(texels, shuffle), alpha));
+        }
+        return i;
+    }
+
+    /// SSE2 has no byte shuffle, each output channel is shifted out of its source byte
+    static std::size_t SwizzleSSE2(unsigned char *rgba, std::size_t pixels, const int order[4])
+    {
+        const __m128i mask = _mm_set1_epi32(0xff);
+        std::size_t i = 0;
+        for (; i + 4 <= pixels; i += 4)
+        {
+            const __m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgba + i * 4));
+            __m128i result = _mm_setzero_si128();
+            for (int c = 0; c < 4; c++)
+            {
+                const __m128i channel = _mm_and_si128(_mm_srl_epi32(texels, _mm_cvtsi32_si128(order[c] * 8)), mask);
+                result = _mm_or_si128(result, _mm_sll_epi32(channel, _mm_cvtsi32_si128(c * 8)));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(rgba + i * 4), result);
+        }
+        return i;
+    }
+
+    MIRAGE_TARGET_AVX2 static std::size_t SwizzleAVX2(unsigned char *rgba, std::size_t pixels, const int order[4])
+    {
+        char indices[32];
+        for (int i = 0; i < 32; i++)
+            indices[i] = static_cast<char>((i & ~3) + order[i & 3]);
+        const __m256i shuffle = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(indices));
+        std::size_t i = 0;
+        for (; i + 8 <= pixels; i += 8)
+        {
+            // The byte shuffle stays within 128 bit lanes, which texels never cross
+            const __m256i texels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rgba + i * 4));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(rgba + i * 4), _mm256_shuffle_epi8(texels, shuffle));
+        }
+        return i;
+    }
+#endif
+
+    void MipGenerator::ExpandRGB(const unsigned char *rgb, unsigned char *rgba, std::size_t pixels, Simd simd)
+    {
+        std::size_t i = 0;
+#ifdef MIRAGE_X86
+        // SSE2 has no byte shuffle to do better than the scalar loop
+        if (std::min(simd, GetSupportedSimd()) == AVX2)
+            i = ExpandRGBAVX2(rgb, rgba, pixels);
+#else
+        (void)simd;
+#endif
+        for (; i < pixels; i++)
+        {
+            rgba[i * 4] = rgb[i * 3];
+            rgba[i * 4 + 1] = rgb[i * 3 + 1];
+            rgba[i * 4 + 2] = rgb[i * 3 + 2];
+            rgba[i * 4 + 3] = 255;
+        }
+    }
+
+    void MipGenerator::Swizzle(unsigned char *rgba, std::size_t pixels, const int order[4], Simd simd)
+    {
+        std::size_t i = 0;
+#ifdef MIRAGE_X86
+        simd = std::min(simd, GetSupportedSimd());
+        if (simd == AVX2)
+            i = SwizzleAVX2(rgba, pixels, order);
+        else if (simd == SSE2)
+            i = SwizzleSSE2(rgba, pixels, order);
+#else
+        (void)simd;
+#endif
+        for (; i < pixels; i++)
+        {
+            unsigned char *texel = rgba + i * 4;
+            const unsigned char source[4] = {texel[0], texel[1], texel[2], texel[3]};
+            for (int c = 0; c < 4; c++)
+                texel[c] = source[order[c]];
+        }
+    }
+
+    MipGenerator::Simd MipGenerator::GetSupportedSimd()
+    {
+#if defined(MIRAGE_X86) && defined(__GNUC__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return AVX2;
+        return __builtin_cpu_supports("sse2") ? SSE2 : Scalar;
+#elif defined(MIRAGE_X86) && defined(_MSC_VER)
+        // Leaf 7 EBX bit 5 is AVX2, the OS must also save the YMM registers
+        int info[4];
+        __cpuid(info, 0);
+        const int leaves = info[0];
+        __cpuid(info, 1);
+        const bool sse2 = (info[3] & (1 << 26)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (leaves >= 7 && osxsave && (_xgetbv(0) & 6) == 6)
+        {
+            __cpuidex(info, 7, 0);
+            if (info[1] & (1 << 5))
+                return AVX2;
+        }
+        return sse2 ? SSE2 : Scalar;
+#else
+        return Scalar;
+#endif
+    }
+
+    const char *MipGenerator::GetSimdName(Simd simd)
+    {
+        switch (simd)
+        {
+        case SSE2:
+            return "SSE2";
+        case AVX2:
+            return "AVX2";
+        default:
+            return "scalar";
+        }
+    }
+};
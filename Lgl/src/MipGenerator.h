@@ -0,0 +1,82 @@
+#pragma once
+
+// Standard Headers
+#include <cstddef>
+
+namespace Mirage
+{
+    /// Builds mip chains of RGBA8 images on the CPU
+    ///
+    /// Unlike glGenerateMipmap the result doesn't depend on the driver, and the
+    /// filtering can decode sRGB to linear and weight colour by alpha before
+    /// averaging. Box filtering of plain data stays in 8 bit integers, everything
+    /// else runs on floats. Each kernel has a scalar, an SSE2 and an AVX2 version,
+    /// the best one the CPU supports is picked at run time.
+    class MipGenerator
+    {
+    public:
+        enum Filter
+        {
+            Box,   // 2x2 average
+            Kaiser // 6 tap Kaiser windowed sinc, sharper and with less aliasing
+        };
+
+        enum Simd
+        {
+            Scalar,
+            SSE2,
+            AVX2
+        };
+
+    private:
+        Filter m_Filter;
+        Simd m_Simd;
+        bool m_SRGB;
+        bool m_Premultiplied;
+        float m_AlphaCutoff;
+
+    public:
+        /// @param filter The downsampling filter
+        /// @param simd The instruction set to use, clamped to what the CPU supports
+        explicit MipGenerator(Filter filter = Box, Simd simd = AVX2);
+
+        /// Filters colour in linear space, for images stored as sRGB
+        inline void SetSRGB(bool srgb) { m_SRGB = srgb; }
+        /// Weights colour by alpha while filtering so transparent texels don't bleed in
+        inline void SetPremultipliedAlpha(bool premultiplied) { m_Premultiplied = premultiplied; }
+        /// Rescales the alpha of every level so the share of texels passing an alpha
+        /// test at this cutoff (0 to 1) matches level 0, 0 disables
+        inline void SetAlphaCutoff(float cutoff) { m_AlphaCutoff = cutoff; }
+
+        inline Filter GetFilter() const { return m_Filter; }
+        inline Simd GetSimd() const { return m_Simd; }
+
+        /// Generates levels 1 to n of an RGBA8 image
+        ///
+        /// @param rgba Level 0, tightly packed
+        /// @param width The width of level 0 in pixels
+        /// @param height The height of level 0 in pixels
+        /// @param chain Receives the levels one after another, GetChainSize() bytes
+        void Generate(const unsigned char *rgba, int width, int height, unsigned char *chain) const;
+
+        /// Bytes of levels 1 to n of an RGBA8 image
+        static std::size_t GetChainSize(int width, int height);
+
+        /// Widens RGB8 to RGBA8 with opaque alpha
+        static void ExpandRGB(const unsigned char *rgb, unsigned char *rgba, std::size_t pixels, Simd simd = AVX2);
+
+        /// Reorders the channels of RGBA8 pixels in place
+        ///
+        /// @param order Source channel of each destination channel, e.g. {2, 1, 0, 3} for BGRA
+        static void Swizzle(unsigned char *rgba, std::size_t pixels, const int order[4], Simd simd = AVX2);
+
+        /// The widest instruction set of the running CPU
+        static Simd GetSupportedSimd();
+        static const char *GetSimdName(Simd simd);
+
+    private:
+        void GenerateBytes(const unsigned char *rgba, int width, int height, unsigned char *chain) const;
+        void GenerateFloats(const unsigned char *rgba, int width, int height, unsigned char *chain) const;
+        void PreserveCoverage(unsigned char *rgba, std::size_t pixels, float coverage) const;
+    };
+};
@@ -0,0 +1,143 @@
+#include "PixelUploadRing.h"
+#include "GLCaps.h"
+#include "GLState.h"
+#include "Timer.h"
+
+// Standard Headers
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace Mirage
+{
+    PixelUploadRing::PixelUploadRing(std::size_t size)
+        : m_Size(size), m_Head(0)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &m_RendererID);
+        GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, m_RendererID);
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, m_Size, nullptr, flags);
+        m_Mapped = static_cast<unsigned char *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, m_Size, flags));
+        if (!m_Mapped)
+            std::cout << "Failed to map pixel upload ring, uploads go through client memory" << std::endl;
+        GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        ResetStats();
+    }
+
+    PixelUploadRing::~PixelUploadRing()
+    {
+        for (auto const &range : m_InFlight)
+            glDeleteSync(range.fence);
+        if (m_Mapped)
+        {
+            GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, m_RendererID);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        GLState::DeleteBuffers(1, &m_RendererID);
+    }
+
+    bool PixelUploadRing::IsSupported()
+    {
+        return GLCaps::Get().bufferStorage;
+    }
+
+    void PixelUploadRing::ResetStats()
+    {
+        m_Stats.bytes = 0;
+        m_Stats.uploads = 0;
+        m_Stats.stalls = 0;
+        m_Stats.stallMs = 0.0;
+        m_Stats.elapsedMs = 0.0;
+    }
+
+    void PixelUploadRing::Upload(GLuint texture, int level, int width, int height, GLenum format,
+                                 int bytesPerPixel, const void *pixels)
+    {
+        Stopwatch watch;
+        const std::size_t pitch = static_cast<std::size_t>(width) * bytesPerPixel;
+        const unsigned char *source = static_cast<const unsigned char *>(pixels);
+
+        // The texture is bound to the active unit for the copy, whatever that unit sampled is put back after
+        const GLuint previous = GLState::GetTexture(GL_TEXTURE_2D);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        GLState::BindTexture(GL_TEXTURE_2D, texture);
+
+        // A single row larger than the ring or a failed map can't be staged, let the driver copy it
+        if (!m_Mapped || pitch > m_Size)
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, format, GL_UNSIGNED_BYTE, pixels);
+            GLState::BindTexture(GL_TEXTURE_2D, previous);
+            m_Stats.elapsedMs += watch.ElapsedMs();
+            return;
+        }
+
+        GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, m_RendererID);
+        const int stripRows = static_cast<int>(std::min<std::size_t>(height, m_Size / pitch));
+        for (int row = 0; row < height; row += stripRows)
+        {
+            const int rows = std::min(stripRows, height - row);
+            const std::size_t bytes = pitch * rows;
+            const std::size_t offset = Allocate(bytes);
+            memcpy(m_Mapped + offset, source + pitch * row, bytes);
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, row, width, rows, format, GL_UNSIGNED_BYTE,
+                            reinterpret_cast<const void *>(offset));
+
+            InFlight range = {glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), offset, offset + bytes};
+            m_InFlight.push_back(range);
+            m_Stats.bytes += bytes;
+            m_Stats.uploads++;
+        }
+        // Client pointer uploads elsewhere must not read from the ring
+        GLState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        GLState::BindTexture(GL_TEXTURE_2D, previous);
+        m_Stats.elapsedMs += watch.ElapsedMs();
+    }
+
+    std::size_t PixelUploadRing::Allocate(std::size_t bytes)
+    {
+        // Wrap to the start when the tail can't hold the range
+        if (m_Head + bytes > m_Size)
+            m_Head = 0;
+        const std::size_t begin = m_Head, end = m_Head + bytes;
+
+        Retire(false);
+        for (;;)
+        {
+            bool overlaps = false;
+            for (auto const &range : m_InFlight)
+                overlaps = overlaps || (range.begin < end && begin < range.end);
+            if (!overlaps)
+                break;
+            Retire(true);
+        }
+
+        m_Head = end;
+        return begin;
+    }
+
+    void PixelUploadRing::Retire(bool wait)
+    {
+        // Ranges complete in submission order, drop the signalled ones from the front
+        while (!m_InFlight.empty())
+        {
+            GLsync fence = m_InFlight.front().fence;
+            GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            if (status == GL_TIMEOUT_EXPIRED)
+            {
+                if (!wait)
+                    return;
+                Stopwatch watch;
+                while (status == GL_TIMEOUT_EXPIRED)
+                    status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+                m_Stats.stalls++;
+                m_Stats.stallMs += watch.ElapsedMs();
+            }
+            glDeleteSync(fence);
+            m_InFlight.pop_front();
+            // Waiting frees exactly one range, the caller checks again
+            if (wait)
+                return;
+        }
+    }
+};
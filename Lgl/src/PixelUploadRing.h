@@ -0,0 +1,82 @@
+#pragma once
+
+// GLAD
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstddef>
+#include <deque>
+
+namespace Mirage
+{
+    /// Streams texture data through a persistently mapped GL_PIXEL_UNPACK_BUFFER
+    ///
+    /// Pixels are copied into the next free range of the ring and glTexSubImage2D
+    /// reads them from the buffer, so the call returns without the driver copying
+    /// the client memory. Each upload is fenced and a range is only reused once
+    /// the GPU has consumed it. Needs GL 4.4 or ARB_buffer_storage.
+    class PixelUploadRing
+    {
+    public:
+        struct Stats
+        {
+            std::size_t bytes;   // bytes written into the ring
+            unsigned int uploads; // glTexSubImage2D calls issued
+            unsigned int stalls;  // waits on a fence that had not signalled yet
+            double stallMs;       // time spent in those waits
+            double elapsedMs;     // time spent inside Upload()
+
+            inline double MegabytesPerSecond() const
+            {
+                return elapsedMs > 0.0 ? bytes / (elapsedMs * 1000.0) : 0.0;
+            }
+        };
+
+    private:
+        struct InFlight
+        {
+            GLsync fence;
+            std::size_t begin;
+            std::size_t end;
+        };
+
+        GLuint m_RendererID;
+        unsigned char *m_Mapped;
+        std::size_t m_Size;
+        std::size_t m_Head;
+        std::deque<InFlight> m_InFlight;
+        Stats m_Stats;
+
+    public:
+        /// @param size The size of the ring in bytes
+        explicit PixelUploadRing(std::size_t size = 32 << 20);
+        ~PixelUploadRing();
+
+        PixelUploadRing(PixelUploadRing const &) = delete;
+        PixelUploadRing &operator=(PixelUploadRing const &) = delete;
+
+        static bool IsSupported();
+
+        /// Copies an image into one level of a texture that already has storage, images
+        /// larger than the ring are split into row strips. When the ring couldn't be
+        /// mapped the pixels are uploaded from client memory instead
+        ///
+        /// @param texture The texture name, bound to GL_TEXTURE_2D by this call
+        /// @param level The mip level to write
+        /// @param width The width of the image in pixels
+        /// @param height The height of the image in pixels
+        /// @param format The pixel format, e.g. GL_RGBA
+        /// @param bytesPerPixel The size of one tightly packed pixel
+        /// @param pixels The source pixels
+        void Upload(GLuint texture, int level, int width, int height, GLenum format,
+                    int bytesPerPixel, const void *pixels);
+
+        inline Stats const &GetStats() const { return m_Stats; }
+        void ResetStats();
+
+    private:
+        /// Reserves a contiguous range, waiting for the GPU where it is still in use
+        std::size_t Allocate(std::size_t bytes);
+        void Retire(bool wait);
+    };
+};
@@ -0,0 +1,270 @@
+#include "RangeAllocator.h"
+
+// Standard Headers
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Mirage
+{
+    /// Index of the lowest set bit, the value must not be 0
+    static inline int LowestBit(std::uint32_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, value);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(value);
+#endif
+    }
+
+    /// Index of the highest set bit, the value must not be 0
+    static inline int HighestBit(std::uint32_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse(&index, value);
+        return static_cast<int>(index);
+#else
+        return 31 - __builtin_clz(value);
+#endif
+    }
+
+    const std::uint32_t RangeAllocator::Invalid;
+
+    RangeAllocator::RangeAllocator(std::uint32_t capacity)
+        : m_FirstLevelMap(0), m_Capacity(capacity), m_Used(0), m_Last(Invalid), m_Allocations(0)
+    {
+        std::fill(m_SecondLevelMap, m_SecondLevelMap + FirstLevelCount, 0u);
+        std::fill(&m_Heads[0][0], &m_Heads[0][0] + FirstLevelCount * SecondLevelCount, Invalid);
+        if (capacity == 0)
+            return;
+
+        m_Last = NewNode();
+        Node &node = m_Nodes[m_Last];
+        node.offset = 0;
+        node.size = capacity;
+        InsertFree(m_Last);
+    }
+
+    void RangeAllocator::Mapping(std::uint32_t size, int &firstLevel, int &secondLevel)
+    {
+        // Sizes below the second level count get a class each, above that a class spans 1/16 of a power of two
+        if (size < static_cast<std::uint32_t>(SecondLevelCount))
+        {
+            firstLevel = 0;
+            secondLevel = static_cast<int>(size);
+            return;
+        }
+        const int highest = HighestBit(size);
+        secondLevel = static_cast<int>(size >> (highest - SecondLevelBits)) - SecondLevelCount;
+        firstLevel = highest - SecondLevelBits + 1;
+    }
+
+    std::uint32_t RangeAllocator::NewNode()
+    {
+        std::uint32_t index;
+        if (!m_UnusedNodes.empty())
+        {
+            index = m_UnusedNodes.back();
+            m_UnusedNodes.pop_back();
+        }
+        else
+        {
+            index = static_cast<std::uint32_t>(m_Nodes.size());
+            m_Nodes.push_back(Node());
+        }
+        Node node = {0, 0, Invalid, Invalid, Invalid, Invalid, false};
+        m_Nodes[index] = node;
+        return index;
+    }
+
+    void RangeAllocator::InsertFree(std::uint32_t index)
+    {
+        int fl, sl;
+        Mapping(m_Nodes[index].size, fl, sl);
+        Node &node = m_Nodes[index];
+        node.used = false;
+        node.prevFree = Invalid;
+        node.nextFree = m_Heads[fl][sl];
+        if (node.nextFree != Invalid)
+            m_Nodes[node.nextFree].prevFree = index;
+        m_Heads[fl][sl] = index;
+        m_FirstLevelMap |= 1u << fl;
+        m_SecondLevelMap[fl] |= 1u << sl;
+    }
+
+    void RangeAllocator::RemoveFree(std::uint32_t index)
+    {
+        int fl, sl;
+        Node &node = m_Nodes[index];
+        Mapping(node.size, fl, sl);
+        if (node.prevFree != Invalid)
+            m_Nodes[node.prevFree].nextFree = node.nextFree;
+        else
+            m_Heads[fl][sl] = node.nextFree;
+        if (node.nextFree != Invalid)
+            m_Nodes[node.nextFree].prevFree = node.prevFree;
+
+        if (m_Heads[fl][sl] == Invalid)
+        {
+            m_SecondLevelMap[fl] &= ~(1u << sl);
+            if (!m_SecondLevelMap[fl])
+                m_FirstLevelMap &= ~(1u << fl);
+        }
+    }
+
+    std::uint32_t RangeAllocator::FindFree(std::uint32_t size) const
+    {
+        int fl, sl;
+        Mapping(size, fl, sl);
+        const int exactFirst = fl, exactSecond = sl;
+
+        // Round up to the next class boundary so any node of the class found is large enough
+        if (size >= static_cast<std::uint32_t>(SecondLevelCount))
+        {
+            const std::uint32_t round = (1u << (HighestBit(size) - SecondLevelBits)) - 1;
+            if (size <= 0xffffffffu - round)
+                Mapping(size + round, fl, sl);
+            else
+                fl = FirstLevelCount; // only the request's own class can hold it
+        }
+
+        std::uint32_t secondMap = fl < FirstLevelCount ? m_SecondLevelMap[fl] & (~0u << sl) : 0;
+        if (!secondMap)
+        {
+            const std::uint32_t firstMap = fl + 1 < FirstLevelCount ? m_FirstLevelMap & (~0u << (fl + 1)) : 0;
+            if (firstMap)
+            {
+                fl = LowestBit(firstMap);
+                secondMap = m_SecondLevelMap[fl];
+            }
+        }
+        if (secondMap)
+            return m_Heads[fl][LowestBit(secondMap)];
+
+        // Nothing in a larger class, a node of the request's own class may still fit
+        for (std::uint32_t index = m_Heads[exactFirst][exactSecond]; index != Invalid; index = m_Nodes[index].nextFree)
+            if (m_Nodes[index].size >= size)
+                return index;
+        return Invalid;
+    }
+
+    RangeAllocator::Allocation RangeAllocator::Allocate(std::uint32_t size)
+    {
+        size = std::max(size, 1u);
+        Allocation allocation = {0, FindFree(size)};
+        if (allocation.node == Invalid)
+            return allocation;
+
+        const std::uint32_t index = allocation.node;
+        RemoveFree(index);
+
+        // Return the tail to the free lists
+        if (m_Nodes[index].size > size)
+        {
+            const std::uint32_t rest = NewNode();
+            Node &node = m_Nodes[index], &tail = m_Nodes[rest];
+            tail.offset = node.offset + size;
+            tail.size = node.size - size;
+            tail.prevPhysical = index;
+            tail.nextPhysical = node.nextPhysical;
+            if (tail.nextPhysical != Invalid)
+                m_Nodes[tail.nextPhysical].prevPhysical = rest;
+            else
+                m_Last = rest;
+            node.nextPhysical = rest;
+            node.size = size;
+            InsertFree(rest);
+        }
+
+        Node &node = m_Nodes[index];
+        node.used = true;
+        m_Used += node.size;
+        m_Allocations++;
+        allocation.offset = node.offset;
+        return allocation;
+    }
+
+    void RangeAllocator::Free(std::uint32_t index)
+    {
+        Node &node = m_Nodes[index];
+        m_Used -= node.size;
+        m_Allocations--;
+
+        // Absorb free neighbours, their nodes go back to the pool
+        const std::uint32_t prev = node.prevPhysical;
+        if (prev != Invalid && !m_Nodes[prev].used)
+        {
+            RemoveFree(prev);
+            Node &before = m_Nodes[prev];
+            node.offset = before.offset;
+            node.size += before.size;
+            node.prevPhysical = before.prevPhysical;
+            if (node.prevPhysical != Invalid)
+                m_Nodes[node.prevPhysical].nextPhysical = index;
+            m_UnusedNodes.push_back(prev);
+        }
+        const std::uint32_t next = node.nextPhysical;
+        if (next != Invalid && !m_Nodes[next].used)
+        {
+            RemoveFree(next);
+            Node &after = m_Nodes[next];
+            node.size += after.size;
+            node.nextPhysical = after.nextPhysical;
+            if (node.nextPhysical != Invalid)
+                m_Nodes[node.nextPhysical].prevPhysical = index;
+            else
+                m_Last = index;
+            m_UnusedNodes.push_back(next);
+        }
+        InsertFree(index);
+    }
+
+    void RangeAllocator::Grow(std::uint32_t capacity)
+    {
+        if (capacity <= m_Capacity)
+            return;
+        const std::uint32_t extra = capacity - m_Capacity;
+        if (m_Last != Invalid && !m_Nodes[m_Last].used)
+        {
+            RemoveFree(m_Last);
+            m_Nodes[m_Last].size += extra;
+            InsertFree(m_Last);
+        }
+        else
+        {
+            const std::uint32_t index = NewNode();
+            Node &node = m_Nodes[index];
+            node.offset = m_Capacity;
+            node.size = extra;
+            node.prevPhysical = m_Last;
+            if (m_Last != Invalid)
+                m_Nodes[m_Last].nextPhysical = index;
+            m_Last = index;
+            InsertFree(index);
+        }
+        m_Capacity = capacity;
+    }
+
+    std::uint32_t RangeAllocator::GetLargestFree() const
+    {
+        if (!m_FirstLevelMap)
+            return 0;
+        // The highest class holds the largest node, its list isn't sorted
+        const int fl = HighestBit(m_FirstLevelMap);
+        const int sl = HighestBit(m_SecondLevelMap[fl]);
+        std::uint32_t largest = 0;
+        for (std::uint32_t index = m_Heads[fl][sl]; index != Invalid; index = m_Nodes[index].nextFree)
+            largest = std::max(largest, m_Nodes[index].size);
+        return largest;
+    }
+
+    float RangeAllocator::GetFragmentation() const
+    {
+        const std::uint32_t free = m_Capacity - m_Used;
+        return free ? 1.0f - static_cast<float>(GetLargestFree()) / free : 0.0f;
+    }
+};
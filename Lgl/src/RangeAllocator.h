@@ -0,0 +1,81 @@
+#pragma once
+
+// Standard Headers
+#include <cstdint>
+#include <vector>
+
+namespace Mirage
+{
+    /// Two level segregated fit (TLSF) allocator of ranges in an abstract address space
+    ///
+    /// Hands out [offset, offset + size) ranges of a capacity measured in any
+    /// unit, e.g. vertices or indices of a shared GPU buffer, without touching
+    /// the memory itself. Free ranges sit in lists by size class, a first level
+    /// per power of two split into 16 second level classes, and two bitmaps find
+    /// a class large enough in constant time. Freed ranges merge with free
+    /// neighbours right away, so fragmentation only comes from live ranges.
+    class RangeAllocator
+    {
+    public:
+        static const std::uint32_t Invalid = 0xffffffffu;
+
+        struct Allocation
+        {
+            std::uint32_t offset;
+            std::uint32_t node; // pass to Free(), Invalid when the allocation failed
+        };
+
+    private:
+        static const int SecondLevelBits = 4;
+        static const int SecondLevelCount = 1 << SecondLevelBits;
+        static const int FirstLevelCount = 32 - SecondLevelBits + 1;
+
+        struct Node
+        {
+            std::uint32_t offset;
+            std::uint32_t size;
+            std::uint32_t prevPhysical; // neighbours in address order
+            std::uint32_t nextPhysical;
+            std::uint32_t prevFree; // neighbours in the free list of the size class
+            std::uint32_t nextFree;
+            bool used;
+        };
+
+        std::vector<Node> m_Nodes;
+        std::vector<std::uint32_t> m_UnusedNodes; // recycled slots of m_Nodes
+        std::uint32_t m_FirstLevelMap;
+        std::uint32_t m_SecondLevelMap[FirstLevelCount];
+        std::uint32_t m_Heads[FirstLevelCount][SecondLevelCount];
+        std::uint32_t m_Capacity;
+        std::uint32_t m_Used;
+        std::uint32_t m_Last; // the node ending at the capacity
+        std::uint32_t m_Allocations;
+
+    public:
+        explicit RangeAllocator(std::uint32_t capacity);
+
+        /// @return The range, node is Invalid when no free range is large enough
+        Allocation Allocate(std::uint32_t size);
+        void Free(std::uint32_t node);
+        /// Extends the address space, the new space joins the last range when it is free
+        void Grow(std::uint32_t capacity);
+
+        inline std::uint32_t GetCapacity() const { return m_Capacity; }
+        inline std::uint32_t GetUsed() const { return m_Used; }
+        inline std::uint32_t GetAllocationCount() const { return m_Allocations; }
+        inline std::uint32_t GetSize(std::uint32_t node) const { return m_Nodes[node].size; }
+        inline std::uint32_t GetOffset(std::uint32_t node) const { return m_Nodes[node].offset; }
+        /// The largest range Allocate() can currently return
+        std::uint32_t GetLargestFree() const;
+        /// 0 when the free space is one range, towards 1 the more it is split up
+        float GetFragmentation() const;
+
+    private:
+        static void Mapping(std::uint32_t size, int &firstLevel, int &secondLevel);
+        std::uint32_t NewNode();
+        void InsertFree(std::uint32_t node);
+        void RemoveFree(std::uint32_t node);
+        /// Finds a free node of at least size, Invalid if there is none
+        std::uint32_t FindFree(std::uint32_t size) const;
+    };
+};
@@ -0,0 +1,149 @@
+#include "RenderQueue.h"
+#include "GLState.h"
+
+// Standard Headers
+#include <algorithm>
+#include <cstring>
+
+namespace Mirage
+{
+    static const int RadixBits = 8;
+    static const int RadixSize = 1 << RadixBits;
+    static const int RadixPasses = 64 / RadixBits;
+
+    static const int LayerBits = 4;
+    static const int ProgramBits = 10;
+    static const int MaterialBits = 12;
+    static const int TextureBits = 14;
+    static const int DepthBits = 24;
+    static const int TextureShift = DepthBits;
+    static const int MaterialShift = TextureShift + TextureBits;
+    static const int ProgramShift = MaterialShift + MaterialBits;
+    static const int LayerShift = ProgramShift + ProgramBits;
+
+    static inline std::uint64_t Field(unsigned int value, int bits, int shift)
+    {
+        return (static_cast<std::uint64_t>(value) & ((1ull << bits) - 1)) << shift;
+    }
+
+    RenderQueue::RenderQueue()
+    {
+        std::memset(&m_Stats, 0, sizeof(m_Stats));
+    }
+
+    std::uint64_t RenderQueue::MakeKey(unsigned int layer, unsigned int program, unsigned int material,
+                                       unsigned int texture, float depth, bool backToFront)
+    {
+        const std::uint32_t maxDepth = (1u << DepthBits) - 1;
+        std::uint32_t quantized = static_cast<std::uint32_t>(std::min(std::max(depth, 0.0f), 1.0f) * maxDepth);
+        if (backToFront)
+            quantized = maxDepth - quantized;
+
+        return Field(layer, LayerBits, LayerShift) | Field(program, ProgramBits, ProgramShift) |
+               Field(material, MaterialBits, MaterialShift) | Field(texture, TextureBits, TextureShift) |
+               Field(quantized, DepthBits, 0);
+    }
+
+    void RenderQueue::Submit(std::uint64_t key, DrawCommand const &command)
+    {
+        Entry entry = {key, static_cast<std::uint32_t>(m_Commands.size())};
+        m_Entries.push_back(entry);
+        m_Commands.push_back(command);
+    }
+
+    void RenderQueue::Sort()
+    {
+        m_Stats.submitted = CountSwitches();
+        const std::size_t count = m_Entries.size();
+        if (count < 2)
+            return;
+
+        // One read builds the histograms of every pass
+        std::size_t histograms[RadixPasses][RadixSize];
+        std::memset(histograms, 0, sizeof(histograms));
+        for (Entry const &entry : m_Entries)
+            for (int pass = 0; pass < RadixPasses; pass++)
+                histograms[pass][(entry.key >> (pass * RadixBits)) & (RadixSize - 1)]++;
+
+        m_Scratch.resize(count);
+        Entry *source = m_Entries.data(), *target = m_Scratch.data();
+        for (int pass = 0; pass < RadixPasses; pass++)
+        {
+            const int shift = pass * RadixBits;
+            std::size_t *histogram = histograms[pass];
+            // Every key has the same digit, the pass would only copy
+            if (histogram[(source[0].key >> shift) & (RadixSize - 1)] == count)
+                continue;
+
+            std::size_t offset = 0;
+            for (int digit = 0; digit < RadixSize; digit++)
+            {
+                const std::size_t size = histogram[digit];
+                histogram[digit] = offset;
+                offset += size;
+            }
+            for (std::size_t i = 0; i < count; i++)
+                target[histogram[(source[i].key >> shift) & (RadixSize - 1)]++] = source[i];
+            std::swap(source, target);
+        }
+        if (source != m_Entries.data())
+            m_Entries.swap(m_Scratch);
+    }
+
+    void RenderQueue::Dispatch()
+    {
+        m_Stats.commands = static_cast<unsigned int>(m_Commands.size());
+        m_Stats.dispatched = CountSwitches();
+
+        Shader *program = nullptr;
+        for (Entry const &entry : m_Entries)
+        {
+            DrawCommand const &command = m_Commands[entry.command];
+            if (command.program != program)
+            {
+                program = command.program;
+                program->activate();
+            }
+            program->bind("model", command.model);
+            for (int unit = 0; unit < DrawCommand::MaxTextures; unit++)
+                if (command.textures[unit])
+                    GLState::BindTextureUnit(unit, GL_TEXTURE_2D, command.textures[unit]);
+            GLState::BindVertexArray(command.vertexArray);
+
+            if (command.indexed)
+                glDrawElements(command.mode, command.count, GL_UNSIGNED_INT,
+                               reinterpret_cast<const void *>(static_cast<std::size_t>(command.first) * sizeof(GLuint)));
+            else
+                glDrawArrays(command.mode, command.first, command.count);
+        }
+    }
+
+    void RenderQueue::Clear()
+    {
+        m_Commands.clear();
+        m_Entries.clear();
+    }
+
+    RenderQueue::Switches RenderQueue::CountSwitches() const
+    {
+        Switches switches = {0, 0, 0};
+        const DrawCommand *previous = nullptr;
+        GLuint bound[DrawCommand::MaxTextures] = {};
+        for (Entry const &entry : m_Entries)
+        {
+            DrawCommand const &command = m_Commands[entry.command];
+            if (!previous || command.program != previous->program)
+                switches.programs++;
+            if (!previous || command.vertexArray != previous->vertexArray)
+                switches.vertexArrays++;
+            for (int unit = 0; unit < DrawCommand::MaxTextures; unit++)
+                if (command.textures[unit] && command.textures[unit] != bound[unit])
+                {
+                    bound[unit] = command.textures[unit];
+                    switches.textures++;
+                }
+            previous = &command;
+        }
+        return switches;
+    }
+};
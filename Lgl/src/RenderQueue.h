@@ -0,0 +1,98 @@
+#pragma once
+
+#include "shader.h"
+// GLAD
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstdint>
+#include <vector>
+
+namespace Mirage
+{
+    /// Everything a draw needs, resolved when it is dispatched
+    struct DrawCommand
+    {
+        static const int MaxTextures = 4;
+
+        Shader *program;
+        GLuint vertexArray;
+        GLuint textures[MaxTextures]; // GL_TEXTURE_2D per unit, 0 leaves the unit alone
+        GLenum mode;
+        bool indexed;   // glDrawElements with 32 bit indices from the VAO's index buffer
+        GLint first;    // first vertex, or first index when indexed
+        GLsizei count;
+        glm::mat4 model; // uploaded to the program's "model" uniform
+    };
+
+    /// Collects a frame's draws and dispatches them sorted by a 64 bit key
+    ///
+    /// Submissions are a key plus a command. Sort() orders them with an LSD
+    /// radix sort over the keys, skipping the byte passes every key agrees on,
+    /// and Dispatch() walks the result binding through GLState, so draws that
+    /// share a program, textures or VAO sit next to each other and switch as
+    /// little as possible. Equal keys keep their submission order. Dispatch()
+    /// without Sort() draws in submission order, for comparisons.
+    ///
+    /// Key layout, most significant first:
+    ///   layer 4 bits | program 10 | material 12 | texture 14 | depth 24
+    class RenderQueue
+    {
+    public:
+        struct Switches
+        {
+            unsigned int programs;
+            unsigned int vertexArrays;
+            unsigned int textures; // unit bindings that changed
+        };
+
+        struct Stats
+        {
+            unsigned int commands;
+            Switches submitted;  // in submission order, counted by Sort()
+            Switches dispatched; // in the order Dispatch() drew
+        };
+
+    private:
+        struct Entry
+        {
+            std::uint64_t key;
+            std::uint32_t command;
+        };
+
+        std::vector<DrawCommand> m_Commands;
+        std::vector<Entry> m_Entries;
+        std::vector<Entry> m_Scratch; // the other half of the radix sort's ping-pong
+        Stats m_Stats;
+
+    public:
+        RenderQueue();
+
+        RenderQueue(RenderQueue const &) = delete;
+        RenderQueue &operator=(RenderQueue const &) = delete;
+
+        /// Builds a sort key, every field is masked to its width
+        ///
+        /// @param layer Coarse order, e.g. opaque before translucent
+        /// @param program Small id of the program, e.g. its GL name
+        /// @param material Id of the material or mesh, what else groups draws
+        /// @param texture Id of the first texture
+        /// @param depth View depth normalised to [0, 1]
+        /// @param backToFront Orders by decreasing depth, for blended draws
+        static std::uint64_t MakeKey(unsigned int layer, unsigned int program, unsigned int material,
+                                     unsigned int texture, float depth, bool backToFront = false);
+
+        void Submit(std::uint64_t key, DrawCommand const &command);
+        void Sort();
+        void Dispatch();
+        /// Drops the commands, the memory is kept for the next frame
+        void Clear();
+
+        inline std::size_t GetCount() const { return m_Commands.size(); }
+        inline Stats const &GetStats() const { return m_Stats; }
+
+    private:
+        Switches CountSwitches() const;
+    };
+};
@@ -0,0 +1,82 @@
+#include "SamplerCache.h"
+#include "GLCaps.h"
+#include "GLState.h"
+#include "Hash.h"
+
+// Standard Headers
+#include <algorithm>
+
+namespace Mirage
+{
+    SamplerState SamplerState::Trilinear(float anisotropy)
+    {
+        SamplerState state = {GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_REPEAT, GL_REPEAT, anisotropy};
+        return state;
+    }
+
+    SamplerState SamplerState::Clamped()
+    {
+        SamplerState state = {GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, 1.0f};
+        return state;
+    }
+
+    bool SamplerState::operator==(SamplerState const &other) const
+    {
+        return minFilter == other.minFilter && magFilter == other.magFilter && wrapS == other.wrapS &&
+               wrapT == other.wrapT && anisotropy == other.anisotropy;
+    }
+
+    std::size_t SamplerCache::Hasher::operator()(SamplerState const &state) const
+    {
+        std::uint64_t hash = fnv1a64(&state.minFilter, sizeof(state.minFilter));
+        hash = fnv1a64(&state.magFilter, sizeof(state.magFilter), hash);
+        hash = fnv1a64(&state.wrapS, sizeof(state.wrapS), hash);
+        hash = fnv1a64(&state.wrapT, sizeof(state.wrapT), hash);
+        hash = fnv1a64(&state.anisotropy, sizeof(state.anisotropy), hash);
+        return static_cast<std::size_t>(hash);
+    }
+
+    SamplerCache::SamplerCache() : m_Requests(0)
+    {
+    }
+
+    SamplerCache::~SamplerCache()
+    {
+        for (auto const &entry : m_Samplers)
+            GLState::DeleteSamplers(1, &entry.second);
+    }
+
+    GLuint SamplerCache::Get(SamplerState const &state)
+    {
+        m_Requests++;
+
+        // Clamp first so requests beyond the driver limit share the clamped sampler
+        SamplerState key = state;
+        key.anisotropy = std::max(1.0f, std::min(key.anisotropy, GetMaxAnisotropy()));
+        auto found = m_Samplers.find(key);
+        if (found != m_Samplers.end())
+            return found->second;
+
+        GLuint sampler;
+        glGenSamplers(1, &sampler);
+        glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, key.minFilter);
+        glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, key.magFilter);
+        glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, key.wrapS);
+        glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, key.wrapT);
+        if (key.anisotropy > 1.0f)
+            glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY, key.anisotropy);
+        m_Samplers.emplace(key, sampler);
+        return sampler;
+    }
+
+    void SamplerCache::Bind(int slotID, SamplerState const &state)
+    {
+        GLState::BindSampler(slotID, Get(state));
+    }
+
+    float SamplerCache::GetMaxAnisotropy()
+    {
+        // Queried once with the other caps, Get() runs on the bind path
+        return GLCaps::Get().maxAnisotropy;
+    }
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+// GLAD
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstddef>
+#include <unordered_map>
+
+#ifndef GL_TEXTURE_MAX_ANISOTROPY
+#define GL_TEXTURE_MAX_ANISOTROPY 0x84FE
+#endif
+
+namespace Mirage
+{
+    /// Filtering and addressing of texture lookups, independent of any texture
+    struct SamplerState
+    {
+        GLenum minFilter;
+        GLenum magFilter;
+        GLenum wrapS;
+        GLenum wrapT;
+        float anisotropy; // 1 disables anisotropic filtering
+
+        /// Trilinear filtering with repeat addressing, what textures used to set on themselves
+        static SamplerState Trilinear(float anisotropy = 1.0f);
+        /// Bilinear filtering of level 0 only, clamped to the edges
+        static SamplerState Clamped();
+
+        bool operator==(SamplerState const &other) const;
+    };
+
+    /// Hash-conses GL sampler objects so equal states share one object
+    ///
+    /// Samplers bound to a unit override the parameters of whatever texture is
+    /// bound there, so switching the filtering of a whole scene means binding
+    /// a different sampler rather than touching every texture.
+    class SamplerCache
+    {
+    private:
+        struct Hasher
+        {
+            std::size_t operator()(SamplerState const &state) const;
+        };
+
+        std::unordered_map<SamplerState, GLuint, Hasher> m_Samplers;
+        unsigned int m_Requests;
+
+    public:
+        SamplerCache();
+        ~SamplerCache();
+
+        SamplerCache(SamplerCache const &) = delete;
+        SamplerCache &operator=(SamplerCache const &) = delete;
+
+        /// Returns the sampler object for a state, creating it on first use. The
+        /// anisotropy is clamped to what the driver supports.
+        GLuint Get(SamplerState const &state);
+
+        /// Binds the sampler for a state to a texture unit
+        void Bind(int slotID, SamplerState const &state);
+
+        /// Number of distinct sampler objects
+        inline std::size_t GetCount() const { return m_Samplers.size(); }
+        /// Number of Get() calls, compare with GetCount() for the deduplication rate
+        inline unsigned int GetRequests() const { return m_Requests; }
+
+        /// Largest anisotropy the driver supports, 1 without anisotropic filtering
+        static float GetMaxAnisotropy();
+    };
+};
@@ -0,0 +1,203 @@
+#include "ScratchArena.h"
+
+// Standard Headers
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace Mirage
+{
+    /// Precedes every block so frees and reallocs find their owner, 16 bytes keeps
+    /// the payload aligned for SIMD loads
+    struct alignas(16) BlockHeader
+    {
+        std::size_t size;
+        ScratchArena *arena; // null for heap blocks
+    };
+
+    static inline std::size_t RoundUp(std::size_t size)
+    {
+        return (size + 15) & ~static_cast<std::size_t>(15);
+    }
+
+    static inline BlockHeader *HeaderOf(void *ptr)
+    {
+        return static_cast<BlockHeader *>(ptr) - 1;
+    }
+
+    std::atomic<std::size_t> ScratchArena::s_TotalCapacity(0);
+
+    ScratchArena::ScratchArena(std::size_t initialSize)
+        : m_Last(nullptr), m_Used(0), m_HighWaterMark(0)
+    {
+        Chunk chunk = {static_cast<unsigned char *>(malloc(initialSize)), initialSize, 0};
+        m_Chunks.push_back(chunk);
+        s_TotalCapacity += initialSize;
+    }
+
+    ScratchArena::~ScratchArena()
+    {
+        for (auto const &chunk : m_Chunks)
+        {
+            free(chunk.data);
+            s_TotalCapacity -= chunk.size;
+        }
+    }
+
+    void *ScratchArena::Allocate(std::size_t size)
+    {
+        const std::size_t needed = sizeof(BlockHeader) + RoundUp(size);
+        if (m_Chunks.back().used + needed > m_Chunks.back().size)
+        {
+            const std::size_t chunkSize = std::max(needed, m_Chunks.back().size * 2);
+            Chunk chunk = {static_cast<unsigned char *>(malloc(chunkSize)), chunkSize, 0};
+            if (!chunk.data)
+                return nullptr;
+            m_Chunks.push_back(chunk);
+            s_TotalCapacity += chunkSize;
+        }
+
+        Chunk &chunk = m_Chunks.back();
+        BlockHeader *header = reinterpret_cast<BlockHeader *>(chunk.data + chunk.used);
+        header->size = size;
+        header->arena = this;
+        chunk.used += needed;
+        m_Used += needed;
+        m_HighWaterMark = std::max(m_HighWaterMark, m_Used);
+        m_Last = header + 1;
+        return m_Last;
+    }
+
+    void *ScratchArena::Reallocate(void *ptr, std::size_t size)
+    {
+        if (!ptr)
+            return Allocate(size);
+
+        // The newest block grows in place while its chunk has room
+        BlockHeader *header = HeaderOf(ptr);
+        Chunk &chunk = m_Chunks.back();
+        if (ptr == m_Last)
+        {
+            const std::size_t oldSize = RoundUp(header->size), newSize = RoundUp(size);
+            if (chunk.used - oldSize + newSize <= chunk.size)
+            {
+                chunk.used = chunk.used - oldSize + newSize;
+                m_Used = m_Used - oldSize + newSize;
+                m_HighWaterMark = std::max(m_HighWaterMark, m_Used);
+                header->size = size;
+                return ptr;
+            }
+        }
+
+        void *moved = Allocate(size);
+        if (moved)
+        {
+            memcpy(moved, ptr, std::min(size, header->size));
+            Free(ptr);
+        }
+        return moved;
+    }
+
+    void ScratchArena::Free(void *ptr)
+    {
+        // Only the newest block can be handed back, the rest waits for Reset()
+        if (!ptr || ptr != m_Last)
+            return;
+        BlockHeader *header = HeaderOf(ptr);
+        Chunk &chunk = m_Chunks.back();
+        const std::size_t size = sizeof(BlockHeader) + RoundUp(header->size);
+        chunk.used -= size;
+        m_Used -= size;
+        m_Last = nullptr;
+    }
+
+    void ScratchArena::Reset()
+    {
+        if (m_Chunks.size() > 1)
+        {
+            std::size_t total = GetCapacity();
+            for (auto const &chunk : m_Chunks)
+            {
+                free(chunk.data);
+                s_TotalCapacity -= chunk.size;
+            }
+            m_Chunks.clear();
+            Chunk chunk = {static_cast<unsigned char *>(malloc(total)), total, 0};
+            m_Chunks.push_back(chunk);
+            s_TotalCapacity += total;
+        }
+        m_Chunks.back().used = 0;
+        m_Used = 0;
+        m_Last = nullptr;
+    }
+
+    std::size_t ScratchArena::GetCapacity() const
+    {
+        std::size_t capacity = 0;
+        for (auto const &chunk : m_Chunks)
+            capacity += chunk.size;
+        return capacity;
+    }
+
+    ScratchArena &ScratchArena::ThreadLocal()
+    {
+        static thread_local ScratchArena arena;
+        return arena;
+    }
+
+    ScratchArena *&ScratchArena::Current()
+    {
+        static thread_local ScratchArena *current = nullptr;
+        return current;
+    }
+
+    ScratchArena::Scope::Scope(ScratchArena &arena) : m_Previous(Current())
+    {
+        Current() = &arena;
+    }
+
+    ScratchArena::Scope::~Scope()
+    {
+        Current() = m_Previous;
+    }
+
+    void *ScratchArena::Malloc(std::size_t size)
+    {
+        if (Current())
+            return Current()->Allocate(size);
+
+        BlockHeader *header = static_cast<BlockHeader *>(malloc(sizeof(BlockHeader) + size));
+        if (!header)
+            return nullptr;
+        header->size = size;
+        header->arena = nullptr;
+        return header + 1;
+    }
+
+    void *ScratchArena::Realloc(void *ptr, std::size_t size)
+    {
+        if (!ptr)
+            return Malloc(size);
+
+        BlockHeader *header = HeaderOf(ptr);
+        if (header->arena)
+            return header->arena->Reallocate(ptr, size);
+
+        header = static_cast<BlockHeader *>(realloc(header, sizeof(BlockHeader) + size));
+        if (!header)
+            return nullptr;
+        header->size = size;
+        return header + 1;
+    }
+
+    void ScratchArena::Release(void *ptr)
+    {
+        if (!ptr)
+            return;
+        BlockHeader *header = HeaderOf(ptr);
+        if (header->arena)
+            header->arena->Free(ptr);
+        else
+            free(header);
+    }
+};
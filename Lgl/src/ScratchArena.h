@@ -0,0 +1,82 @@
+#pragma once
+
+// Standard Headers
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace Mirage
+{
+    /// Bump allocator for short lived decode buffers
+    ///
+    /// Allocations are carved out of large chunks and released all at once by
+    /// Reset(), which keeps the memory for the next use. stb_image is routed
+    /// here through the Malloc/Realloc/Release hooks: while a Scope binds an
+    /// arena to the calling thread every stb allocation lands in that arena.
+    class ScratchArena
+    {
+    private:
+        struct Chunk
+        {
+            unsigned char *data;
+            std::size_t size;
+            std::size_t used;
+        };
+
+        std::vector<Chunk> m_Chunks;
+        void *m_Last; // most recent allocation, the only one that can grow or be freed in place
+        std::size_t m_Used;
+        std::size_t m_HighWaterMark;
+
+        static std::atomic<std::size_t> s_TotalCapacity;
+
+    public:
+        /// @param initialSize The size of the first chunk, more chunks are added on demand
+        explicit ScratchArena(std::size_t initialSize = 1 << 20);
+        ~ScratchArena();
+
+        ScratchArena(ScratchArena const &) = delete;
+        ScratchArena &operator=(ScratchArena const &) = delete;
+
+        void *Allocate(std::size_t size);
+        void *Reallocate(void *ptr, std::size_t size);
+        void Free(void *ptr);
+
+        /// Releases every allocation, chunks are merged into one so the next cycle
+        /// fits without growing
+        void Reset();
+
+        inline std::size_t GetUsed() const { return m_Used; }
+        inline std::size_t GetHighWaterMark() const { return m_HighWaterMark; }
+        std::size_t GetCapacity() const;
+
+        /// Bytes reserved by all arenas together
+        static inline std::size_t GetTotalCapacity() { return s_TotalCapacity; }
+
+        /// The arena of the calling thread, for decodes that don't bring their own
+        static ScratchArena &ThreadLocal();
+
+        /// Binds an arena to the calling thread for its lifetime
+        class Scope
+        {
+        private:
+            ScratchArena *m_Previous;
+
+        public:
+            explicit Scope(ScratchArena &arena);
+            ~Scope();
+
+            Scope(Scope const &) = delete;
+            Scope &operator=(Scope const &) = delete;
+        };
+
+        // Allocation hooks for STBI_MALLOC/STBI_REALLOC/STBI_FREE, they fall back
+        // to the heap when no arena is bound and free into whichever owns the block
+        static void *Malloc(std::size_t size);
+        static void *Realloc(void *ptr, std::size_t size);
+        static void Release(void *ptr);
+
+    private:
+        static ScratchArena *&Current();
+    };
+};
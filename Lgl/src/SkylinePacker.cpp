@@ -0,0 +1,105 @@
+#include "SkylinePacker.h"
+
+// Standard Headers
+#include <algorithm>
+
+namespace Mirage
+{
+    SkylinePacker::SkylinePacker(int width, int height)
+        : m_Width(width), m_Height(height), m_UsedArea(0)
+    {
+        Clear();
+    }
+
+    void SkylinePacker::Clear()
+    {
+        Node floor = {0, 0, m_Width};
+        m_Skyline.assign(1, floor);
+        m_UsedArea = 0;
+    }
+
+    bool SkylinePacker::Pack(int width, int height, Rect &rect)
+    {
+        if (width <= 0 || height <= 0)
+            return false;
+
+        // Lowest resting height wins, ties go to the narrower remaining segment
+        int bestY = m_Height, bestWidth = m_Width + 1;
+        std::size_t bestIndex = m_Skyline.size();
+        for (std::size_t i = 0; i < m_Skyline.size(); i++)
+        {
+            int y = Fit(i, width, height);
+            if (y < 0)
+                continue;
+            if (y < bestY || (y == bestY && m_Skyline[i].width < bestWidth))
+            {
+                bestY = y;
+                bestWidth = m_Skyline[i].width;
+                bestIndex = i;
+            }
+        }
+        if (bestIndex == m_Skyline.size())
+            return false;
+
+        rect.x = m_Skyline[bestIndex].x;
+        rect.y = bestY;
+        rect.width = width;
+        rect.height = height;
+        Insert(bestIndex, rect);
+        m_UsedArea += static_cast<std::size_t>(width) * height;
+        return true;
+    }
+
+    int SkylinePacker::Fit(std::size_t index, int width, int height) const
+    {
+        if (m_Skyline[index].x + width > m_Width)
+            return -1;
+
+        // The rectangle rests on the highest node it spans
+        int y = 0;
+        for (int remaining = width; remaining > 0; index++)
+        {
+            y = std::max(y, m_Skyline[index].y);
+            if (y + height > m_Height)
+                return -1;
+            remaining -= m_Skyline[index].width;
+        }
+        return y;
+    }
+
+    void SkylinePacker::Insert(std::size_t index, Rect const &rect)
+    {
+        Node top = {rect.x, rect.y + rect.height, rect.width};
+        m_Skyline.insert(m_Skyline.begin() + index, top);
+
+        // Trim or drop the nodes now hidden under the new one
+        const int right = rect.x + rect.width;
+        for (std::size_t i = index + 1; i < m_Skyline.size();)
+        {
+            Node &node = m_Skyline[i];
+            if (node.x >= right)
+                break;
+            const int overlap = right - node.x;
+            if (node.width <= overlap)
+                m_Skyline.erase(m_Skyline.begin() + i);
+            else
+            {
+                node.x += overlap;
+                node.width -= overlap;
+                break;
+            }
+        }
+
+        // Merge neighbours at the same height
+        for (std::size_t i = 0; i + 1 < m_Skyline.size();)
+        {
+            if (m_Skyline[i].y == m_Skyline[i + 1].y)
+            {
+                m_Skyline[i].width += m_Skyline[i + 1].width;
+                m_Skyline.erase(m_Skyline.begin() + i + 1);
+            }
+            else
+                i++;
+        }
+    }
+};
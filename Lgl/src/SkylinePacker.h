@@ -0,0 +1,62 @@
+#pragma once
+
+// Standard Headers
+#include <cstddef>
+#include <vector>
+
+namespace Mirage
+{
+    /// Packs rectangles into a fixed area with the skyline bottom-left heuristic
+    ///
+    /// The packed area is tracked as the top edge of the placed rectangles, each
+    /// new rectangle goes where it ends lowest (then leftmost). Space under an
+    /// overhang is lost, which keeps packing O(n) per rectangle.
+    class SkylinePacker
+    {
+    public:
+        struct Rect
+        {
+            int x;
+            int y;
+            int width;
+            int height;
+        };
+
+    private:
+        struct Node
+        {
+            int x;
+            int y;
+            int width;
+        };
+
+        std::vector<Node> m_Skyline;
+        int m_Width;
+        int m_Height;
+        std::size_t m_UsedArea;
+
+    public:
+        SkylinePacker(int width, int height);
+
+        /// Finds room for a rectangle and reserves it
+        ///
+        /// @param width The width to reserve
+        /// @param height The height to reserve
+        /// @param rect Receives the placement
+        /// @return false when the rectangle doesn't fit anywhere
+        bool Pack(int width, int height, Rect &rect);
+
+        /// Forgets every placement
+        void Clear();
+
+        /// Fraction of the area covered by packed rectangles
+        inline float GetOccupancy() const { return static_cast<float>(m_UsedArea) / (static_cast<float>(m_Width) * m_Height); }
+        inline int GetWidth() const { return m_Width; }
+        inline int GetHeight() const { return m_Height; }
+
+    private:
+        /// Height a rectangle placed at a skyline node would rest at, -1 if it doesn't fit
+        int Fit(std::size_t index, int width, int height) const;
+        void Insert(std::size_t index, Rect const &rect);
+    };
+};
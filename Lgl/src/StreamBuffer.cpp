@@ -0,0 +1,146 @@
+#include "StreamBuffer.h"
+#include "GLCaps.h"
+#include "GLState.h"
+#include "Timer.h"
+
+// Standard Headers
+#include <cassert>
+#include <cstring>
+#include <iostream>
+
+namespace Mirage
+{
+    StreamBuffer::StreamBuffer(GLenum target, std::size_t regionSize, unsigned int regions)
+        : m_Target(target), m_Mapped(nullptr), m_RegionSize(regionSize), m_RegionCount(regions), m_Region(0),
+          m_Head(0), m_Flushed(0), m_Fences(regions, nullptr)
+    {
+        // Set up through the copy target, binding GL_ELEMENT_ARRAY_BUFFER would change the bound VAO
+        const std::size_t size = m_RegionSize * m_RegionCount;
+        glGenBuffers(1, &m_RendererID);
+        GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+        if (GLCaps::Get().bufferStorage)
+        {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+            m_Mapped = static_cast<unsigned char *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+            if (!m_Mapped)
+            {
+                // Immutable storage can't be respecified, start over with a buffer the shadow path can fill
+                std::cout << "Failed to map stream buffer, falling back to glBufferSubData" << std::endl;
+                GLState::DeleteBuffers(1, &m_RendererID);
+                glGenBuffers(1, &m_RendererID);
+                GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+            }
+        }
+        if (!m_Mapped)
+        {
+            glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+            m_Shadow.resize(m_RegionSize);
+        }
+        GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        ResetStats();
+    }
+
+    StreamBuffer::~StreamBuffer()
+    {
+        for (GLsync fence : m_Fences)
+            if (fence)
+                glDeleteSync(fence);
+        if (m_Mapped)
+        {
+            GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+        GLState::DeleteBuffers(1, &m_RendererID);
+    }
+
+    void StreamBuffer::ResetStats()
+    {
+        m_Stats.bytes = 0;
+        m_Stats.frames = 0;
+        m_Stats.stalls = 0;
+        m_Stats.overflows = 0;
+        m_Stats.stallMs = 0.0;
+    }
+
+    StreamBuffer::Allocation StreamBuffer::Allocate(std::size_t size, std::size_t alignment)
+    {
+        // Offsets are aligned in the whole buffer, so a vertex offset divides by the stride
+        assert(alignment > 0);
+        const std::size_t base = RegionBase();
+        const std::size_t offset = (base + m_Head + alignment - 1) / alignment * alignment;
+        if (offset + size > base + m_RegionSize)
+        {
+            m_Stats.overflows++;
+            Allocation full = {nullptr, 0};
+            return full;
+        }
+
+        m_Head = offset + size - base;
+        m_Stats.bytes += size;
+        Allocation allocation = {m_Mapped ? m_Mapped + offset : &m_Shadow[offset - base], offset};
+        return allocation;
+    }
+
+    std::ptrdiff_t StreamBuffer::Write(const void *data, std::size_t size, std::size_t alignment)
+    {
+        Allocation allocation = Allocate(size, alignment);
+        if (!allocation.data)
+            return -1;
+        memcpy(allocation.data, data, size);
+        return static_cast<std::ptrdiff_t>(allocation.offset);
+    }
+
+    void StreamBuffer::Flush()
+    {
+        // Coherent mappings are visible to commands issued after the write
+        if (m_Mapped || m_Flushed == m_Head)
+            return;
+        GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, RegionBase() + m_Flushed, m_Head - m_Flushed, &m_Shadow[m_Flushed]);
+        GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        m_Flushed = m_Head;
+    }
+
+    void StreamBuffer::EndFrame()
+    {
+        Flush();
+        m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_Region = (m_Region + 1) % m_RegionCount;
+        m_Head = 0;
+        m_Flushed = 0;
+        m_Stats.frames++;
+
+        // The next region was last written regions - 1 frames ago
+        GLsync &fence = m_Fences[m_Region];
+        if (!fence)
+            return;
+        GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+        {
+            Stopwatch watch;
+            while (status == GL_TIMEOUT_EXPIRED)
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            m_Stats.stalls++;
+            m_Stats.stallMs += watch.ElapsedMs();
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    void StreamBuffer::Bind() const
+    {
+        GLState::BindBuffer(m_Target, m_RendererID);
+    }
+
+    void StreamBuffer::Unbind() const
+    {
+        GLState::BindBuffer(m_Target, 0);
+    }
+
+    void StreamBuffer::BindRange(GLuint index, std::size_t offset, std::size_t size) const
+    {
+        GLState::BindBufferRange(m_Target, index, m_RendererID, offset, size);
+    }
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+// GLAD
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstddef>
+#include <vector>
+
+namespace Mirage
+{
+    /// Per-frame vertex, index or uniform data written straight into mapped memory
+    ///
+    /// The buffer is split into regions, three by default, and each frame writes
+    /// into the next one while the GPU still reads the ones before it. Storage
+    /// is allocated with glBufferStorage and mapped once, persistent and
+    /// coherent, so a write is a plain memcpy. A fence marks the end of every
+    /// frame and a region is only reused after its fence signalled. Contexts
+    /// without buffer storage fall back to a client side copy of the region that
+    /// Flush() hands to glBufferSubData, so call it before drawing from new writes.
+    class StreamBuffer
+    {
+    public:
+        struct Allocation
+        {
+            void *data;         // where to write, null when the region is full
+            std::size_t offset; // byte offset of data in the buffer, for attribute pointers and BindRange()
+        };
+
+        struct Stats
+        {
+            std::size_t bytes;      // bytes allocated
+            unsigned int frames;    // EndFrame() calls
+            unsigned int stalls;    // frames that waited for the GPU to release a region
+            unsigned int overflows; // allocations that didn't fit the region
+            double stallMs;         // time spent in those waits
+        };
+
+    private:
+        GLenum m_Target;
+        GLuint m_RendererID;
+        unsigned char *m_Mapped;
+        std::vector<unsigned char> m_Shadow; // the current region when the buffer can't be mapped persistently
+        std::size_t m_RegionSize;
+        unsigned int m_RegionCount;
+        unsigned int m_Region;
+        std::size_t m_Head;    // first free byte of the current region
+        std::size_t m_Flushed; // bytes of the current region already handed to the driver
+        std::vector<GLsync> m_Fences;
+        Stats m_Stats;
+
+    public:
+        /// @param target The binding point the buffer is used on, e.g. GL_ARRAY_BUFFER or GL_UNIFORM_BUFFER
+        /// @param regionSize The bytes one frame may write
+        /// @param regions The number of frames in flight
+        StreamBuffer(GLenum target, std::size_t regionSize, unsigned int regions = 3);
+        ~StreamBuffer();
+
+        StreamBuffer(StreamBuffer const &) = delete;
+        StreamBuffer &operator=(StreamBuffer const &) = delete;
+
+        /// Reserves space in the current region
+        ///
+        /// @param size The bytes to reserve
+        /// @param alignment The offset is a multiple of this, must be non-zero, the vertex stride for
+        ///                  vertex data or GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT for uniforms
+        Allocation Allocate(std::size_t size, std::size_t alignment = 16);
+
+        /// Copies data into the current region, returns its offset or -1 when it doesn't fit
+        std::ptrdiff_t Write(const void *data, std::size_t size, std::size_t alignment = 16);
+
+        /// Makes the writes since the last call visible to draws, a no-op when persistent
+        void Flush();
+
+        /// Fences the frame's commands and moves to the next region, waiting for the
+        /// GPU if it still reads it. Call after the frame's last draw reading the buffer.
+        void EndFrame();
+
+        void Bind() const;
+        void Unbind() const;
+        /// Binds part of the buffer to an indexed uniform or shader storage binding
+        void BindRange(GLuint index, std::size_t offset, std::size_t size) const;
+
+        /// True when writes go straight to persistently mapped memory
+        inline bool IsPersistent() const { return m_Mapped != nullptr; }
+        inline GLuint GetRendererID() const { return m_RendererID; }
+        inline std::size_t GetRegionSize() const { return m_RegionSize; }
+        inline Stats const &GetStats() const { return m_Stats; }
+        void ResetStats();
+
+    private:
+        inline std::size_t RegionBase() const { return m_Region * m_RegionSize; }
+    };
+};
@@ -0,0 +1,311 @@
+#include "Tests.h"
+#include "GLState.h"
+#include "IndexBuffer.h"
+#include "PixelUploadRing.h"
+#include "shader.h"
+#include "Texture2D.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+
+// GLAD
+#include <glad/glad.h>
+
+// Standard Headers
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace Mirage
+{
+    namespace Test
+    {
+        /// Names of one kind of object handed out by GL and not deleted yet
+        struct ObjectLog
+        {
+            std::set<GLuint> live;
+            unsigned int created;
+            unsigned int deleted;
+            unsigned int doubleDeletes; // deletes of names that were already deleted or never created
+        };
+
+        static ObjectLog s_Buffers, s_Textures, s_VertexArrays, s_Programs;
+
+        static void Created(ObjectLog &log, GLsizei count, const GLuint *names)
+        {
+            for (GLsizei i = 0; i < count; i++)
+                log.live.insert(names[i]);
+            log.created += count;
+        }
+
+        static void Deleted(ObjectLog &log, GLsizei count, const GLuint *names)
+        {
+            // GL ignores 0, which is what moved-from wrappers delete
+            for (GLsizei i = 0; i < count; i++)
+                if (names[i] && log.live.erase(names[i]))
+                    log.deleted++;
+                else if (names[i])
+                    log.doubleDeletes++;
+        }
+
+        // The loaded entry points, the recording ones below forward to them
+        static PFNGLGENBUFFERSPROC s_GenBuffers;
+        static PFNGLCREATEBUFFERSPROC s_CreateBuffers;
+        static PFNGLDELETEBUFFERSPROC s_DeleteBuffers;
+        static PFNGLGENTEXTURESPROC s_GenTextures;
+        static PFNGLCREATETEXTURESPROC s_CreateTextures;
+        static PFNGLDELETETEXTURESPROC s_DeleteTextures;
+        static PFNGLGENVERTEXARRAYSPROC s_GenVertexArrays;
+        static PFNGLCREATEVERTEXARRAYSPROC s_CreateVertexArrays;
+        static PFNGLDELETEVERTEXARRAYSPROC s_DeleteVertexArrays;
+        static PFNGLCREATEPROGRAMPROC s_CreateProgram;
+        static PFNGLDELETEPROGRAMPROC s_DeleteProgram;
+
+        static void APIENTRY GenBuffers(GLsizei n, GLuint *buffers)
+        {
+            s_GenBuffers(n, buffers);
+            Created(s_Buffers, n, buffers);
+        }
+
+        static void APIENTRY CreateBuffers(GLsizei n, GLuint *buffers)
+        {
+            s_CreateBuffers(n, buffers);
+            Created(s_Buffers, n, buffers);
+        }
+
+        static void APIENTRY DeleteBuffers(GLsizei n, const GLuint *buffers)
+        {
+            Deleted(s_Buffers, n, buffers);
+            s_DeleteBuffers(n, buffers);
+        }
+
+        static void APIENTRY GenTextures(GLsizei n, GLuint *textures)
+        {
+            s_GenTextures(n, textures);
+            Created(s_Textures, n, textures);
+        }
+
+        static void APIENTRY CreateTextures(GLenum target, GLsizei n, GLuint *textures)
+        {
+            s_CreateTextures(target, n, textures);
+            Created(s_Textures, n, textures);
+        }
+
+        static void APIENTRY DeleteTextures(GLsizei n, const GLuint *textures)
+        {
+            Deleted(s_Textures, n, textures);
+            s_DeleteTextures(n, textures);
+        }
+
+        static void APIENTRY GenVertexArrays(GLsizei n, GLuint *arrays)
+        {
+            s_GenVertexArrays(n, arrays);
+            Created(s_VertexArrays, n, arrays);
+        }
+
+        static void APIENTRY CreateVertexArrays(GLsizei n, GLuint *arrays)
+        {
+            s_CreateVertexArrays(n, arrays);
+            Created(s_VertexArrays, n, arrays);
+        }
+
+        static void APIENTRY DeleteVertexArrays(GLsizei n, const GLuint *arrays)
+        {
+            Deleted(s_VertexArrays, n, arrays);
+            s_DeleteVertexArrays(n, arrays);
+        }
+
+        static GLuint APIENTRY CreateProgram()
+        {
+            const GLuint program = s_CreateProgram();
+            Created(s_Programs, 1, &program);
+            return program;
+        }
+
+        static void APIENTRY DeleteProgram(GLuint program)
+        {
+            Deleted(s_Programs, 1, &program);
+            s_DeleteProgram(program);
+        }
+
+        /// Routes the glGen*, glCreate* and glDelete* entry points glad loaded through the
+        /// recording functions while in scope, the wrappers call GL as usual
+        class ObjectRecorder
+        {
+        public:
+            ObjectRecorder()
+            {
+                Swap();
+            }
+
+            ~ObjectRecorder()
+            {
+                Swap();
+            }
+
+        private:
+            template <typename Function>
+            static void Exchange(Function &loaded, Function &saved, Function recording)
+            {
+                // Entry points the context lacks stay null, the wrappers don't call them then
+                if (!loaded && !saved)
+                    return;
+                if (saved)
+                {
+                    loaded = saved;
+                    saved = nullptr;
+                }
+                else
+                {
+                    saved = loaded;
+                    loaded = recording;
+                }
+            }
+
+            static void Swap()
+            {
+                Exchange(glad_glGenBuffers, s_GenBuffers, &GenBuffers);
+                Exchange(glad_glCreateBuffers, s_CreateBuffers, &CreateBuffers);
+                Exchange(glad_glDeleteBuffers, s_DeleteBuffers, &DeleteBuffers);
+                Exchange(glad_glGenTextures, s_GenTextures, &GenTextures);
+                Exchange(glad_glCreateTextures, s_CreateTextures, &CreateTextures);
+                Exchange(glad_glDeleteTextures, s_DeleteTextures, &DeleteTextures);
+                Exchange(glad_glGenVertexArrays, s_GenVertexArrays, &GenVertexArrays);
+                Exchange(glad_glCreateVertexArrays, s_CreateVertexArrays, &CreateVertexArrays);
+                Exchange(glad_glDeleteVertexArrays, s_DeleteVertexArrays, &DeleteVertexArrays);
+                Exchange(glad_glCreateProgram, s_CreateProgram, &CreateProgram);
+                Exchange(glad_glDeleteProgram, s_DeleteProgram, &DeleteProgram);
+            }
+        };
+
+        /// Grows a vector of wrappers one element at a time, so every reallocation moves all of them,
+        /// then moves the last element over the first and clears the vector. Checks that moved-from
+        /// wrappers delete nothing, that move assignment deletes the overwritten name exactly once
+        /// and that nothing outlives the vector. Needs at least two objects for the moves.
+        template <typename Object, typename Factory>
+        static bool Grow(const char *name, ObjectLog &log, unsigned int count, Factory make)
+        {
+            assert(count >= 2);
+            log = ObjectLog();
+            bool passed = true;
+            {
+                std::vector<Object> objects;
+                for (unsigned int i = 0; i < count; i++)
+                    objects.push_back(make());
+                const std::size_t grown = log.live.size();
+                passed = passed && grown == count;
+
+                objects.front() = std::move(objects.back());
+                objects.pop_back();
+                passed = passed && log.live.size() == grown - 1;
+
+                Object moved(std::move(objects.front()));
+                passed = passed && log.live.size() == grown - 1;
+            }
+            passed = passed && log.live.empty() && log.doubleDeletes == 0 && log.created == log.deleted;
+
+            printf("\t%-14s created %5u, deleted %5u, leaked %5zu, double deletes %5u  %s\n", name, log.created,
+                   log.deleted, log.live.size(), log.doubleDeletes, passed ? "ok" : "FAILED");
+            return passed;
+        }
+
+        static int objects(int argc, char **argv)
+        {
+            // The move checks need a first and a last element that differ
+            const unsigned int count = argc > 0 ? static_cast<unsigned int>(std::max(atoi(argv[0]), 2)) : 100;
+            const float vertices[] = {-0.5f, -0.5f, 0.0f, 0.5f, -0.5f, 0.0f, 0.0f, 0.5f, 0.0f};
+            const unsigned int triangle[] = {0, 1, 2};
+            const unsigned char pixel[] = {255, 0, 255, 255};
+
+            printf("GL object names across vector growth and move assignment, %u objects\n", count);
+            ObjectRecorder recorder;
+            bool passed = true;
+            passed = Grow<VertexBuffer>("VertexBuffer", s_Buffers, count,
+                                        [&]() { return VertexBuffer(vertices, sizeof(vertices)); }) && passed;
+            passed = Grow<IndexBuffer>("IndexBuffer", s_Buffers, count,
+                                       [&]() { return IndexBuffer(triangle, 3); }) && passed;
+            passed = Grow<VertexArray>("VertexArray", s_VertexArrays, count,
+                                       []() { return VertexArray(); }) && passed;
+            // Uploading replaces the placeholder's storage, which deletes its first name
+            passed = Grow<Texture2D>("Texture2D", s_Textures, count, [&]() -> Texture2D {
+                         Texture2D texture(0);
+                         texture.Upload(pixel, 1, 1, 4);
+                         return texture;
+                     }) && passed;
+            passed = Grow<Shader>("Shader", s_Programs, count, []() { return Shader(); }) && passed;
+            return passed ? 0 : 1;
+        }
+
+        /// Uploads a small odd sized image of a channel count and reads level 0 back in the same
+        /// transfer format, a mismatch means GL read more or fewer bytes per texel than the image has
+        static bool RoundTrip(const char *path, int channels, PixelUploadRing *ring)
+        {
+            const int width = 5, height = 3;
+            std::vector<unsigned char> pixels(width * height * channels), read(pixels.size());
+            for (std::size_t i = 0; i < pixels.size(); i++)
+                pixels[i] = static_cast<unsigned char>(i * 37 + channels);
+
+            Texture2D texture(0);
+            if (ring)
+            {
+                texture.Allocate(width, height, channels);
+                ring->Upload(texture.getTexture(), 0, width, height, Texture2D::GetFormat(channels), channels,
+                             pixels.data());
+            }
+            else
+                texture.Upload(pixels.data(), width, height, channels);
+
+            const GLuint previous = GLState::GetTexture(GL_TEXTURE_2D);
+            GLState::BindTexture(GL_TEXTURE_2D, texture.getTexture());
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glGetTexImage(GL_TEXTURE_2D, 0, Texture2D::GetFormat(channels), GL_UNSIGNED_BYTE, read.data());
+            GLState::BindTexture(GL_TEXTURE_2D, previous);
+
+            const bool passed = read == pixels;
+            printf("	%-14s %d channels  %s\n", path, channels, passed ? "ok" : "FAILED");
+            return passed;
+        }
+
+        static int uploads(int, char **)
+        {
+            printf("texture uploads of 1 to 4 channel images read back from GL\n");
+            std::unique_ptr<PixelUploadRing> ring(PixelUploadRing::IsSupported() ? new PixelUploadRing() : nullptr);
+            bool passed = true;
+            for (int channels = 1; channels <= 4; channels++)
+            {
+                passed = RoundTrip("Upload()", channels, nullptr) && passed;
+                if (ring)
+                    passed = RoundTrip("upload ring", channels, ring.get()) && passed;
+            }
+            return passed ? 0 : 1;
+        }
+
+        struct SelfTest
+        {
+            const char *name;
+            int (*function)(int argc, char **argv);
+        };
+
+        static const SelfTest tests[] = {
+            {"--test-objects", objects},
+            {"--test-uploads", uploads},
+        };
+
+        int run(int argc, char **argv)
+        {
+            for (auto const &test : tests)
+                if (strcmp(argv[0], test.name) == 0)
+                    return test.function(argc - 1, argv + 1);
+
+            fprintf(stderr, "Unknown test: %s\nAvailable:\n", argv[0]);
+            for (auto const &test : tests)
+                fprintf(stderr, "\t%s\n", test.name);
+            return 1;
+        }
+    };
+};
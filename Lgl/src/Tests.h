@@ -0,0 +1,15 @@
+#pragma once
+
+namespace Mirage
+{
+    namespace Test
+    {
+        /// Runs the self test named on the command line (e.g. --test-objects)
+        /// against the current OpenGL context and prints its report
+        ///
+        /// @param argc The number of arguments after the program name
+        /// @param argv The arguments after the program name
+        /// @return The process exit code, 0 when every check passed
+        int run(int argc, char **argv);
+    };
+};
@@ -1,20 +1,126 @@
 #include "Texture2D.h"
+#include "CompressedFormats.h"
+#include "GLCaps.h"
+#include "GLState.h"
+#include "TextureContainer.h"
 
+#include <algorithm>
+#include <vector>
+
+// stb_image allocates through the scratch arena bound to the decoding thread
+#include "ScratchArena.h"
+#define STBI_MALLOC(size) Mirage::ScratchArena::Malloc(size)
+#define STBI_REALLOC(ptr, size) Mirage::ScratchArena::Realloc(ptr, size)
+#define STBI_FREE(ptr) Mirage::ScratchArena::Release(ptr)
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+static const unsigned char s_White[4] = {255, 255, 255, 255};
+
+std::size_t Texture2D::s_TotalMemoryUsage = 0;
+const GLint Texture2D::GreyAlphaSwizzle[4] = {GL_RED, GL_RED, GL_RED, GL_GREEN};
+
+/// Writes a rectangle of one level, by name with direct state access, otherwise bound to the active unit
+static void SubImage(GLuint texture, int level, int x, int y, int width, int height, GLenum format, GLenum type,
+                     const void *pixels)
+{
+#ifdef GL_VERSION_4_5
+    if (Mirage::GLCaps::Get().directStateAccess)
+    {
+        glTextureSubImage2D(texture, level, x, y, width, height, format, type, pixels);
+        return;
+    }
+#endif
+    Mirage::GLState::BindTexture(GL_TEXTURE_2D, texture);
+    glTexSubImage2D(GL_TEXTURE_2D, level, x, y, width, height, format, type, pixels);
+}
+
+static void CompressedSubImage(GLuint texture, int level, int width, int height, GLenum internalFormat,
+                               const void *blocks)
+{
+    const GLsizei size = static_cast<GLsizei>(Mirage::GetCompressedLevelSize(internalFormat, width, height));
+#ifdef GL_VERSION_4_5
+    if (Mirage::GLCaps::Get().directStateAccess)
+    {
+        glCompressedTextureSubImage2D(texture, level, 0, 0, width, height, internalFormat, size, blocks);
+        return;
+    }
+#endif
+    Mirage::GLState::BindTexture(GL_TEXTURE_2D, texture);
+    glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, internalFormat, size, blocks);
+}
+
+/// The texture bound to the active unit before the edits above, with direct state access they bind nothing
+static GLuint BeginEdit()
+{
+    return Mirage::GLCaps::Get().directStateAccess ? 0 : Mirage::GLState::GetTexture(GL_TEXTURE_2D);
+}
+
+/// Puts back what BeginEdit() found, so a unit sampling a texture still does after another is edited
+static void EndEdit(GLuint previous)
+{
+    if (!Mirage::GLCaps::Get().directStateAccess)
+        Mirage::GLState::BindTexture(GL_TEXTURE_2D, previous);
+}
+
 Texture2D::Texture2D(const char *path, int slotID)
-    : m_SlotID(slotID), m_FilePath(path)
+    : m_TID(0), m_SlotID(slotID), m_Levels(0), m_SRGB(false), m_MemoryUsage(0), m_FilePath(path)
 {
     m_TID = loadTexture();
 }
 
-Texture2D::~Texture2D() {}
+Texture2D::Texture2D(int slotID, std::string const &path)
+    : m_TID(0), m_SlotID(slotID), m_Levels(0), m_SRGB(false), m_MemoryUsage(0), m_FilePath(path)
+{
+    Upload(s_White, 1, 1, 4);
+}
+
+Texture2D::~Texture2D()
+{
+    s_TotalMemoryUsage -= m_MemoryUsage;
+    Mirage::GLState::DeleteTextures(1, &m_TID);
+}
+
+Texture2D::Texture2D(Texture2D &&other) noexcept
+    : m_TID(other.m_TID), m_SlotID(other.m_SlotID), m_Width(other.m_Width), m_Height(other.m_Height),
+      m_BPP(other.m_BPP), m_Levels(other.m_Levels), m_SRGB(other.m_SRGB), m_MemoryUsage(other.m_MemoryUsage),
+      m_FilePath(std::move(other.m_FilePath))
+{
+    other.m_TID = 0;
+    other.m_MemoryUsage = 0;
+}
+
+Texture2D &Texture2D::operator=(Texture2D &&other) noexcept
+{
+    if (this != &other)
+    {
+        s_TotalMemoryUsage -= m_MemoryUsage;
+        Mirage::GLState::DeleteTextures(1, &m_TID);
+        m_TID = other.m_TID;
+        m_SlotID = other.m_SlotID;
+        m_Width = other.m_Width;
+        m_Height = other.m_Height;
+        m_BPP = other.m_BPP;
+        m_Levels = other.m_Levels;
+        m_SRGB = other.m_SRGB;
+        m_MemoryUsage = other.m_MemoryUsage;
+        m_FilePath = std::move(other.m_FilePath);
+        other.m_TID = 0;
+        other.m_MemoryUsage = 0;
+    }
+    return *this;
+}
 
 GLuint Texture2D::loadTexture()
 {
+    if (Mirage::TextureContainer::IsContainerPath(m_FilePath))
+        return loadContainer();
+
+    // Decode buffers live in this thread's arena and are recycled once uploaded
+    Mirage::ScratchArena &arena = Mirage::ScratchArena::ThreadLocal();
+    Mirage::ScratchArena::Scope scope(arena);
     stbi_set_flip_vertically_on_load(true);
-    unsigned char *image = stbi_load(m_FilePath, &m_Width, &m_Height, &m_BPP, 0);
+    unsigned char *image = stbi_load(m_FilePath.c_str(), &m_Width, &m_Height, &m_BPP, 0);
     if (!image)
         std::cout << "Failed to load texture : " << m_FilePath << std::endl;
     else
@@ -25,41 +131,237 @@ GLuint Texture2D::loadTexture()
         std::cout << "\tBits per pixel : " << m_BPP << std::endl;
     }
 
-    GLint imageFormat;
-    switch (m_BPP)
+    // A failed load keeps a white placeholder so the storage is still valid
+    if (image)
     {
-    case 1:
-        imageFormat = GL_RED;
-        break;
-    case 3:
-        imageFormat = GL_RGB;
-        break;
-    case 4:
-        imageFormat = GL_RGBA;
-        break;
+        Upload(image, m_Width, m_Height, m_BPP);
+        std::cout << "\tVideo memory : " << m_MemoryUsage << " bytes in " << m_Levels << " levels" << std::endl;
+    }
+    else
+        Upload(s_White, 1, 1, 4);
+
+    stbi_image_free(image);
+    arena.Reset();
+    return m_TID;
+}
+
+GLuint Texture2D::loadContainer()
+{
+    Mirage::TextureContainer container;
+    if (container.Open(m_FilePath))
+        Upload(container);
+    else
+    {
+        std::cout << "Failed to load texture : " << m_FilePath << std::endl;
+        Upload(s_White, 1, 1, 4);
+    }
+    return m_TID;
+}
+
+void Texture2D::Upload(const unsigned char *pixels, int width, int height, int channels, const unsigned char *mips)
+{
+    Allocate(width, height, channels);
+    const GLuint previous = BeginEdit();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    SubImage(m_TID, 0, 0, 0, m_Width, m_Height, GetFormat(m_BPP), GL_UNSIGNED_BYTE, pixels);
+    for (int level = 1; mips && level < m_Levels; level++)
+    {
+        const int w = std::max(1, m_Width >> level), h = std::max(1, m_Height >> level);
+        SubImage(m_TID, level, 0, 0, w, h, GetFormat(m_BPP), GL_UNSIGNED_BYTE, mips);
+        mips += static_cast<std::size_t>(w) * h * m_BPP;
+    }
+    EndEdit(previous);
+    if (!mips)
+        GenerateMipmaps();
+}
+
+void Texture2D::Upload(Mirage::TextureContainer const &container)
+{
+    const Mirage::Ltx::Header &header = container.GetHeader();
+    m_BPP = header.channels;
+    if (Mirage::IsCompressedFormat(header.internalFormat))
+    {
+        std::vector<const unsigned char *> levels;
+        for (std::uint32_t level = 0; level < header.levels; level++)
+            levels.push_back(container.GetLevelData(level));
+        UploadCompressed(header.internalFormat, header.width, header.height, header.levels, levels.data());
+        return;
+    }
+
+    AllocateStorage(header.width, header.height, header.levels, header.internalFormat);
+    const GLuint previous = BeginEdit();
+
+    // Levels are already in upload layout, hand the mapping to the driver as is
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int level = 0; level < m_Levels; level++)
+    {
+        const Mirage::Ltx::Level &info = container.GetLevel(level);
+        SubImage(m_TID, level, 0, 0, info.width, info.height, header.format, header.type, container.GetLevelData(level));
+    }
+    EndEdit(previous);
+}
+
+void Texture2D::UploadCompressed(GLenum internalFormat, int width, int height, int levels,
+                                 const unsigned char *const *data)
+{
+    if (!Mirage::GLCaps::IsFormatSupported(internalFormat))
+    {
+        std::cout << "Compressed format 0x" << std::hex << internalFormat << std::dec
+                  << " is not supported by this driver" << std::endl;
+        Upload(s_White, 1, 1, 4);
+        return;
+    }
+
+    AllocateStorage(width, height, levels, internalFormat);
+    const GLuint previous = BeginEdit();
+    for (int level = 0; level < m_Levels; level++)
+        CompressedSubImage(m_TID, level, std::max(1, width >> level), std::max(1, height >> level), internalFormat,
+                           data[level]);
+    EndEdit(previous);
+}
+
+void Texture2D::Allocate(int width, int height, int channels)
+{
+    m_BPP = channels;
+    AllocateStorage(width, height, GetLevelCount(width, height), GetInternalFormat(m_BPP, m_SRGB));
+}
+
+void Texture2D::UploadRegion(int x, int y, int width, int height, int channels, const unsigned char *pixels)
+{
+    const GLuint previous = BeginEdit();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    SubImage(m_TID, 0, x, y, width, height, GetFormat(channels), GL_UNSIGNED_BYTE, pixels);
+    EndEdit(previous);
+}
+
+void Texture2D::AllocateStorage(int width, int height, int levels, GLenum internalFormat)
+{
+    m_Width = width;
+    m_Height = height;
+    m_Levels = levels;
+
+    // A unit sampling the old storage samples the new one afterwards
+    const GLuint replaced = m_TID;
+    const GLuint previous = BeginEdit();
+    if (m_TID)
+    {
+        s_TotalMemoryUsage -= m_MemoryUsage;
+        Mirage::GLState::DeleteTextures(1, &m_TID);
     }
 
-    GLuint texture;
     // glEnable(GL_TEXTURE_2D);
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, imageFormat, m_Width, m_Height, 0, imageFormat, GL_UNSIGNED_BYTE, image);
+    // Filtering and wrapping come from the sampler bound to the unit, see SamplerCache
+#ifdef GL_VERSION_4_5
+    if (Mirage::GLCaps::Get().directStateAccess)
+    {
+        glCreateTextures(GL_TEXTURE_2D, 1, &m_TID);
+        glTextureStorage2D(m_TID, m_Levels, internalFormat, m_Width, m_Height);
+        if (internalFormat == GL_RG8)
+            glTextureParameteriv(m_TID, GL_TEXTURE_SWIZZLE_RGBA, GreyAlphaSwizzle);
+    }
+    else
+#endif
+    {
+        glGenTextures(1, &m_TID);
+        Mirage::GLState::BindTexture(GL_TEXTURE_2D, m_TID);
+        glTexStorage2D(GL_TEXTURE_2D, m_Levels, internalFormat, m_Width, m_Height);
+        if (internalFormat == GL_RG8)
+            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, GreyAlphaSwizzle);
+    }
+    EndEdit(replaced && previous == replaced ? m_TID : previous);
+
+    m_MemoryUsage = 0;
+    for (int level = 0; level < m_Levels; level++)
+        m_MemoryUsage += GetLevelSize(internalFormat, std::max(1, m_Width >> level), std::max(1, m_Height >> level));
+    s_TotalMemoryUsage += m_MemoryUsage;
+}
+
+void Texture2D::GenerateMipmaps()
+{
+#ifdef GL_VERSION_4_5
+    if (Mirage::GLCaps::Get().directStateAccess)
+    {
+        glGenerateTextureMipmap(m_TID);
+        return;
+    }
+#endif
+    const GLuint previous = BeginEdit();
+    Mirage::GLState::BindTexture(GL_TEXTURE_2D, m_TID);
     glGenerateMipmap(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    EndEdit(previous);
+}
+
+GLenum Texture2D::GetFormat(int channels)
+{
+    switch (channels)
+    {
+    case 1:
+        return GL_RED;
+    case 2:
+        return GL_RG;
+    case 3:
+        return GL_RGB;
+    default:
+        return GL_RGBA;
+    }
+}
+
+GLenum Texture2D::GetInternalFormat(int channels, bool srgb)
+{
+    switch (channels)
+    {
+    case 1:
+        return GL_R8;
+    case 2:
+        return GL_RG8;
+    case 3:
+        return srgb ? GL_SRGB8 : GL_RGB8;
+    default:
+        return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    }
+}
+
+std::size_t Texture2D::GetLevelSize(GLenum internalFormat, int width, int height)
+{
+    if (Mirage::IsCompressedFormat(internalFormat))
+        return Mirage::GetCompressedLevelSize(internalFormat, width, height);
+
+    std::size_t texels = static_cast<std::size_t>(width) * height;
+    switch (internalFormat)
+    {
+    case GL_R8:
+        return texels;
+    case GL_RG8:
+        return texels * 2;
+    // GPUs pad 24 bit texels to 32 bits, count RGB8 at the size it actually occupies
+    case GL_RGB8:
+    case GL_SRGB8:
+    case GL_RGBA8:
+    case GL_SRGB8_ALPHA8:
+    default:
+        return texels * 4;
+    }
+}
 
-    return texture;
+int Texture2D::GetLevelCount(int width, int height)
+{
+    int levels = 1;
+    for (int size = std::max(width, height); size > 1; size >>= 1)
+        levels++;
+    return levels;
 }
+
 void Texture2D::Bind()
 {
-    glActiveTexture(GL_TEXTURE0 + m_SlotID);
-    glBindTexture(GL_TEXTURE_2D, m_TID);
+    Mirage::GLState::BindTextureUnit(m_SlotID, GL_TEXTURE_2D, m_TID);
+}
+
+void Texture2D::Bind(int slotID)
+{
+    Mirage::GLState::BindTextureUnit(slotID, GL_TEXTURE_2D, m_TID);
 }
 
 void Texture2D::Unbind()
 {
-    glBindTexture(GL_TEXTURE_2D, 0);
+    Mirage::GLState::BindTexture(GL_TEXTURE_2D, 0);
 }
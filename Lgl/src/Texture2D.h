@@ -1,11 +1,17 @@
 #pragma once
 
+#include <cstddef>
 #include <iostream>
 #include <string>
 // GLAD
 #include <glad/glad.h>
 // #include "glassert.h"
 
+namespace Mirage
+{
+    class TextureContainer;
+};
+
 class Texture2D
 {
 public:
@@ -16,19 +22,91 @@ private:
     int m_Width;
     int m_Height;
     int m_BPP;
-    const char *m_FilePath;
+    int m_Levels;
+    bool m_SRGB;
+    std::size_t m_MemoryUsage;
+    std::string m_FilePath;
+
+    static std::size_t s_TotalMemoryUsage;
 
 public:
+    /// Loads an image through stb_image, or a cooked .ltx container with all its mips
     Texture2D(const char *path, int slotID = 0);
+    /// Creates a 1x1 white placeholder to be filled in later through Upload()
+    explicit Texture2D(int slotID, std::string const &path = "");
     ~Texture2D();
 
+    Texture2D(Texture2D const &) = delete;
+    Texture2D &operator=(Texture2D const &) = delete;
+    /// Moves hand the texture name and its memory accounting over, the source is left empty
+    Texture2D(Texture2D &&other) noexcept;
+    Texture2D &operator=(Texture2D &&other) noexcept;
+
     void Bind();
+    /// Binds to another slot, for textures shared between materials
+    void Bind(int slotID);
     void Unbind();
 
+    /// (Re)specifies the texture image from decoded pixels and builds its mipmaps
+    ///
+    /// @param pixels Tightly packed rows of 8 bit channels
+    /// @param width The width in pixels
+    /// @param height The height in pixels
+    /// @param channels The number of channels per pixel (1, 3 or 4)
+    /// @param mips Levels 1 to n packed one after another (see Mirage::MipGenerator), uploaded
+    ///             instead of calling glGenerateMipmap, null to let the driver build them
+    void Upload(const unsigned char *pixels, int width, int height, int channels, const unsigned char *mips = nullptr);
+
+    /// (Re)specifies the texture from a cooked container, every level is uploaded
+    /// straight from the mapping and no mipmaps are generated
+    void Upload(Mirage::TextureContainer const &container);
+
+    /// (Re)specifies the texture from pre-compressed blocks (BC1/BC3/BC7/ETC2, see
+    /// CompressedFormats.h), formats the driver lacks leave a white placeholder
+    ///
+    /// @param internalFormat The compressed internal format
+    /// @param width The width of level 0 in pixels
+    /// @param height The height of level 0 in pixels
+    /// @param levels The number of levels in data
+    /// @param data One pointer per level to its tightly packed blocks
+    void UploadCompressed(GLenum internalFormat, int width, int height, int levels, const unsigned char *const *data);
+
+    /// Allocates immutable storage with the full mip chain without filling it, the pixels
+    /// are expected to arrive through glTexSubImage2D (e.g. from a PixelUploadRing).
+    /// Immutable storage can't be resized, so reallocating replaces the texture name.
+    void Allocate(int width, int height, int channels);
+    /// Replaces a rectangle of level 0, call GenerateMipmaps() once every region is in
+    void UploadRegion(int x, int y, int width, int height, int channels, const unsigned char *pixels);
+    void GenerateMipmaps();
+
+    /// Selects GL_SRGB8/GL_SRGB8_ALPHA8 storage for colour data, takes effect on the next Allocate()
+    inline void SetSRGB(bool srgb) { m_SRGB = srgb; }
+
+    /// Maps a channel count to its pixel transfer format (GL_RED, GL_RG, GL_RGB or GL_RGBA), so GL reads
+    /// exactly channels bytes per texel
+    static GLenum GetFormat(int channels);
+    /// Maps a channel count to the sized internal format used for storage, sRGB only applies to 3 and 4
+    static GLenum GetInternalFormat(int channels, bool srgb);
+    /// GL_TEXTURE_SWIZZLE_RGBA of GL_RG8 storage, 2 channel images are grey and alpha
+    static const GLint GreyAlphaSwizzle[4];
+    /// Size of one level stored in the given internal format, in bytes
+    static std::size_t GetLevelSize(GLenum internalFormat, int width, int height);
+    /// Number of levels in a full mip chain down to 1x1
+    static int GetLevelCount(int width, int height);
+
+    /// Video memory of this texture including every mip level, in bytes
+    inline std::size_t GetMemoryUsage() const { return m_MemoryUsage; }
+    /// Video memory of all live textures, in bytes
+    static inline std::size_t GetTotalMemoryUsage() { return s_TotalMemoryUsage; }
+
     inline int getWidth() const { return m_Width; }
     inline int getHeight() const { return m_Height; }
+    inline int getLevels() const { return m_Levels; }
     inline GLuint getTexture() const { return m_TID; }
+    inline std::string const &getFilePath() const { return m_FilePath; }
 
 private:
     GLuint loadTexture();
+    GLuint loadContainer();
+    void AllocateStorage(int width, int height, int levels, GLenum internalFormat);
 };
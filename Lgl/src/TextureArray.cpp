@@ -0,0 +1,78 @@
+#include "TextureArray.h"
+#include "GLState.h"
+#include "Texture2D.h"
+
+// Standard Headers
+#include <algorithm>
+#include <iostream>
+
+namespace Mirage
+{
+    TextureArray::TextureArray(int width, int height, int layers, int channels, bool srgb)
+        : m_TID(0), m_Width(width), m_Height(height), m_Layers(std::min(layers, GetMaxLayers())), m_Count(0),
+          m_Levels(Texture2D::GetLevelCount(width, height)), m_InternalFormat(Texture2D::GetInternalFormat(channels, srgb)),
+          m_MemoryUsage(0)
+    {
+        if (m_Layers < layers)
+            std::cout << "Texture array limited to " << m_Layers << " of " << layers << " layers" << std::endl;
+
+        glGenTextures(1, &m_TID);
+        GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_TID);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, m_Levels, m_InternalFormat, m_Width, m_Height, m_Layers);
+        if (m_InternalFormat == GL_RG8)
+            glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, Texture2D::GreyAlphaSwizzle);
+        GLState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        for (int level = 0; level < m_Levels; level++)
+            m_MemoryUsage += Texture2D::GetLevelSize(m_InternalFormat, std::max(1, m_Width >> level), std::max(1, m_Height >> level));
+        m_MemoryUsage *= m_Layers;
+    }
+
+    TextureArray::~TextureArray()
+    {
+        GLState::DeleteTextures(1, &m_TID);
+    }
+
+    int TextureArray::Add(const unsigned char *pixels, int width, int height, int channels)
+    {
+        if (width != m_Width || height != m_Height)
+        {
+            std::cout << "Texture array layer is " << width << "x" << height << ", expected "
+                      << m_Width << "x" << m_Height << std::endl;
+            return -1;
+        }
+        if (m_Count == m_Layers)
+            return -1;
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_TID);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, m_Count, width, height, 1, Texture2D::GetFormat(channels),
+                        GL_UNSIGNED_BYTE, pixels);
+        GLState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        return m_Count++;
+    }
+
+    void TextureArray::GenerateMipmaps()
+    {
+        GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_TID);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        GLState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+
+    void TextureArray::Bind(int slotID)
+    {
+        GLState::BindTextureUnit(slotID, GL_TEXTURE_2D_ARRAY, m_TID);
+    }
+
+    void TextureArray::Unbind()
+    {
+        GLState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+
+    int TextureArray::GetMaxLayers()
+    {
+        GLint layers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &layers);
+        return layers;
+    }
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+// GLAD
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstddef>
+
+namespace Mirage
+{
+    /// Same-sized images in the layers of one GL_TEXTURE_2D_ARRAY
+    ///
+    /// Objects textured from the same array only differ by their layer index,
+    /// so they can share a binding and be drawn together in one call.
+    class TextureArray
+    {
+    private:
+        GLuint m_TID;
+        int m_Width;
+        int m_Height;
+        int m_Layers;
+        int m_Count;
+        int m_Levels;
+        GLenum m_InternalFormat;
+        std::size_t m_MemoryUsage;
+
+    public:
+        /// Allocates immutable storage for every layer and its full mip chain
+        ///
+        /// @param width The width of every layer in pixels
+        /// @param height The height of every layer in pixels
+        /// @param layers The number of layers, at most GL_MAX_ARRAY_TEXTURE_LAYERS
+        /// @param channels The channel count used to pick the internal format
+        /// @param srgb Whether the layers hold sRGB encoded colour
+        TextureArray(int width, int height, int layers, int channels = 4, bool srgb = false);
+        ~TextureArray();
+
+        TextureArray(TextureArray const &) = delete;
+        TextureArray &operator=(TextureArray const &) = delete;
+
+        /// Copies an image into the next free layer
+        ///
+        /// @param pixels Tightly packed rows of 8 bit channels
+        /// @param width Must match the array width
+        /// @param height Must match the array height
+        /// @param channels The number of channels per pixel (1, 3 or 4)
+        /// @return The layer index, or -1 when the size differs or the array is full
+        int Add(const unsigned char *pixels, int width, int height, int channels);
+
+        /// Builds the mip chain of every layer, call once all layers are added
+        void GenerateMipmaps();
+
+        void Bind(int slotID);
+        void Unbind();
+
+        inline int getWidth() const { return m_Width; }
+        inline int getHeight() const { return m_Height; }
+        inline int getLayers() const { return m_Layers; }
+        inline int getCount() const { return m_Count; }
+        inline GLuint getTexture() const { return m_TID; }
+        /// Video memory of every layer including its mip levels, in bytes
+        inline std::size_t GetMemoryUsage() const { return m_MemoryUsage; }
+
+        /// The largest layer count the driver allows
+        static int GetMaxLayers();
+    };
+};
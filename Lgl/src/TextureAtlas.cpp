@@ -0,0 +1,60 @@
+#include "TextureAtlas.h"
+
+// Standard Headers
+#include <algorithm>
+
+namespace Mirage
+{
+    TextureAtlas::TextureAtlas(int width, int height, int padding, int slotID)
+        : m_Packer(width, height), m_Texture(new Texture2D(slotID)), m_Padding(padding)
+    {
+        m_Texture->Allocate(width, height, 4);
+    }
+
+    int TextureAtlas::Add(const unsigned char *pixels, int width, int height, int channels)
+    {
+        const int paddedWidth = width + 2 * m_Padding, paddedHeight = height + 2 * m_Padding;
+        SkylinePacker::Rect rect;
+        if (!m_Packer.Pack(paddedWidth, paddedHeight, rect))
+            return -1;
+
+        // Expand to RGBA and clamp the border reads so the edges are extruded
+        std::vector<unsigned char> padded(static_cast<std::size_t>(paddedWidth) * paddedHeight * 4);
+        for (int y = 0; y < paddedHeight; y++)
+        {
+            const int sy = std::min(std::max(y - m_Padding, 0), height - 1);
+            for (int x = 0; x < paddedWidth; x++)
+            {
+                const int sx = std::min(std::max(x - m_Padding, 0), width - 1);
+                const unsigned char *src = pixels + (static_cast<std::size_t>(sy) * width + sx) * channels;
+                unsigned char *dst = &padded[(static_cast<std::size_t>(y) * paddedWidth + x) * 4];
+                if (channels < 3)
+                {
+                    // Grey, optionally with alpha
+                    dst[0] = dst[1] = dst[2] = src[0];
+                    dst[3] = channels == 2 ? src[1] : 255;
+                }
+                else
+                {
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                    dst[2] = src[2];
+                    dst[3] = channels == 4 ? src[3] : 255;
+                }
+            }
+        }
+        m_Texture->UploadRegion(rect.x, rect.y, paddedWidth, paddedHeight, 4, padded.data());
+
+        const float atlasWidth = static_cast<float>(m_Texture->getWidth());
+        const float atlasHeight = static_cast<float>(m_Texture->getHeight());
+        Region region = {(rect.x + m_Padding) / atlasWidth, (rect.y + m_Padding) / atlasHeight,
+                         (rect.x + m_Padding + width) / atlasWidth, (rect.y + m_Padding + height) / atlasHeight};
+        m_Regions.push_back(region);
+        return static_cast<int>(m_Regions.size()) - 1;
+    }
+
+    void TextureAtlas::Finish()
+    {
+        m_Texture->GenerateMipmaps();
+    }
+};
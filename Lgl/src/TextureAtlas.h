@@ -0,0 +1,62 @@
+#pragma once
+
+#include "SkylinePacker.h"
+#include "Texture2D.h"
+
+// Standard Headers
+#include <memory>
+#include <vector>
+
+namespace Mirage
+{
+    /// Packs images of any size into one RGBA texture
+    ///
+    /// Each image is surrounded by a border of its own edge pixels so bilinear
+    /// filtering and the first few mip levels don't pick up the neighbours.
+    /// Regions are addressed by the UV rectangle returned from GetRegion().
+    class TextureAtlas
+    {
+    public:
+        /// Normalised texture coordinates of an image inside the atlas
+        struct Region
+        {
+            float u0;
+            float v0;
+            float u1;
+            float v1;
+        };
+
+    private:
+        SkylinePacker m_Packer;
+        std::unique_ptr<Texture2D> m_Texture;
+        std::vector<Region> m_Regions;
+        int m_Padding;
+
+    public:
+        /// @param width The atlas width in pixels
+        /// @param height The atlas height in pixels
+        /// @param padding Pixels of extruded border around every image
+        /// @param slotID The slot the atlas texture binds to
+        TextureAtlas(int width, int height, int padding = 2, int slotID = 0);
+
+        TextureAtlas(TextureAtlas const &) = delete;
+        TextureAtlas &operator=(TextureAtlas const &) = delete;
+
+        /// Packs an image and copies it into the atlas
+        ///
+        /// @param pixels Tightly packed rows of 8 bit channels
+        /// @param width The width in pixels
+        /// @param height The height in pixels
+        /// @param channels The number of channels per pixel (1 to 4)
+        /// @return The region index, or -1 when the atlas is full
+        int Add(const unsigned char *pixels, int width, int height, int channels);
+
+        /// Builds the mip chain, call once all images are added
+        void Finish();
+
+        inline Region const &GetRegion(int index) const { return m_Regions[index]; }
+        inline int GetRegionCount() const { return static_cast<int>(m_Regions.size()); }
+        inline float GetOccupancy() const { return m_Packer.GetOccupancy(); }
+        inline Texture2D &GetTexture() { return *m_Texture; }
+    };
+};
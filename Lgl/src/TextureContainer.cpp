@@ -0,0 +1,90 @@
+#include "TextureContainer.h"
+#include "CompressedFormats.h"
+#include "Texture2D.h"
+
+// Standard Headers
+#include <algorithm>
+#include <iostream>
+
+namespace Mirage
+{
+    // Largest edge a full mip chain of MaxLevels covers, also keeps the level sizes far from overflowing
+    static const std::uint32_t MaxSize = 1u << (Ltx::MaxLevels - 1);
+
+    /// Whether the transfer format and type are the ones Texture2D uses for the storage format,
+    /// block compressed levels are uploaded without either
+    static bool IsUploadable(Ltx::Header const &header)
+    {
+        if (IsCompressedFormat(header.internalFormat))
+            return header.format == 0 && header.type == 0;
+        const int channels = static_cast<int>(header.channels);
+        return header.type == GL_UNSIGNED_BYTE && header.format == Texture2D::GetFormat(channels) &&
+               (header.internalFormat == Texture2D::GetInternalFormat(channels, false) ||
+                header.internalFormat == Texture2D::GetInternalFormat(channels, true));
+    }
+
+    /// Bytes a level of the header's format must hold
+    static std::uint64_t GetExpectedLevelSize(Ltx::Header const &header, std::uint32_t width, std::uint32_t height)
+    {
+        if (IsCompressedFormat(header.internalFormat))
+            return GetCompressedLevelSize(header.internalFormat, static_cast<int>(width), static_cast<int>(height));
+        // Rows are tightly packed bytes
+        return static_cast<std::uint64_t>(width) * height * header.channels;
+    }
+
+    TextureContainer::TextureContainer() : m_Header(nullptr), m_Levels(nullptr) {}
+
+    bool TextureContainer::Open(std::string const &path)
+    {
+        m_Header = nullptr;
+        m_Levels = nullptr;
+        if (!m_File.Open(path))
+            return false;
+
+        const std::size_t size = m_File.GetSize();
+        const Ltx::Header *header = reinterpret_cast<const Ltx::Header *>(m_File.GetData());
+        if (size < sizeof(Ltx::Header) || header->magic != Ltx::Magic || header->version != Ltx::Version ||
+            header->levels == 0 || header->levels > Ltx::MaxLevels ||
+            size < sizeof(Ltx::Header) + header->levels * sizeof(Ltx::Level) ||
+            header->width == 0 || header->height == 0 || header->width > MaxSize || header->height > MaxSize ||
+            header->channels == 0 || header->channels > 4 || !IsUploadable(*header) ||
+            // More levels than the chain has would make glTexStorage2D fail and leave the texture empty
+            header->levels > static_cast<std::uint32_t>(Texture2D::GetLevelCount(header->width, header->height)))
+        {
+            std::cout << "Invalid texture container : " << path << std::endl;
+            m_File.Close();
+            return false;
+        }
+
+        const Ltx::Level *levels = reinterpret_cast<const Ltx::Level *>(header + 1);
+        for (std::uint32_t i = 0; i < header->levels; i++)
+        {
+            const Ltx::Level &level = levels[i];
+            if (level.offset > size || level.size > size - level.offset)
+            {
+                std::cout << "Truncated texture container : " << path << std::endl;
+                m_File.Close();
+                return false;
+            }
+
+            // The uploads trust the records, so they must describe exactly the chain the header implies
+            const std::uint32_t width = std::max(1u, header->width >> i), height = std::max(1u, header->height >> i);
+            const std::uint64_t expected = GetExpectedLevelSize(*header, width, height);
+            if (level.width != width || level.height != height || level.size != expected)
+            {
+                std::cout << "Invalid texture container level " << i << " : " << path << std::endl;
+                m_File.Close();
+                return false;
+            }
+        }
+
+        m_Header = header;
+        m_Levels = levels;
+        return true;
+    }
+
+    bool TextureContainer::IsContainerPath(std::string const &path)
+    {
+        return path.size() > 4 && path.compare(path.size() - 4, 4, ".ltx") == 0;
+    }
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "LtxFormat.h"
+#include "MappedFile.h"
+
+// Standard Headers
+#include <string>
+
+namespace Mirage
+{
+    /// A cooked .ltx texture mapped into memory, the level payloads are read
+    /// directly from the mapping
+    class TextureContainer
+    {
+    private:
+        MappedFile m_File;
+        const Ltx::Header *m_Header;
+        const Ltx::Level *m_Levels;
+
+    public:
+        TextureContainer();
+
+        TextureContainer(TextureContainer const &) = delete;
+        TextureContainer &operator=(TextureContainer const &) = delete;
+
+        /// Maps and validates a cooked texture
+        ///
+        /// @return false if the file is missing, truncated, of another version or its levels
+        ///         don't match the sizes the header's format and dimensions imply
+        bool Open(std::string const &path);
+
+        inline const Ltx::Header &GetHeader() const { return *m_Header; }
+        inline const Ltx::Level &GetLevel(int level) const { return m_Levels[level]; }
+        inline const unsigned char *GetLevelData(int level) const { return m_File.GetData() + m_Levels[level].offset; }
+
+        /// Checks for the .ltx extension
+        static bool IsContainerPath(std::string const &path);
+    };
+};
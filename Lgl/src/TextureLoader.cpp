@@ -0,0 +1,197 @@
+#include "TextureLoader.h"
+
+#include <stb_image.h>
+
+// Standard Headers
+#include <algorithm>
+#include <utility>
+
+namespace Mirage
+{
+    TextureLoader::TextureLoader(unsigned int threads)
+        : m_Pending(0), m_Stopping(false), m_CpuMips(true), m_Pool(threads)
+    {
+        // The flip flag is global in stb_image, set it once before any worker decodes
+        stbi_set_flip_vertically_on_load(true);
+        if (PixelUploadRing::IsSupported())
+            m_UploadRing.reset(new PixelUploadRing());
+
+        // One arena per worker plus one for the image being uploaded
+        for (unsigned int i = 0; i <= m_Pool.GetThreadCount(); i++)
+        {
+            m_Arenas.emplace_back(new ScratchArena());
+            m_FreeArenas.push_back(m_Arenas.back().get());
+        }
+    }
+
+    TextureLoader::~TextureLoader()
+    {
+        // Workers waiting for an arena give up, images never uploaded go with their arenas
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_ArenaReturned.notify_all();
+    }
+
+    void TextureLoader::SetMipGenerator(MipGenerator const *generator)
+    {
+        m_CpuMips = generator != nullptr;
+        if (generator)
+            m_MipGenerator = *generator;
+    }
+
+    std::shared_ptr<Texture2D> TextureLoader::Load(std::string const &path, int slotID)
+    {
+        std::shared_ptr<Texture2D> texture = std::make_shared<Texture2D>(slotID, path);
+        m_Pending++;
+        // Workers only see a weak reference, so the last owner of a texture is never a worker
+        // and ~Texture2D always runs on the GL thread
+        std::weak_ptr<Texture2D> target = texture;
+        m_Pool.Enqueue([this, target, path]()
+                       { Decode(target, path); });
+        return texture;
+    }
+
+    void TextureLoader::Decode(std::weak_ptr<Texture2D> const &texture, std::string const &path)
+    {
+        DecodedImage image = {texture, nullptr, nullptr, nullptr, nullptr, 0, 0, 0};
+        if (TextureContainer::IsContainerPath(path))
+        {
+            image.container = std::make_shared<TextureContainer>();
+            if (!image.container->Open(path))
+                image.container.reset();
+        }
+        else
+        {
+            image.arena = AcquireArena();
+            if (!image.arena)
+                return;
+            ScratchArena::Scope scope(*image.arena);
+            image.pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+            if (image.pixels && m_CpuMips && image.channels >= 3)
+                GenerateMips(image);
+        }
+        if (!image.pixels && !image.container)
+        {
+            std::cout << "Failed to load texture : " << path << std::endl;
+            ReleaseArena(image.arena);
+            image.arena = nullptr;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Ready.push_back(std::move(image));
+        }
+        m_Decoded.notify_one();
+    }
+
+    unsigned int TextureLoader::Update(std::size_t byteBudget)
+    {
+        unsigned int uploaded = 0;
+        std::size_t spent = 0;
+        while (uploaded == 0 || spent < byteBudget)
+        {
+            DecodedImage image;
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (m_Ready.empty())
+                    break;
+                image = std::move(m_Ready.front());
+                m_Ready.pop_front();
+            }
+            if (image.container)
+                spent += image.container->GetLevel(0).size;
+            else
+                spent += static_cast<std::size_t>(image.width) * image.height * image.channels +
+                         (image.mips ? MipGenerator::GetChainSize(image.width, image.height) : 0);
+            UploadImage(image);
+            uploaded++;
+        }
+        return uploaded;
+    }
+
+    void TextureLoader::Finish()
+    {
+        while (m_Pending > 0)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Decoded.wait(lock, [this]
+                               { return !m_Ready.empty(); });
+            }
+            Update(static_cast<std::size_t>(-1));
+        }
+    }
+
+    void TextureLoader::GenerateMips(DecodedImage &image)
+    {
+        const std::size_t pixels = static_cast<std::size_t>(image.width) * image.height;
+        if (image.channels == 3)
+        {
+            unsigned char *rgba = static_cast<unsigned char *>(ScratchArena::Malloc(pixels * 4));
+            MipGenerator::ExpandRGB(image.pixels, rgba, pixels, m_MipGenerator.GetSimd());
+            stbi_image_free(image.pixels);
+            image.pixels = rgba;
+            image.channels = 4;
+        }
+        image.mips = static_cast<unsigned char *>(ScratchArena::Malloc(MipGenerator::GetChainSize(image.width, image.height)));
+        m_MipGenerator.Generate(image.pixels, image.width, image.height, image.mips);
+    }
+
+    void TextureLoader::UploadImage(DecodedImage &image)
+    {
+        // Failed decodes keep their placeholder, textures dropped while decoding are skipped
+        std::shared_ptr<Texture2D> target = image.texture.lock();
+        if (target && image.container)
+            target->Upload(*image.container);
+        else if (target && image.pixels && m_UploadRing)
+        {
+            Texture2D &texture = *target;
+            texture.Allocate(image.width, image.height, image.channels);
+            m_UploadRing->Upload(texture.getTexture(), 0, image.width, image.height,
+                                 Texture2D::GetFormat(image.channels), image.channels, image.pixels);
+            if (image.mips)
+            {
+                // The chain is packed level after level, the same layout the texture expects
+                const unsigned char *level = image.mips;
+                for (int i = 1; i < texture.getLevels(); i++)
+                {
+                    const int w = std::max(1, image.width >> i), h = std::max(1, image.height >> i);
+                    m_UploadRing->Upload(texture.getTexture(), i, w, h, GL_RGBA, 4, level);
+                    level += static_cast<std::size_t>(w) * h * 4;
+                }
+            }
+            else
+                texture.GenerateMipmaps();
+        }
+        else if (target && image.pixels)
+            target->Upload(image.pixels, image.width, image.height, image.channels, image.mips);
+        stbi_image_free(image.pixels);
+        ReleaseArena(image.arena);
+        m_Pending--;
+    }
+
+    ScratchArena *TextureLoader::AcquireArena()
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_ArenaReturned.wait(lock, [this]
+                             { return m_Stopping || !m_FreeArenas.empty(); });
+        if (m_Stopping)
+            return nullptr;
+        ScratchArena *arena = m_FreeArenas.back();
+        m_FreeArenas.pop_back();
+        return arena;
+    }
+
+    void TextureLoader::ReleaseArena(ScratchArena *arena)
+    {
+        if (!arena)
+            return;
+        arena->Reset();
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_FreeArenas.push_back(arena);
+        }
+        m_ArenaReturned.notify_one();
+    }
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "MipGenerator.h"
+#include "PixelUploadRing.h"
+#include "ScratchArena.h"
+#include "TextureContainer.h"
+#include "Texture2D.h"
+#include "ThreadPool.h"
+
+// Standard Headers
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Mirage
+{
+    /// Decodes images on a pool of worker threads and uploads them on the GL thread
+    ///
+    /// Load() hands back a placeholder texture right away, Update() swaps the
+    /// decoded image into it once it is ready. Decodes run inside a pool of
+    /// scratch arenas, one image per arena until it is uploaded, so the memory
+    /// held by decoded images is bounded by the arena count however many
+    /// textures are queued.
+    class TextureLoader
+    {
+    private:
+        struct DecodedImage
+        {
+            // Weak so only the GL thread ever holds the texture, locked for the upload
+            std::weak_ptr<Texture2D> texture;
+            // Set for cooked .ltx files, which are mapped instead of decoded
+            std::shared_ptr<TextureContainer> container;
+            unsigned char *pixels;
+            unsigned char *mips;  // levels 1 to n from the MipGenerator, null to generate them on the GPU
+            ScratchArena *arena; // owns pixels and mips, recycled after the upload
+            int width;
+            int height;
+            int channels;
+        };
+
+        std::mutex m_Mutex;
+        std::condition_variable m_Decoded;
+        std::deque<DecodedImage> m_Ready;
+        std::atomic<unsigned int> m_Pending;
+        std::vector<std::unique_ptr<ScratchArena>> m_Arenas;
+        std::vector<ScratchArena *> m_FreeArenas;
+        std::condition_variable m_ArenaReturned;
+        bool m_Stopping;
+        MipGenerator m_MipGenerator;
+        bool m_CpuMips;
+        // Null when the context lacks buffer storage, uploads then go through Texture2D::Upload
+        std::unique_ptr<PixelUploadRing> m_UploadRing;
+        // Declared last so the workers are joined before the queues go away
+        ThreadPool m_Pool;
+
+    public:
+        /// @param threads The number of decode workers, 0 picks one per hardware thread
+        explicit TextureLoader(unsigned int threads = 0);
+        ~TextureLoader();
+
+        TextureLoader(TextureLoader const &) = delete;
+        TextureLoader &operator=(TextureLoader const &) = delete;
+
+        /// Queues an image for decoding and returns its placeholder texture
+        std::shared_ptr<Texture2D> Load(std::string const &path, int slotID = 0);
+
+        /// Uploads decoded images until the byte budget is spent, call once per frame
+        /// on the GL thread. At least one image is uploaded when any is ready.
+        ///
+        /// @return The number of textures uploaded
+        unsigned int Update(std::size_t byteBudget = 8 << 20);
+
+        /// Blocks until every queued image has been decoded and uploaded
+        void Finish();
+
+        /// Builds the mip chains of 3 and 4 channel images on the workers instead of through
+        /// glGenerateMipmap on the GL thread, RGB images are widened to RGBA for it. On by
+        /// default with a box filter, call before the first Load().
+        ///
+        /// @param generator The generator to copy, null leaves the mips to the GPU
+        void SetMipGenerator(MipGenerator const *generator);
+
+        inline unsigned int GetPending() const { return m_Pending; }
+        inline unsigned int GetThreadCount() const { return m_Pool.GetThreadCount(); }
+        inline PixelUploadRing *GetUploadRing() const { return m_UploadRing.get(); }
+
+    private:
+        /// Runs on a worker thread
+        void Decode(std::weak_ptr<Texture2D> const &texture, std::string const &path);
+        /// Runs on a worker thread inside the image's arena scope
+        void GenerateMips(DecodedImage &image);
+        void UploadImage(DecodedImage &image);
+        /// Blocks a worker until an arena is free, null once the loader is shutting down
+        ScratchArena *AcquireArena();
+        void ReleaseArena(ScratchArena *arena);
+    };
+};
@@ -0,0 +1,111 @@
+#include "TextureManager.h"
+
+// Standard Headers
+#include <vector>
+
+namespace Mirage
+{
+    TextureManager::TextureManager(std::size_t budget, TextureLoader *loader)
+        : m_Budget(budget), m_Loader(loader)
+    {
+        m_Stats.loads = 0;
+        m_Stats.hits = 0;
+        m_Stats.evictions = 0;
+    }
+
+    std::shared_ptr<Texture2D> TextureManager::Acquire(std::string const &path)
+    {
+        std::string key = Intern(path);
+        auto found = m_Entries.find(key);
+        if (found != m_Entries.end())
+        {
+            // Move to the front of the recency list
+            m_Recent.splice(m_Recent.begin(), m_Recent, found->second.recent);
+            m_Stats.hits++;
+            return found->second.texture;
+        }
+
+        std::shared_ptr<Texture2D> texture;
+        if (m_Loader)
+            texture = m_Loader->Load(key);
+        else
+            texture = std::make_shared<Texture2D>(key.c_str());
+        m_Recent.push_front(key);
+        Entry entry = {texture, m_Recent.begin()};
+        m_Entries.emplace(key, entry);
+        m_Stats.loads++;
+
+        Collect();
+        return texture;
+    }
+
+    std::size_t TextureManager::Collect()
+    {
+        return Evict(m_Budget);
+    }
+
+    std::size_t TextureManager::Purge()
+    {
+        return Evict(0);
+    }
+
+    std::size_t TextureManager::GetMemoryUsage() const
+    {
+        // Summed on demand, asynchronous loads grow from their placeholder size
+        std::size_t usage = 0;
+        for (auto const &entry : m_Entries)
+            usage += entry.second.texture->GetMemoryUsage();
+        return usage;
+    }
+
+    std::size_t TextureManager::Evict(std::size_t target)
+    {
+        std::size_t usage = GetMemoryUsage(), released = 0;
+        for (auto it = m_Recent.end(); it != m_Recent.begin() && usage > target;)
+        {
+            --it;
+            auto entry = m_Entries.find(*it);
+            // The manager's own reference is the only one left when nothing uses it
+            if (entry->second.texture.use_count() > 1)
+                continue;
+
+            std::size_t size = entry->second.texture->GetMemoryUsage();
+            usage -= size;
+            released += size;
+            m_Entries.erase(entry);
+            it = m_Recent.erase(it);
+            m_Stats.evictions++;
+        }
+        return released;
+    }
+
+    std::string TextureManager::Intern(std::string const &path)
+    {
+        std::string normalised = path;
+        for (auto &c : normalised)
+            if (c == '\\')
+                c = '/';
+
+        // Drop "." components and fold "dir/.." pairs
+        std::vector<std::string> parts;
+        std::size_t start = 0;
+        const bool absolute = !normalised.empty() && normalised[0] == '/';
+        while (start <= normalised.size())
+        {
+            std::size_t end = normalised.find('/', start);
+            if (end == std::string::npos)
+                end = normalised.size();
+            std::string part = normalised.substr(start, end - start);
+            if (part == ".." && !parts.empty() && parts.back() != "..")
+                parts.pop_back();
+            else if (!part.empty() && part != ".")
+                parts.push_back(part);
+            start = end + 1;
+        }
+
+        std::string result = absolute ? "/" : "";
+        for (std::size_t i = 0; i < parts.size(); i++)
+            result += (i ? "/" : "") + parts[i];
+        return result;
+    }
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Texture2D.h"
+#include "TextureLoader.h"
+
+// Standard Headers
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace Mirage
+{
+    /// Interns texture paths so every file is loaded once and shared
+    ///
+    /// Acquire() hands out shared handles; a texture is referenced while any
+    /// handle outside the manager is alive. Unreferenced textures stay resident
+    /// for reuse until the video memory of all cached textures exceeds the
+    /// budget, then the least recently acquired ones are evicted first.
+    class TextureManager
+    {
+    public:
+        struct Stats
+        {
+            unsigned int loads;     // files loaded
+            unsigned int hits;      // acquires served from the cache
+            unsigned int evictions; // textures dropped to meet the budget
+        };
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<Texture2D> texture;
+            std::list<std::string>::iterator recent;
+        };
+
+        std::unordered_map<std::string, Entry> m_Entries;
+        std::list<std::string> m_Recent; // most recently acquired first
+        std::size_t m_Budget;
+        TextureLoader *m_Loader;
+        Stats m_Stats;
+
+    public:
+        /// @param budget The video memory cached textures may use, in bytes
+        /// @param loader Loads asynchronously when set, synchronously otherwise
+        explicit TextureManager(std::size_t budget = 256 << 20, TextureLoader *loader = nullptr);
+
+        TextureManager(TextureManager const &) = delete;
+        TextureManager &operator=(TextureManager const &) = delete;
+
+        /// Returns the texture for a path, loading it on first use
+        std::shared_ptr<Texture2D> Acquire(std::string const &path);
+
+        /// Evicts unreferenced textures, least recently acquired first, until the
+        /// cache fits the budget
+        ///
+        /// @return The bytes of video memory released
+        std::size_t Collect();
+
+        /// Evicts every unreferenced texture regardless of the budget
+        std::size_t Purge();
+
+        inline void SetBudget(std::size_t budget) { m_Budget = budget; }
+        inline std::size_t GetBudget() const { return m_Budget; }
+        inline std::size_t GetCount() const { return m_Entries.size(); }
+        inline Stats const &GetStats() const { return m_Stats; }
+        std::size_t GetMemoryUsage() const;
+
+        /// Lexically normalises a path so spellings of the same file share an entry
+        static std::string Intern(std::string const &path);
+
+    private:
+        std::size_t Evict(std::size_t target);
+    };
+};
@@ -0,0 +1,92 @@
+#include "TextureTable.h"
+#include "GLCaps.h"
+#include "GLState.h"
+
+namespace Mirage
+{
+    TextureTable::TextureTable(int width, int height, int capacity, bool preferBindless)
+        : m_Bindless(preferBindless && GLCaps::Get().bindlessTexture), m_Width(width), m_Height(height), m_Count(0),
+          m_HandleBuffer(0), m_Sampler(0)
+    {
+        if (m_Bindless)
+            m_Textures.reserve(capacity);
+        else
+            m_Array.reset(new TextureArray(width, height, capacity));
+    }
+
+    TextureTable::~TextureTable()
+    {
+#ifdef GL_ARB_bindless_texture
+        // Handles must stop being resident before their textures are deleted
+        for (std::uint64_t handle : m_Handles)
+            glMakeTextureHandleNonResidentARB(handle);
+#endif
+        GLState::DeleteBuffers(1, &m_HandleBuffer);
+    }
+
+    int TextureTable::Add(const unsigned char *pixels, int width, int height, int channels)
+    {
+        if (!m_Bindless)
+        {
+            int layer = m_Array->Add(pixels, width, height, channels);
+            m_Count = m_Array->getCount();
+            return layer;
+        }
+
+        if (width != m_Width || height != m_Height || m_Textures.size() == m_Textures.capacity())
+            return -1;
+        m_Textures.emplace_back(new Texture2D(0));
+        m_Textures.back()->Upload(pixels, width, height, channels);
+        return m_Count++;
+    }
+
+    void TextureTable::Finish(GLuint sampler)
+    {
+        m_Sampler = sampler;
+        if (!m_Bindless)
+        {
+            m_Array->GenerateMipmaps();
+            return;
+        }
+
+#ifdef GL_ARB_bindless_texture
+        // A texture can't be modified any more once it has a handle
+        for (std::size_t i = m_Handles.size(); i < m_Textures.size(); i++)
+        {
+            GLuint64 handle = glGetTextureSamplerHandleARB(m_Textures[i]->getTexture(), m_Sampler);
+            glMakeTextureHandleResidentARB(handle);
+            m_Handles.push_back(handle);
+        }
+#endif
+        if (!m_HandleBuffer)
+            glGenBuffers(1, &m_HandleBuffer);
+        GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_HandleBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, m_Handles.size() * sizeof(std::uint64_t), m_Handles.data(), GL_STATIC_DRAW);
+        GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    void TextureTable::Configure(Shader &shader) const
+    {
+        if (m_Bindless)
+            shader.define("BINDLESS");
+    }
+
+    void TextureTable::Bind(Shader &shader, int binding)
+    {
+        if (m_Bindless)
+        {
+            // Point the shader's Textures block at the same binding, its layout only states the default
+            const GLuint program = shader.get();
+            const GLuint block = glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, "Textures");
+            if (block != GL_INVALID_INDEX)
+                glShaderStorageBlockBinding(program, block, binding);
+            GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_HandleBuffer);
+        }
+        else
+        {
+            m_Array->Bind(binding);
+            GLState::BindSampler(binding, m_Sampler);
+            shader.bind("textures", binding);
+        }
+    }
+};
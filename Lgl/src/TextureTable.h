@@ -0,0 +1,73 @@
+#pragma once
+
+#include "shader.h"
+#include "Texture2D.h"
+#include "TextureArray.h"
+
+// GLAD
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Mirage
+{
+    /// A table of textures indexed from shaders without binding them per draw
+    ///
+    /// With ARB_bindless_texture every texture is made resident and its handle
+    /// stored in a shader storage buffer, otherwise the images become the layers
+    /// of a texture array. Either way shaders sample entry i of "textures" and
+    /// the table is bound once, see table.frag for the shader side.
+    class TextureTable
+    {
+    private:
+        bool m_Bindless;
+        int m_Width;
+        int m_Height;
+        int m_Count;
+        // Bindless: one texture per entry and the buffer of their handles
+        std::vector<std::unique_ptr<Texture2D>> m_Textures;
+        std::vector<std::uint64_t> m_Handles;
+        GLuint m_HandleBuffer;
+        GLuint m_Sampler;
+        // Fallback
+        std::unique_ptr<TextureArray> m_Array;
+
+    public:
+        /// @param width The width of every entry in pixels
+        /// @param height The height of every entry in pixels
+        /// @param capacity The number of entries
+        /// @param preferBindless Use bindless handles when the driver supports them
+        TextureTable(int width, int height, int capacity, bool preferBindless = true);
+        ~TextureTable();
+
+        TextureTable(TextureTable const &) = delete;
+        TextureTable &operator=(TextureTable const &) = delete;
+
+        /// Adds an image, its size must match the table in both modes
+        ///
+        /// @return The entry index, or -1 when the size differs or the table is full
+        int Add(const unsigned char *pixels, int width, int height, int channels);
+
+        /// Makes the textures resident and uploads their handles (bindless) or builds
+        /// the mip chains (array), call once all entries are added
+        ///
+        /// @param sampler The sampler object every entry is read through (see SamplerCache),
+        /// bindless handles bake it in so it can't be changed afterwards
+        void Finish(GLuint sampler);
+
+        /// Selects the shader variant matching the mode, call before Shader::link()
+        void Configure(Shader &shader) const;
+
+        /// Makes the table visible to the active shader
+        ///
+        /// @param binding The storage buffer binding (bindless) or texture unit (array), the shader's
+        ///                Textures block or textures sampler is pointed at it
+        void Bind(Shader &shader, int binding = 0);
+
+        inline bool IsBindless() const { return m_Bindless; }
+        inline int GetCount() const { return m_Count; }
+    };
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+// Standard Headers
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Mirage
+{
+    /// Fixed set of worker threads draining a shared FIFO of tasks
+    class ThreadPool
+    {
+    private:
+        std::vector<std::thread> m_Workers;
+        std::deque<std::function<void()>> m_Tasks;
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        bool m_Stopping;
+
+    public:
+        /// @param threads The number of workers, 0 picks one per hardware thread
+        explicit ThreadPool(unsigned int threads = 0);
+        /// Finishes the queued tasks and joins every worker
+        ~ThreadPool();
+
+        ThreadPool(ThreadPool const &) = delete;
+        ThreadPool &operator=(ThreadPool const &) = delete;
+
+        void Enqueue(std::function<void()> task);
+
+        inline unsigned int GetThreadCount() const { return static_cast<unsigned int>(m_Workers.size()); }
+
+    private:
+        void WorkerLoop();
+    };
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+// Standard Headers
+#include <chrono>
+
+namespace Mirage
+{
+    /// Measures wall clock time from construction or the last reset
+    class Stopwatch
+    {
+    private:
+        std::chrono::steady_clock::time_point m_Start;
+
+    public:
+        Stopwatch() : m_Start(std::chrono::steady_clock::now()) {}
+
+        inline void Reset() { m_Start = std::chrono::steady_clock::now(); }
+
+        inline double ElapsedMs() const
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_Start).count();
+        }
+    };
+};
@@ -1,43 +1,171 @@
 #include "VertexArray.h"
+#include "GLCaps.h"
+#include "GLState.h"
+
+// Standard Headers
+#include <algorithm>
+#include <cassert>
 
 namespace Mirage
 {
+    const unsigned int VertexArray::MaxBindings;
+    const unsigned int VertexArray::MaxAttributes;
+
     VertexArray::VertexArray()
+        : m_AttributeCount(0), m_BindingCount(0)
     {
+#ifdef GL_VERSION_4_5
+        if (GLCaps::Get().directStateAccess)
+        {
+            glCreateVertexArrays(1, &m_RendererID);
+            return;
+        }
+#endif
         glGenVertexArrays(1, &m_RendererID);
-        glBindVertexArray(m_RendererID);
+        GLState::BindVertexArray(m_RendererID);
     }
 
     VertexArray::~VertexArray()
     {
-        glDeleteVertexArrays(1, &m_RendererID);
+        GLState::DeleteVertexArrays(1, &m_RendererID);
     }
 
-    void VertexArray::AddBuffer(Mirage::VertexBuffer &vb, const Mirage::VertexBufferLayout &layout)
+    VertexArray::VertexArray(VertexArray &&other) noexcept
+        : m_RendererID(other.m_RendererID), m_AttributeCount(other.m_AttributeCount),
+          m_BindingCount(other.m_BindingCount)
     {
-        Bind(); // Bind the vertex array object
-        // Binds the Vertex Buffer Object to this VAO
-        vb.Bind();
-        // Setup the Array Buffer Layout
-        const auto &elements = layout.GetElements();
-        unsigned int offset = 0;
-        for (unsigned int i = 0; i < elements.size(); i++)
+        std::copy(other.m_Strides, other.m_Strides + other.m_BindingCount, m_Strides);
+        other.m_RendererID = 0;
+        other.m_AttributeCount = 0;
+        other.m_BindingCount = 0;
+    }
+
+    VertexArray &VertexArray::operator=(VertexArray &&other) noexcept
+    {
+        if (this != &other)
         {
-            const auto &element = elements[i];
-            glEnableVertexAttribArray(i);
-            glVertexAttribPointer(i, element.count, element.type, element.normalised,
-                                  layout.GetStride(), (const void *)(size_t)offset);
-            offset += element.count * VertexBufferLayoutElement::GetSizeOfType(element.type);
+            GLState::DeleteVertexArrays(1, &m_RendererID);
+            m_RendererID = other.m_RendererID;
+            m_AttributeCount = other.m_AttributeCount;
+            m_BindingCount = other.m_BindingCount;
+            std::copy(other.m_Strides, other.m_Strides + other.m_BindingCount, m_Strides);
+            other.m_RendererID = 0;
+            other.m_AttributeCount = 0;
+            other.m_BindingCount = 0;
         }
+        return *this;
+    }
+
+    unsigned int VertexArray::AddFormat(const Mirage::VertexBufferLayout &layout)
+    {
+        AttributeFormat attributes[MaxAttributes];
+        assert(layout.GetLocationCount() <= MaxAttributes);
+        const unsigned int count = GetAttributes(layout, attributes);
+        return AddAttributes(attributes, count, layout.GetStride(), layout.GetDivisor());
+    }
+
+    unsigned int VertexArray::AddAttributes(const AttributeFormat *attributes, unsigned int count, unsigned int stride,
+                                            unsigned int divisor)
+    {
+        assert(m_BindingCount < MaxBindings && m_AttributeCount + count <= MaxAttributes);
+        const unsigned int binding = m_BindingCount++;
+        m_Strides[binding] = stride;
+
+#ifdef GL_VERSION_4_5
+        if (GLCaps::Get().directStateAccess)
+        {
+            for (unsigned int i = 0; i < count; i++)
+            {
+                const AttributeFormat &attribute = attributes[i];
+                const unsigned int location = m_AttributeCount++;
+                glEnableVertexArrayAttrib(m_RendererID, location);
+                if (attribute.integer)
+                    glVertexArrayAttribIFormat(m_RendererID, location, attribute.count, attribute.type, attribute.offset);
+                else
+                    glVertexArrayAttribFormat(m_RendererID, location, attribute.count, attribute.type,
+                                              attribute.normalised, attribute.offset);
+                glVertexArrayAttribBinding(m_RendererID, location, binding);
+            }
+            glVertexArrayBindingDivisor(m_RendererID, binding, divisor);
+            return binding;
+        }
+#endif
+        // The format lives in the VAO, the buffer is only named by SetBuffer(), so no GL_ARRAY_BUFFER bind
+        Bind();
+        for (unsigned int i = 0; i < count; i++)
+        {
+            const AttributeFormat &attribute = attributes[i];
+            const unsigned int location = m_AttributeCount++;
+            glEnableVertexAttribArray(location);
+            if (attribute.integer)
+                glVertexAttribIFormat(location, attribute.count, attribute.type, attribute.offset);
+            else
+                glVertexAttribFormat(location, attribute.count, attribute.type, attribute.normalised, attribute.offset);
+            glVertexAttribBinding(location, binding);
+        }
+        glVertexBindingDivisor(binding, divisor);
+        return binding;
+    }
+
+    void VertexArray::SetBuffer(unsigned int binding, GLuint buffer, GLintptr offset)
+    {
+        assert(binding < m_BindingCount);
+#ifdef GL_VERSION_4_5
+        if (GLCaps::Get().directStateAccess)
+        {
+            glVertexArrayVertexBuffer(m_RendererID, binding, buffer, offset, static_cast<GLsizei>(m_Strides[binding]));
+            return;
+        }
+#endif
+        Bind();
+        glBindVertexBuffer(binding, buffer, offset, static_cast<GLsizei>(m_Strides[binding]));
+    }
+
+    void VertexArray::SetIndexBuffer(Mirage::IndexBuffer const &ib)
+    {
+        if (GLCaps::Get().directStateAccess)
+        {
+            GLState::VertexArrayElementBuffer(m_RendererID, ib.GetRendererID());
+            return;
+        }
+        Bind();
+        GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ib.GetRendererID());
+    }
+
+    void VertexArray::AddBuffer(Mirage::VertexBuffer &vb, const Mirage::VertexBufferLayout &layout)
+    {
+        SetBuffer(AddFormat(layout), vb);
+    }
+
+    void VertexArray::AddBuffer(Mirage::StreamBuffer &sb, const Mirage::VertexBufferLayout &layout)
+    {
+        SetBuffer(AddFormat(layout), sb.GetRendererID());
     }
 
     void VertexArray::Bind() const
     {
-        glBindVertexArray(m_RendererID);
+        GLState::BindVertexArray(m_RendererID);
     }
 
     void VertexArray::Unbind() const
     {
-        glBindVertexArray(0);
+        GLState::BindVertexArray(0);
+    }
+
+    unsigned int VertexArray::GetAttributes(const Mirage::VertexBufferLayout &layout, AttributeFormat *attributes)
+    {
+        // Wide elements such as matrices take a location per 4 components
+        unsigned int count = 0, offset = 0;
+        for (const auto &element : layout.GetElements())
+        {
+            for (unsigned int component = 0; component < element.count; component += 4)
+            {
+                const unsigned int components = std::min(element.count - component, 4u);
+                attributes[count++] = {element.type, static_cast<GLint>(components),
+                                       static_cast<GLboolean>(element.normalised), false, offset};
+                offset += components * VertexBufferLayoutElement::GetSizeOfType(element.type);
+            }
+        }
+        return count;
     }
-};
\ No newline at end of file
+};
@@ -1,24 +1,95 @@
 #pragma once
 
+#include "IndexBuffer.h"
+#include "StreamBuffer.h"
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
+#include "VertexFormat.h"
 // GLAD
 #include <glad/glad.h>
 
 namespace Mirage
 {
+    /// A vertex array object whose attribute formats are kept apart from the buffers they read
+    ///
+    /// Every AddFormat() describes one buffer binding point: its attributes
+    /// (glVertexAttribFormat/glVertexAttribBinding), stride and divisor. The
+    /// buffers are attached separately with SetBuffer() (glBindVertexBuffer),
+    /// so one array per vertex format serves every mesh of that format and
+    /// switching meshes is a buffer rebind, see VertexArrayCache. With direct
+    /// state access (GL 4.5) none of this binds the array, Bind() it to draw.
     class VertexArray
     {
+    public:
+        /// Binding points GL guarantees (GL_MAX_VERTEX_ATTRIB_BINDINGS) and locations described at once
+        static const unsigned int MaxBindings = 16;
+        static const unsigned int MaxAttributes = 16;
+
     private:
         unsigned int m_RendererID;
+        unsigned int m_AttributeCount; // the location the next binding's attributes start at
+        unsigned int m_BindingCount;
+        unsigned int m_Strides[MaxBindings];
 
     public:
         VertexArray();
         ~VertexArray();
 
+        VertexArray(VertexArray const &) = delete;
+        VertexArray &operator=(VertexArray const &) = delete;
+        /// Moves hand the array name over, the source is left empty and deletes nothing
+        VertexArray(VertexArray &&other) noexcept;
+        VertexArray &operator=(VertexArray &&other) noexcept;
+
+        /// Appends a binding point with the layout's attributes at the next free locations,
+        /// so per-vertex and per-instance formats added one after the other line up with
+        /// the shader's locations in the same order
+        ///
+        /// @return The binding point to pass to SetBuffer()
+        unsigned int AddFormat(const Mirage::VertexBufferLayout &layout);
+        /// Same with a layout known at compile time (see VertexFormat), integer
+        /// attributes stay integers
+        ///
+        /// @param divisor 0 for per-vertex data, n to advance once every n instances
+        template <typename Format>
+        unsigned int AddFormat(unsigned int divisor = 0)
+        {
+            return AddAttributes(Format::attributes, Format::count, Format::stride, divisor);
+        }
+        unsigned int AddAttributes(const AttributeFormat *attributes, unsigned int count, unsigned int stride,
+                                   unsigned int divisor);
+
+        /// Points a binding at a buffer, the one call needed to draw another mesh of the same format
+        void SetBuffer(unsigned int binding, GLuint buffer, GLintptr offset = 0);
+        inline void SetBuffer(unsigned int binding, Mirage::VertexBuffer const &vb, GLintptr offset = 0)
+        {
+            SetBuffer(binding, vb.GetRendererID(), offset);
+        }
+        /// Binds the index buffer, which is part of the array's state
+        void SetIndexBuffer(Mirage::IndexBuffer const &ib);
+
+        /// AddFormat() and SetBuffer() in one
         void AddBuffer(Mirage::VertexBuffer &vb, const Mirage::VertexBufferLayout &layout);
+        /// Reads vertices from a stream buffer, draws pick each frame's vertices through
+        /// their first index, allocation offset / stride
+        void AddBuffer(Mirage::StreamBuffer &sb, const Mirage::VertexBufferLayout &layout);
+        template <typename Format>
+        void AddBuffer(Mirage::VertexBuffer &vb, unsigned int divisor = 0)
+        {
+            SetBuffer(AddFormat<Format>(divisor), vb);
+        }
 
         void Bind() const;
         void Unbind() const;
+
+        inline unsigned int GetRendererID() const { return m_RendererID; }
+        inline unsigned int GetAttributeCount() const { return m_AttributeCount; }
+        inline unsigned int GetBindingCount() const { return m_BindingCount; }
+
+        /// Lists a runtime layout's attributes, elements wider than 4 components take one entry per 4
+        ///
+        /// @param attributes Room for layout.GetLocationCount() entries
+        /// @return The number of entries written
+        static unsigned int GetAttributes(const Mirage::VertexBufferLayout &layout, AttributeFormat *attributes);
     };
-};
\ No newline at end of file
+};
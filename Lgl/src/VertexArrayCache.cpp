@@ -0,0 +1,75 @@
+#include "VertexArrayCache.h"
+#include "Hash.h"
+
+// Standard Headers
+#include <algorithm>
+#include <cassert>
+
+namespace Mirage
+{
+    VertexArrayCache::Key::Key(const AttributeFormat *source, unsigned int sourceCount, unsigned int vertexStride,
+                               unsigned int vertexDivisor)
+        : attributes(), count(sourceCount), stride(vertexStride), divisor(vertexDivisor)
+    {
+        assert(count <= VertexArray::MaxAttributes);
+        std::copy(source, source + count, attributes);
+
+        // Field by field, the padding inside AttributeFormat is undefined
+        hash = fnv1a64(&stride, sizeof(stride));
+        hash = fnv1a64(&divisor, sizeof(divisor), hash);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            AttributeFormat const &attribute = attributes[i];
+            hash = fnv1a64(&attribute.type, sizeof(attribute.type), hash);
+            hash = fnv1a64(&attribute.count, sizeof(attribute.count), hash);
+            hash = fnv1a64(&attribute.normalised, sizeof(attribute.normalised), hash);
+            hash = fnv1a64(&attribute.integer, sizeof(attribute.integer), hash);
+            hash = fnv1a64(&attribute.offset, sizeof(attribute.offset), hash);
+        }
+    }
+
+    bool VertexArrayCache::Key::operator==(Key const &other) const
+    {
+        if (hash != other.hash || count != other.count || stride != other.stride || divisor != other.divisor)
+            return false;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            AttributeFormat const &a = attributes[i], &b = other.attributes[i];
+            if (a.type != b.type || a.count != b.count || a.normalised != b.normalised || a.integer != b.integer ||
+                a.offset != b.offset)
+                return false;
+        }
+        return true;
+    }
+
+    std::size_t VertexArrayCache::Hasher::operator()(Key const &key) const
+    {
+        return static_cast<std::size_t>(key.hash);
+    }
+
+    VertexArrayCache::VertexArrayCache() : m_Requests(0)
+    {
+    }
+
+    VertexArray &VertexArrayCache::Get(const AttributeFormat *attributes, unsigned int count, unsigned int stride,
+                                       unsigned int divisor)
+    {
+        m_Requests++;
+
+        const Key key(attributes, count, stride, divisor);
+        auto found = m_Arrays.find(key);
+        if (found != m_Arrays.end())
+            return found->second;
+
+        VertexArray &array = m_Arrays.emplace(key, VertexArray()).first->second;
+        array.AddAttributes(attributes, count, stride, divisor);
+        return array;
+    }
+
+    VertexArray &VertexArrayCache::Get(const Mirage::VertexBufferLayout &layout)
+    {
+        AttributeFormat attributes[VertexArray::MaxAttributes];
+        const unsigned int count = VertexArray::GetAttributes(layout, attributes);
+        return Get(attributes, count, layout.GetStride(), layout.GetDivisor());
+    }
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "VertexArray.h"
+#include "VertexBufferLayout.h"
+#include "VertexFormat.h"
+// GLAD
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace Mirage
+{
+    /// Hash-conses vertex array objects by vertex format so every mesh of a format shares one
+    ///
+    /// The arrays come with the format set up on binding 0 and no buffers, a
+    /// mesh is drawn by pointing the shared array at its buffers:
+    ///
+    ///     VertexArray &array = cache.Get<Format>();
+    ///     array.Bind();
+    ///     array.SetBuffer(0, mesh.vertices);
+    ///     array.SetIndexBuffer(mesh.indices);
+    ///
+    /// which replaces a VAO switch (and the validation that comes with it) by a
+    /// buffer rebind, and keeps the number of VAOs down to the number of formats.
+    ///
+    /// A cached array describes binding 0 only and is shared by every mesh of its
+    /// format, so it must not be given more bindings. Meshes that also read a
+    /// per-instance stream on a second binding keep a VertexArray of their own.
+    class VertexArrayCache
+    {
+    private:
+        /// Fixed size so a lookup allocates nothing, the hash is computed once when the key is built
+        struct Key
+        {
+            AttributeFormat attributes[VertexArray::MaxAttributes];
+            unsigned int count;
+            unsigned int stride;
+            unsigned int divisor;
+            std::uint64_t hash;
+
+            Key(const AttributeFormat *source, unsigned int sourceCount, unsigned int vertexStride,
+                unsigned int vertexDivisor);
+            bool operator==(Key const &other) const;
+        };
+
+        struct Hasher
+        {
+            std::size_t operator()(Key const &key) const;
+        };
+
+        std::unordered_map<Key, VertexArray, Hasher> m_Arrays;
+        unsigned int m_Requests;
+
+    public:
+        VertexArrayCache();
+
+        VertexArrayCache(VertexArrayCache const &) = delete;
+        VertexArrayCache &operator=(VertexArrayCache const &) = delete;
+
+        /// Returns the array for a format, creating it on first use. References stay
+        /// valid for the cache's lifetime.
+        VertexArray &Get(const AttributeFormat *attributes, unsigned int count, unsigned int stride,
+                         unsigned int divisor = 0);
+        VertexArray &Get(const Mirage::VertexBufferLayout &layout);
+        template <typename Format>
+        VertexArray &Get(unsigned int divisor = 0)
+        {
+            return Get(Format::attributes, Format::count, Format::stride, divisor);
+        }
+
+        /// Number of distinct vertex array objects
+        inline std::size_t GetCount() const { return m_Arrays.size(); }
+        /// Number of Get() calls, compare with GetCount() for the sharing rate
+        inline unsigned int GetRequests() const { return m_Requests; }
+    };
+};
@@ -1,23 +1,101 @@
 #include "VertexBuffer.h"
+#include "GLCaps.h"
+#include "GLState.h"
 
 namespace Mirage
 {
-    VertexBuffer::VertexBuffer(const void *data, unsigned int size)
+    /// Immutable storage flags standing in for a glBufferData usage hint. Every buffer keeps
+    /// GL_DYNAMIC_STORAGE_BIT, since the legacy path lets Update() write any buffer.
+    static GLbitfield GetStorageFlags(GLenum usage)
     {
+        switch (usage)
+        {
+        case GL_STREAM_DRAW:
+        case GL_DYNAMIC_DRAW:
+            return GL_DYNAMIC_STORAGE_BIT | GL_MAP_WRITE_BIT;
+        case GL_STREAM_READ:
+        case GL_DYNAMIC_READ:
+        case GL_STATIC_READ:
+            return GL_DYNAMIC_STORAGE_BIT | GL_MAP_READ_BIT;
+        default:
+            return GL_DYNAMIC_STORAGE_BIT;
+        }
+    }
+
+    VertexBuffer::VertexBuffer(const void *data, unsigned int size, GLenum usage)
+        : m_Size(size), m_Usage(usage)
+    {
+#ifdef GL_VERSION_4_5
+        if (GLCaps::Get().directStateAccess)
+        {
+            // Immutable storage, Update() and Orphan() still write it through glNamedBufferSubData.
+            // Empty storage is an error where an empty glBufferData isn't, leave such buffers without any.
+            glCreateBuffers(1, &m_RendererID);
+            if (size > 0)
+                glNamedBufferStorage(m_RendererID, size, data, GetStorageFlags(usage));
+            return;
+        }
+#endif
         glGenBuffers(1, &m_RendererID);
-        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
-        glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        glBufferData(GL_ARRAY_BUFFER, size, data, usage);
     }
     VertexBuffer::~VertexBuffer()
     {
-        glDeleteBuffers(1, &m_RendererID);
+        GLState::DeleteBuffers(1, &m_RendererID);
+    }
+    VertexBuffer::VertexBuffer(VertexBuffer &&other) noexcept
+        : m_RendererID(other.m_RendererID), m_Size(other.m_Size), m_Usage(other.m_Usage)
+    {
+        other.m_RendererID = 0;
+        other.m_Size = 0;
+    }
+    VertexBuffer &VertexBuffer::operator=(VertexBuffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            GLState::DeleteBuffers(1, &m_RendererID);
+            m_RendererID = other.m_RendererID;
+            m_Size = other.m_Size;
+            m_Usage = other.m_Usage;
+            other.m_RendererID = 0;
+            other.m_Size = 0;
+        }
+        return *this;
+    }
+    void VertexBuffer::Update(const void *data, unsigned int size, unsigned int offset)
+    {
+#ifdef GL_VERSION_4_5
+        if (GLCaps::Get().directStateAccess)
+        {
+            glNamedBufferSubData(m_RendererID, offset, size, data);
+            return;
+        }
+#endif
+        GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    }
+    void VertexBuffer::Orphan(const void *data, unsigned int size)
+    {
+#ifdef GL_VERSION_4_5
+        if (GLCaps::Get().directStateAccess)
+        {
+            // Immutable storage can't be respecified, invalidating lets the driver rename it the same way
+            glInvalidateBufferData(m_RendererID);
+            glNamedBufferSubData(m_RendererID, 0, size, data);
+            return;
+        }
+#endif
+        GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, m_Usage);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
     }
     void VertexBuffer::Bind() const
     {
-        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
     }
     void VertexBuffer::Unbind() const
     {
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
     }
 };
\ No newline at end of file
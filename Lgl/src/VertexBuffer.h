@@ -7,11 +7,32 @@ namespace Mirage
     {
     private:
         unsigned int m_RendererID;
+        unsigned int m_Size;
+        GLenum m_Usage;
 
     public:
-        VertexBuffer(const void *data, unsigned int size);
+        /// @param data The initial contents, may be null
+        /// @param size The size in bytes
+        /// @param usage GL_STATIC_DRAW for geometry written once, GL_DYNAMIC_DRAW when Update() is used
+        ///              (with direct state access it picks the immutable storage flags instead)
+        VertexBuffer(const void *data, unsigned int size, GLenum usage = GL_STATIC_DRAW);
         ~VertexBuffer();
 
+        VertexBuffer(VertexBuffer const &) = delete;
+        VertexBuffer &operator=(VertexBuffer const &) = delete;
+        /// Moves hand the buffer name over, the source is left empty and deletes nothing
+        VertexBuffer(VertexBuffer &&other) noexcept;
+        VertexBuffer &operator=(VertexBuffer &&other) noexcept;
+
+        /// Overwrites part of the buffer with glBufferSubData, which waits for draws still reading it.
+        /// Per frame data is better written through a StreamBuffer.
+        void Update(const void *data, unsigned int size, unsigned int offset = 0);
+        /// Replaces the storage before writing (orphaning), draws in flight keep the old one
+        void Orphan(const void *data, unsigned int size);
+
+        inline unsigned int GetSize() const { return m_Size; }
+        inline unsigned int GetRendererID() const { return m_RendererID; }
+
         void Bind() const;
         void Unbind() const;
     };
@@ -37,6 +37,7 @@ namespace Mirage
     private:
         std::vector<VertexBufferLayoutElement> m_Elements;
         unsigned int m_stride;
+        unsigned int m_Divisor;
 
         void push(unsigned int count, identity<float>)
         {
@@ -57,16 +58,28 @@ namespace Mirage
         }
 
     public:
-        VertexBufferLayout()
-            : m_stride(0) {}
+        /// @param divisor 0 for per-vertex attributes, n to advance once every n instances
+        explicit VertexBufferLayout(unsigned int divisor = 0)
+            : m_stride(0), m_Divisor(divisor) {}
 
+        /// Appends an attribute, more than 4 components (e.g. 16 floats of a mat4)
+        /// take one attribute location per 4 components
         template <typename T>
         void push(unsigned int count)
         {
             push(count, identity<T>());
         }
 
-        inline const std::vector<VertexBufferLayoutElement> GetElements() const { return m_Elements; }
+        inline const std::vector<VertexBufferLayoutElement> &GetElements() const { return m_Elements; }
         inline unsigned int GetStride() const { return m_stride; }
+        inline unsigned int GetDivisor() const { return m_Divisor; }
+        /// Attribute locations the layout takes up
+        inline unsigned int GetLocationCount() const
+        {
+            unsigned int locations = 0;
+            for (auto const &element : m_Elements)
+                locations += (element.count + 3) / 4;
+            return locations;
+        }
     };
 };
\ No newline at end of file
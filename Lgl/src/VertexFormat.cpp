@@ -0,0 +1,73 @@
+#include "VertexFormat.h"
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Mirage
+{
+    Half Half::From(float value)
+    {
+        std::uint32_t f;
+        std::memcpy(&f, &value, sizeof(f));
+        const std::uint32_t sign = (f >> 16) & 0x8000u;
+        const std::uint32_t magnitude = f & 0x7fffffffu;
+        Half half;
+
+        if (magnitude > 0x7f800000u)
+        {
+            half.bits = static_cast<std::uint16_t>(sign | 0x7e00u); // NaN
+            return half;
+        }
+        const int exponent = static_cast<int>(magnitude >> 23) - 127 + 15;
+        std::uint32_t mantissa = magnitude & 0x7fffffu;
+        if (exponent >= 31)
+        {
+            half.bits = static_cast<std::uint16_t>(sign | 0x7c00u); // infinity
+            return half;
+        }
+
+        // Round to nearest even on the bits shifted out, a carry may bump the exponent which is still right
+        std::uint32_t bits;
+        int shift;
+        if (exponent > 0)
+        {
+            bits = (static_cast<std::uint32_t>(exponent) << 10) | (mantissa >> 13);
+            shift = 13;
+        }
+        else if (exponent >= -10)
+        {
+            // Subnormal, the implicit leading 1 becomes explicit
+            mantissa |= 0x800000u;
+            shift = 14 - exponent;
+            bits = mantissa >> shift;
+        }
+        else
+        {
+            half.bits = static_cast<std::uint16_t>(sign);
+            return half;
+        }
+        const std::uint32_t remainder = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (bits & 1)))
+            bits++;
+        half.bits = static_cast<std::uint16_t>(sign | bits);
+        return half;
+    }
+
+    /// Two's complement of a value in [-1, 1] scaled to a signed field of the given width
+    static std::uint32_t SignedField(float value, int bits)
+    {
+        const float scale = static_cast<float>((1 << (bits - 1)) - 1);
+        const int quantized = static_cast<int>(std::lround(std::min(std::max(value, -1.0f), 1.0f) * scale));
+        return static_cast<std::uint32_t>(quantized) & ((1u << bits) - 1);
+    }
+
+    PackedNormal PackedNormal::From(glm::vec3 const &value, int w)
+    {
+        PackedNormal packed;
+        packed.bits = SignedField(value.x, 10) | (SignedField(value.y, 10) << 10) | (SignedField(value.z, 10) << 20) |
+                      ((static_cast<std::uint32_t>(std::min(std::max(w, -1), 1)) & 3u) << 30);
+        return packed;
+    }
+};
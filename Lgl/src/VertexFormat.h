@@ -0,0 +1,154 @@
+#pragma once
+
+// GLAD
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Mirage
+{
+    /// A 16 bit float as stored in vertex buffers (GL_HALF_FLOAT)
+    struct Half
+    {
+        std::uint16_t bits;
+
+        /// Rounds to the nearest half, out of range values become infinity
+        static Half From(float value);
+    };
+
+    /// Signed normalised x, y and z in 10 bits each plus a 2 bit w (GL_INT_2_10_10_10_REV),
+    /// a normal or tangent in 4 bytes instead of 12
+    struct PackedNormal
+    {
+        std::uint32_t bits;
+
+        /// @param value Components in [-1, 1], clamped
+        /// @param w -1 to 1, e.g. the handedness of a tangent
+        static PackedNormal From(glm::vec3 const &value, int w = 0);
+    };
+
+    /// Four unsigned bytes the shader reads as floats in [0, 1], e.g. a colour
+    struct Unorm8x4
+    {
+        std::uint8_t value[4];
+    };
+
+    /// What a vertex struct member looks like to glVertexAttrib(I)Pointer
+    ///
+    /// integer attributes go through glVertexAttribIPointer and arrive as
+    /// int/uint/ivecN/uvecN, everything else is converted to float.
+    template <typename T>
+    struct AttributeTraits;
+
+    template <GLenum Type, GLint Count, bool Normalised, bool Integer>
+    struct AttributeTraitsOf
+    {
+        static const GLenum type = Type;
+        static const GLint count = Count;
+        static const bool normalised = Normalised;
+        static const bool integer = Integer;
+    };
+
+    template <> struct AttributeTraits<float> : AttributeTraitsOf<GL_FLOAT, 1, false, false> {};
+    template <> struct AttributeTraits<glm::vec2> : AttributeTraitsOf<GL_FLOAT, 2, false, false> {};
+    template <> struct AttributeTraits<glm::vec3> : AttributeTraitsOf<GL_FLOAT, 3, false, false> {};
+    template <> struct AttributeTraits<glm::vec4> : AttributeTraitsOf<GL_FLOAT, 4, false, false> {};
+    template <> struct AttributeTraits<Half> : AttributeTraitsOf<GL_HALF_FLOAT, 1, false, false> {};
+    template <> struct AttributeTraits<PackedNormal> : AttributeTraitsOf<GL_INT_2_10_10_10_REV, 4, true, false> {};
+    template <> struct AttributeTraits<Unorm8x4> : AttributeTraitsOf<GL_UNSIGNED_BYTE, 4, true, false> {};
+    template <> struct AttributeTraits<std::int32_t> : AttributeTraitsOf<GL_INT, 1, false, true> {};
+    template <> struct AttributeTraits<std::uint32_t> : AttributeTraitsOf<GL_UNSIGNED_INT, 1, false, true> {};
+    template <> struct AttributeTraits<std::int16_t> : AttributeTraitsOf<GL_SHORT, 1, false, true> {};
+    template <> struct AttributeTraits<std::uint16_t> : AttributeTraitsOf<GL_UNSIGNED_SHORT, 1, false, true> {};
+    template <> struct AttributeTraits<std::int8_t> : AttributeTraitsOf<GL_BYTE, 1, false, true> {};
+    template <> struct AttributeTraits<std::uint8_t> : AttributeTraitsOf<GL_UNSIGNED_BYTE, 1, false, true> {};
+    template <> struct AttributeTraits<glm::ivec2> : AttributeTraitsOf<GL_INT, 2, false, true> {};
+    template <> struct AttributeTraits<glm::ivec3> : AttributeTraitsOf<GL_INT, 3, false, true> {};
+    template <> struct AttributeTraits<glm::ivec4> : AttributeTraitsOf<GL_INT, 4, false, true> {};
+    template <> struct AttributeTraits<glm::uvec2> : AttributeTraitsOf<GL_UNSIGNED_INT, 2, false, true> {};
+    template <> struct AttributeTraits<glm::uvec3> : AttributeTraitsOf<GL_UNSIGNED_INT, 3, false, true> {};
+    template <> struct AttributeTraits<glm::uvec4> : AttributeTraitsOf<GL_UNSIGNED_INT, 4, false, true> {};
+
+    /// Arrays of single components, e.g. Half uv[2] or std::uint8_t joints[4]
+    template <typename T, std::size_t N>
+    struct AttributeTraits<T[N]> : AttributeTraitsOf<AttributeTraits<T>::type, static_cast<GLint>(N),
+                                                      AttributeTraits<T>::normalised, AttributeTraits<T>::integer>
+    {
+        static_assert(AttributeTraits<T>::count == 1, "Only arrays of scalars form an attribute");
+    };
+
+    /// The format of one attribute, as VertexArray hands it to GL
+    struct AttributeFormat
+    {
+        GLenum type;
+        GLint count;
+        GLboolean normalised;
+        bool integer;
+        GLuint offset;
+    };
+
+    /// A member of a vertex struct at a fixed offset, see MIRAGE_ATTRIBUTE
+    template <typename Member, std::size_t Offset>
+    struct VertexAttribute
+    {
+        typedef AttributeTraits<Member> Traits;
+        static_assert(Traits::count >= 1 && Traits::count <= 4, "An attribute has 1 to 4 components");
+        static_assert(Traits::type != GL_INT_2_10_10_10_REV || Offset % 4 == 0, "Packed attributes need 4 byte alignment");
+
+        static const std::size_t offset = Offset;
+        static const std::size_t size = sizeof(Member);
+
+        static constexpr AttributeFormat Format()
+        {
+            return {Traits::type, Traits::count, static_cast<GLboolean>(Traits::normalised ? GL_TRUE : GL_FALSE),
+                    Traits::integer, static_cast<GLuint>(Offset)};
+        }
+    };
+
+    /// True when every attribute starts at or after the end of the one before and ends within the stride
+    template <std::size_t Stride, std::size_t End, typename... Attributes>
+    struct AttributesFit
+    {
+        static const bool value = true;
+    };
+
+    template <std::size_t Stride, std::size_t End, typename First, typename... Rest>
+    struct AttributesFit<Stride, End, First, Rest...>
+    {
+        static const bool value = First::offset >= End && First::offset + First::size <= Stride &&
+                                  AttributesFit<Stride, First::offset + First::size, Rest...>::value;
+    };
+
+    /// Vertex layout of a struct, worked out at compile time
+    ///
+    /// The attributes take consecutive locations in the order listed, which
+    /// has to be the order of the members, and live in a static array, so
+    /// setting the layout up allocates nothing:
+    ///
+    ///     struct Vertex { glm::vec3 position; PackedNormal normal; Half uv[2]; };
+    ///     typedef VertexFormat<Vertex, MIRAGE_ATTRIBUTE(Vertex, position), MIRAGE_ATTRIBUTE(Vertex, normal),
+    ///                          MIRAGE_ATTRIBUTE(Vertex, uv)> Format;
+    ///     vao.AddBuffer<Format>(vbo);
+    template <typename Vertex, typename... Attributes>
+    struct VertexFormat
+    {
+        static_assert(std::is_standard_layout<Vertex>::value, "Attribute offsets need a standard layout vertex");
+        static_assert(sizeof...(Attributes) > 0, "A vertex format needs attributes");
+        static_assert(AttributesFit<sizeof(Vertex), 0, Attributes...>::value,
+                      "Attributes must be listed in member order and lie within the vertex");
+
+        static const unsigned int stride = sizeof(Vertex);
+        static const unsigned int count = sizeof...(Attributes);
+        static constexpr AttributeFormat attributes[sizeof...(Attributes)] = {Attributes::Format()...};
+    };
+
+    template <typename Vertex, typename... Attributes>
+    constexpr AttributeFormat VertexFormat<Vertex, Attributes...>::attributes[sizeof...(Attributes)];
+};
+
+/// The VertexAttribute of a member, its format follows from the member's type
+#define MIRAGE_ATTRIBUTE(Vertex, member) ::Mirage::VertexAttribute<decltype(Vertex::member), offsetof(Vertex, member)>
@@ -0,0 +1,520 @@
+#include "VirtualTexture.h"
+#include "GLCaps.h"
+#include "GLState.h"
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace Mirage
+{
+    VirtualTexture::VirtualTexture(std::string const &path, int cachePages, bool preferSparse)
+        : m_Header(nullptr), m_Offsets(nullptr), m_Sparse(false), m_Pages(0), m_Indirection(0), m_CacheSide(0),
+          m_TailLevel(0), m_FeedbackFramebuffer(0), m_FeedbackTarget(0), m_FeedbackWidth(0), m_FeedbackHeight(0),
+          m_ReadbackIndex(0), m_Frame(0), m_Dirty(true)
+    {
+        memset(&m_Stats, 0, sizeof(m_Stats));
+        for (int i = 0; i < 2; i++)
+        {
+            m_Readback[i] = 0;
+            m_ReadbackFence[i] = nullptr;
+            m_ReadbackWidth[i] = m_ReadbackHeight[i] = 0;
+        }
+
+        Load(path);
+        if (!IsOpen())
+            return;
+        CreateCache(cachePages, preferSparse);
+
+        // The single tile of the last level backs every lookup, keep it resident
+        const std::uint32_t top = static_cast<std::uint32_t>(m_Resident.size() - 1);
+        if (m_Resident[top] == -1)
+        {
+            const int page = AcquirePage();
+            if (page >= 0)
+            {
+                UploadTile(top, page);
+                m_PageTable[page].locked = true;
+            }
+        }
+        RebuildIndirection();
+    }
+
+    VirtualTexture::~VirtualTexture()
+    {
+        for (int i = 0; i < 2; i++)
+            if (m_ReadbackFence[i])
+                glDeleteSync(m_ReadbackFence[i]);
+        GLState::DeleteBuffers(2, m_Readback);
+        GLState::DeleteFramebuffers(1, &m_FeedbackFramebuffer);
+        GLState::DeleteTextures(1, &m_FeedbackTarget);
+        GLState::DeleteTextures(1, &m_Indirection);
+        GLState::DeleteTextures(1, &m_Pages);
+    }
+
+    void VirtualTexture::Load(std::string const &path)
+    {
+        if (!m_File.Open(path))
+        {
+            std::cout << "Failed to load virtual texture : " << path << std::endl;
+            return;
+        }
+
+        const std::size_t size = m_File.GetSize();
+        const Vtx::Header *header = reinterpret_cast<const Vtx::Header *>(m_File.GetData());
+        if (size < sizeof(Vtx::Header) || header->magic != Vtx::Magic || header->version != Vtx::Version ||
+            header->levels == 0 || header->levels > Vtx::MaxLevels || header->tileSize == 0 ||
+            header->size != header->tileSize << (header->levels - 1) ||
+            size < sizeof(Vtx::Header) + Vtx::TileCount(*header) * sizeof(std::uint64_t))
+        {
+            std::cout << "Invalid virtual texture : " << path << std::endl;
+            m_File.Close();
+            return;
+        }
+
+        const std::uint64_t count = Vtx::TileCount(*header);
+        const std::uint64_t page = header->tileSize + 2 * header->border;
+        const std::uint64_t *offsets = reinterpret_cast<const std::uint64_t *>(header + 1);
+        for (std::uint64_t i = 0; i < count; i++)
+        {
+            if (offsets[i] > size || page * page * 4 > size - offsets[i])
+            {
+                std::cout << "Truncated virtual texture : " << path << std::endl;
+                m_File.Close();
+                return;
+            }
+        }
+
+        m_Header = header;
+        m_Offsets = offsets;
+        m_Resident.assign(static_cast<std::size_t>(count), -1);
+    }
+
+    void VirtualTexture::CreateCache(int cachePages, bool preferSparse)
+    {
+        const int tileSize = static_cast<int>(m_Header->tileSize);
+        const int levels = static_cast<int>(m_Header->levels);
+
+#ifdef GL_ARB_sparse_texture
+        // Sparse pages must line up with the tiles, pick the page size that matches
+        GLint pageSizeIndex = -1;
+        if (preferSparse && GLCaps::Get().sparseTexture)
+        {
+            GLint sizes = 0;
+            glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, GL_NUM_VIRTUAL_PAGE_SIZES_ARB, 1, &sizes);
+            std::vector<GLint> x(sizes), y(sizes);
+            if (sizes > 0)
+            {
+                glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, GL_VIRTUAL_PAGE_SIZE_X_ARB, sizes, x.data());
+                glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, GL_VIRTUAL_PAGE_SIZE_Y_ARB, sizes, y.data());
+            }
+            for (GLint i = 0; i < sizes && pageSizeIndex < 0; i++)
+                if (x[i] == tileSize && y[i] == tileSize)
+                    pageSizeIndex = i;
+        }
+        m_Sparse = pageSizeIndex >= 0;
+#else
+        (void)preferSparse;
+#endif
+
+        glGenTextures(1, &m_Pages);
+        GLState::BindTexture(GL_TEXTURE_2D, m_Pages);
+        if (m_Sparse)
+        {
+#ifdef GL_ARB_sparse_texture
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SPARSE_ARB, GL_TRUE);
+            glTexParameteri(GL_TEXTURE_2D, GL_VIRTUAL_PAGE_SIZE_INDEX_ARB, pageSizeIndex);
+            glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA8, m_Header->size, m_Header->size);
+            GLint sparseLevels = levels;
+            glGetTexParameteriv(GL_TEXTURE_2D, GL_NUM_SPARSE_LEVELS_ARB, &sparseLevels);
+            m_TailLevel = std::min(sparseLevels, levels);
+#endif
+            // The top tile is locked into a page, so there is always at least one
+            m_PageTable.resize(std::max(cachePages, 1));
+        }
+        else
+        {
+            // Pages hold their border too, so the cache side is a multiple of the bordered size
+            const int page = tileSize + 2 * static_cast<int>(m_Header->border);
+            GLint maxSize = 0;
+            glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+            m_CacheSide = 1;
+            while (m_CacheSide * m_CacheSide < cachePages && (m_CacheSide + 1) * page <= maxSize && m_CacheSide < 255)
+                m_CacheSide++;
+            glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, m_CacheSide * page, m_CacheSide * page);
+            m_PageTable.resize(m_CacheSide * m_CacheSide);
+            m_TailLevel = levels;
+        }
+        GLState::BindTexture(GL_TEXTURE_2D, 0);
+
+        Page free = {-1, 0, false};
+        std::fill(m_PageTable.begin(), m_PageTable.end(), free);
+
+        // One texel per tile of every level, or per level 0 tile for the sparse clamp table
+        const GLsizei side = static_cast<GLsizei>(Vtx::TilesPerSide(*m_Header, 0));
+        glGenTextures(1, &m_Indirection);
+        GLState::BindTexture(GL_TEXTURE_2D, m_Indirection);
+        if (m_Sparse)
+            glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8UI, side, side);
+        else
+            glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA8UI, side, side);
+        GLState::BindTexture(GL_TEXTURE_2D, 0);
+
+#ifdef GL_ARB_sparse_texture
+        // The mip tail can only be committed as a whole, it stays resident beside the cache
+        for (int level = m_TailLevel; level < levels; level++)
+        {
+            const std::uint32_t tiles = Vtx::TilesPerSide(*m_Header, level);
+            GLState::BindTexture(GL_TEXTURE_2D, m_Pages);
+            glTexPageCommitmentARB(GL_TEXTURE_2D, level, 0, 0, 0, tiles * tileSize, tiles * tileSize, 1, GL_TRUE);
+            GLState::BindTexture(GL_TEXTURE_2D, 0);
+            for (std::uint32_t y = 0; y < tiles; y++)
+                for (std::uint32_t x = 0; x < tiles; x++)
+                    UploadTile(static_cast<std::uint32_t>(Vtx::TileIndex(*m_Header, level, x, y)), TailPage);
+        }
+#endif
+    }
+
+    void VirtualTexture::Configure(Shader &shader, bool feedback) const
+    {
+        if (m_Sparse)
+            shader.define("SPARSE");
+        if (feedback)
+            shader.define("FEEDBACK");
+    }
+
+    void VirtualTexture::BeginFeedback()
+    {
+        glGetIntegerv(GL_VIEWPORT, m_Viewport);
+        const int width = std::max(1, m_Viewport[2] / FeedbackScale), height = std::max(1, m_Viewport[3] / FeedbackScale);
+        if (width != m_FeedbackWidth || height != m_FeedbackHeight)
+        {
+            GLState::DeleteTextures(1, &m_FeedbackTarget);
+            glGenTextures(1, &m_FeedbackTarget);
+            GLState::BindTexture(GL_TEXTURE_2D, m_FeedbackTarget);
+            glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16UI, width, height);
+            GLState::BindTexture(GL_TEXTURE_2D, 0);
+            if (!m_FeedbackFramebuffer)
+                glGenFramebuffers(1, &m_FeedbackFramebuffer);
+            GLState::BindFramebuffer(GL_FRAMEBUFFER, m_FeedbackFramebuffer);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_FeedbackTarget, 0);
+            m_FeedbackWidth = width;
+            m_FeedbackHeight = height;
+        }
+
+        GLState::BindFramebuffer(GL_FRAMEBUFFER, m_FeedbackFramebuffer);
+        glViewport(0, 0, m_FeedbackWidth, m_FeedbackHeight);
+        // Pixels nothing was drawn to keep a zero valid flag
+        const GLuint clear[4] = {0, 0, 0, 0};
+        glClearBufferuiv(GL_COLOR, 0, clear);
+    }
+
+    void VirtualTexture::EndFeedback()
+    {
+        // A readback that was never consumed is dropped in favour of the newer one
+        const int i = m_ReadbackIndex;
+        if (m_ReadbackFence[i])
+            glDeleteSync(m_ReadbackFence[i]);
+        if (!m_Readback[i])
+            glGenBuffers(1, &m_Readback[i]);
+
+        GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, m_Readback[i]);
+        if (m_ReadbackWidth[i] != m_FeedbackWidth || m_ReadbackHeight[i] != m_FeedbackHeight)
+        {
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(m_FeedbackWidth) * m_FeedbackHeight * 4 * sizeof(std::uint16_t),
+                         nullptr, GL_STREAM_READ);
+            m_ReadbackWidth[i] = m_FeedbackWidth;
+            m_ReadbackHeight[i] = m_FeedbackHeight;
+        }
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, m_FeedbackWidth, m_FeedbackHeight, GL_RGBA_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+        GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        m_ReadbackFence[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_ReadbackIndex ^= 1;
+
+        GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(m_Viewport[0], m_Viewport[1], m_Viewport[2], m_Viewport[3]);
+    }
+
+    void VirtualTexture::Update(int maxUploads)
+    {
+        if (!IsOpen())
+            return;
+        m_Frame++;
+
+        // Only feedback the GPU already finished is read, nothing here waits
+        for (int i = 0; i < 2; i++)
+        {
+            if (!m_ReadbackFence[i])
+                continue;
+            GLenum status = glClientWaitSync(m_ReadbackFence[i], 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                continue;
+            glDeleteSync(m_ReadbackFence[i]);
+            m_ReadbackFence[i] = nullptr;
+
+            GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, m_Readback[i]);
+            const GLsizeiptr size = static_cast<GLsizeiptr>(m_ReadbackWidth[i]) * m_ReadbackHeight[i] * 4 * sizeof(std::uint16_t);
+            const void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+            if (data)
+                Gather(static_cast<const std::uint16_t *>(data), m_ReadbackWidth[i], m_ReadbackHeight[i]);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+
+        // Everything still visible is touched first so none of it gets evicted below
+        for (std::uint32_t tile : m_Requests)
+            if (m_Resident[tile] >= 0)
+                m_PageTable[m_Resident[tile]].lastUsed = m_Frame;
+
+        // Coarse levels sit at the end of the table, streaming them first keeps holes blurry rather than empty
+        int uploads = 0;
+        for (auto it = m_Requests.rbegin(); it != m_Requests.rend() && uploads < maxUploads; ++it)
+        {
+            if (m_Resident[*it] != -1)
+                continue;
+            int page = AcquirePage();
+            if (page < 0)
+                break;
+            UploadTile(*it, page);
+            m_PageTable[page].lastUsed = m_Frame;
+            uploads++;
+        }
+        m_Requests.clear();
+
+        if (m_Dirty)
+            RebuildIndirection();
+    }
+
+    void VirtualTexture::Gather(const std::uint16_t *feedback, int width, int height)
+    {
+        const std::size_t pixels = static_cast<std::size_t>(width) * height;
+        for (std::size_t i = 0; i < pixels; i++)
+        {
+            const std::uint16_t *texel = feedback + i * 4;
+            if (!texel[3] || texel[2] >= m_Header->levels)
+                continue;
+
+            // Every ancestor is requested too so lookups always find a resident fallback
+            std::uint32_t x = texel[0], y = texel[1];
+            for (std::uint32_t level = texel[2]; level < m_Header->levels; level++, x >>= 1, y >>= 1)
+            {
+                const std::uint32_t tiles = Vtx::TilesPerSide(*m_Header, level);
+                if (x >= tiles || y >= tiles)
+                    break;
+                m_Requests.push_back(static_cast<std::uint32_t>(Vtx::TileIndex(*m_Header, level, x, y)));
+            }
+        }
+        std::sort(m_Requests.begin(), m_Requests.end());
+        m_Requests.erase(std::unique(m_Requests.begin(), m_Requests.end()), m_Requests.end());
+        m_Stats.requests = static_cast<unsigned int>(m_Requests.size());
+    }
+
+    int VirtualTexture::AcquirePage()
+    {
+        // A free page if there is one, otherwise the least recently used that wasn't seen this frame
+        int oldest = -1;
+        for (std::size_t i = 0; i < m_PageTable.size(); i++)
+        {
+            Page const &page = m_PageTable[i];
+            if (page.tile < 0)
+                return static_cast<int>(i);
+            if (!page.locked && page.lastUsed < m_Frame && (oldest < 0 || page.lastUsed < m_PageTable[oldest].lastUsed))
+                oldest = static_cast<int>(i);
+        }
+        if (oldest >= 0)
+            EvictPage(oldest);
+        return oldest;
+    }
+
+    void VirtualTexture::UploadTile(std::uint32_t tile, int page)
+    {
+        std::uint32_t level, x, y;
+        Locate(tile, level, x, y);
+        const GLint tileSize = m_Header->tileSize, border = m_Header->border, bordered = tileSize + 2 * border;
+        const unsigned char *pixels = m_File.GetData() + m_Offsets[tile];
+
+        GLState::BindTexture(GL_TEXTURE_2D, m_Pages);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        if (m_Sparse)
+        {
+#ifdef GL_ARB_sparse_texture
+            // Sparse pages hold the tile without its border, at its virtual position
+            if (page != TailPage)
+                glTexPageCommitmentARB(GL_TEXTURE_2D, level, x * tileSize, y * tileSize, 0, tileSize, tileSize, 1, GL_TRUE);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, bordered);
+            glPixelStorei(GL_UNPACK_SKIP_PIXELS, border);
+            glPixelStorei(GL_UNPACK_SKIP_ROWS, border);
+            glTexSubImage2D(GL_TEXTURE_2D, level, x * tileSize, y * tileSize, tileSize, tileSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+            glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+#endif
+        }
+        else
+            glTexSubImage2D(GL_TEXTURE_2D, 0, (page % m_CacheSide) * bordered, (page / m_CacheSide) * bordered, bordered,
+                            bordered, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        GLState::BindTexture(GL_TEXTURE_2D, 0);
+
+        m_Resident[tile] = page;
+        if (page != TailPage)
+        {
+            m_PageTable[page].tile = tile;
+            m_Stats.uploads++;
+            m_Stats.resident++;
+        }
+        m_Dirty = true;
+    }
+
+    void VirtualTexture::EvictPage(int page)
+    {
+        const std::uint32_t tile = static_cast<std::uint32_t>(m_PageTable[page].tile);
+#ifdef GL_ARB_sparse_texture
+        if (m_Sparse)
+        {
+            std::uint32_t level, x, y;
+            Locate(tile, level, x, y);
+            const GLint tileSize = m_Header->tileSize;
+            GLState::BindTexture(GL_TEXTURE_2D, m_Pages);
+            glTexPageCommitmentARB(GL_TEXTURE_2D, level, x * tileSize, y * tileSize, 0, tileSize, tileSize, 1, GL_FALSE);
+            GLState::BindTexture(GL_TEXTURE_2D, 0);
+        }
+#endif
+        m_Resident[tile] = -1;
+        m_PageTable[page].tile = -1;
+        m_Stats.evictions++;
+        m_Stats.resident--;
+        m_Dirty = true;
+    }
+
+    void VirtualTexture::RebuildIndirection()
+    {
+        const std::uint32_t levels = m_Header->levels;
+        GLState::BindTexture(GL_TEXTURE_2D, m_Indirection);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        if (m_Sparse)
+        {
+            // Finest level resident all the way up the chain of every level 0 tile
+            const std::uint32_t side = Vtx::TilesPerSide(*m_Header, 0);
+            std::vector<std::uint8_t> finest(static_cast<std::size_t>(side) * side);
+            for (std::uint32_t y = 0; y < side; y++)
+                for (std::uint32_t x = 0; x < side; x++)
+                {
+                    std::uint32_t level = levels - 1;
+                    while (level > 0 && m_Resident[Vtx::TileIndex(*m_Header, level - 1, x >> (level - 1), y >> (level - 1))] != -1)
+                        level--;
+                    finest[static_cast<std::size_t>(y) * side + x] = static_cast<std::uint8_t>(level);
+                }
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, side, side, GL_RED_INTEGER, GL_UNSIGNED_BYTE, finest.data());
+        }
+        else
+        {
+            // Coarsest first, so tiles without a page inherit their parent's entry
+            std::vector<std::uint8_t> parent, entries;
+            for (std::uint32_t level = levels; level-- > 0;)
+            {
+                const std::uint32_t side = Vtx::TilesPerSide(*m_Header, level);
+                entries.assign(static_cast<std::size_t>(side) * side * 4, 0);
+                for (std::uint32_t y = 0; y < side; y++)
+                    for (std::uint32_t x = 0; x < side; x++)
+                    {
+                        std::uint8_t *entry = &entries[(static_cast<std::size_t>(y) * side + x) * 4];
+                        const std::int32_t page = m_Resident[Vtx::TileIndex(*m_Header, level, x, y)];
+                        if (page >= 0)
+                        {
+                            entry[0] = static_cast<std::uint8_t>(page % m_CacheSide);
+                            entry[1] = static_cast<std::uint8_t>(page / m_CacheSide);
+                            entry[2] = static_cast<std::uint8_t>(level);
+                        }
+                        else if (!parent.empty())
+                            memcpy(entry, &parent[(static_cast<std::size_t>(y / 2) * (side / 2) + x / 2) * 4], 4);
+                    }
+                glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, side, side, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, entries.data());
+                parent.swap(entries);
+            }
+        }
+        GLState::BindTexture(GL_TEXTURE_2D, 0);
+        m_Dirty = false;
+    }
+
+    void VirtualTexture::Bind(Shader &shader, SamplerCache &samplers, int slotID, bool feedback)
+    {
+        const float levelSize = static_cast<float>(m_Header->size);
+        shader.bind("virtualSize", levelSize);
+        shader.bind("uvScale", glm::vec2(m_Header->width / levelSize, m_Header->height / levelSize));
+        shader.bind("levels", static_cast<int>(m_Header->levels));
+        shader.bind("tileSize", static_cast<float>(m_Header->tileSize));
+        // Feedback pixels cover FeedbackScale pixels of the final image each way, which
+        // inflates their derivatives by as much
+        shader.bind("lodBias", feedback ? -std::log2(static_cast<float>(FeedbackScale)) : 0.0f);
+        if (feedback)
+            return;
+
+        const int bordered = m_Header->tileSize + 2 * m_Header->border;
+        shader.bind("pageBorder", static_cast<float>(m_Header->border));
+        shader.bind("cacheSize", static_cast<float>(m_CacheSide * bordered));
+        shader.bind("pages", slotID);
+        shader.bind("indirection", slotID + 1);
+
+        // Sparse textures filter within the level the clamp picked, the page cache has a single level
+        SamplerState pages = SamplerState::Clamped();
+        if (m_Sparse)
+            pages.minFilter = GL_LINEAR_MIPMAP_NEAREST;
+        GLState::BindTextureUnit(slotID, GL_TEXTURE_2D, m_Pages);
+        samplers.Bind(slotID, pages);
+        GLState::BindTextureUnit(slotID + 1, GL_TEXTURE_2D, m_Indirection);
+        SamplerState lookup = {GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, 1.0f};
+        samplers.Bind(slotID + 1, lookup);
+    }
+
+    std::size_t VirtualTexture::GetMemoryUsage() const
+    {
+        if (!IsOpen())
+            return 0;
+        const std::size_t tileSize = m_Header->tileSize, side = Vtx::TilesPerSide(*m_Header, 0);
+        if (m_Sparse)
+        {
+            // Committed pages, the mip tail and the clamp table
+            std::size_t tail = 0;
+            for (std::uint32_t level = m_TailLevel; level < m_Header->levels; level++)
+                tail += static_cast<std::size_t>(Vtx::TilesPerSide(*m_Header, level)) * Vtx::TilesPerSide(*m_Header, level);
+            return (m_Stats.resident + tail) * tileSize * tileSize * 4 + side * side;
+        }
+
+        std::size_t indirection = 0;
+        for (std::uint32_t level = 0; level < m_Header->levels; level++)
+            indirection += static_cast<std::size_t>(Vtx::TilesPerSide(*m_Header, level)) * Vtx::TilesPerSide(*m_Header, level) * 4;
+        const std::size_t cache = static_cast<std::size_t>(m_CacheSide) * (tileSize + 2 * m_Header->border);
+        return cache * cache * 4 + indirection;
+    }
+
+    std::size_t VirtualTexture::GetVirtualSize() const
+    {
+        if (!IsOpen())
+            return 0;
+        std::size_t size = 0;
+        for (std::uint32_t level = 0; level < m_Header->levels; level++)
+        {
+            const std::size_t width = std::max(1u, m_Header->width >> level), height = std::max(1u, m_Header->height >> level);
+            size += width * height * 4;
+        }
+        return size;
+    }
+
+    void VirtualTexture::Locate(std::uint32_t tile, std::uint32_t &level, std::uint32_t &x, std::uint32_t &y) const
+    {
+        std::uint64_t index = tile;
+        for (level = 0; level + 1 < m_Header->levels; level++)
+        {
+            const std::uint64_t tiles = static_cast<std::uint64_t>(Vtx::TilesPerSide(*m_Header, level));
+            if (index < tiles * tiles)
+                break;
+            index -= tiles * tiles;
+        }
+        const std::uint32_t side = Vtx::TilesPerSide(*m_Header, level);
+        x = static_cast<std::uint32_t>(index % side);
+        y = static_cast<std::uint32_t>(index / side);
+    }
+};
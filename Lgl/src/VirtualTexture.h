@@ -0,0 +1,138 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "SamplerCache.h"
+#include "shader.h"
+#include "VtxFormat.h"
+
+// GLAD
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Mirage
+{
+    /// Streams the visible tiles of a cooked .vtx image into a fixed page cache
+    ///
+    /// Each frame the scene is first drawn at low resolution with the feedback
+    /// variant of virtual.frag, which writes the tile and level every pixel wants.
+    /// The feedback is read back asynchronously and Update() uploads the missing
+    /// tiles, coarse levels first, evicting the least recently seen pages when
+    /// the cache is full. Video memory is bounded by the cache size however
+    /// large the source image is.
+    ///
+    /// With ARB_sparse_texture (and a sparse page size equal to the tile size)
+    /// the tiles are committed at their place in one sparse texture and a table
+    /// of the finest resident level clamps sampling. Otherwise tiles go to any
+    /// free page of an ordinary texture and an indirection texture maps every
+    /// virtual tile to its page, or to the page of its nearest resident ancestor.
+    class VirtualTexture
+    {
+    public:
+        struct Stats
+        {
+            unsigned int requests;  // distinct tiles in the latest feedback, with their ancestors
+            unsigned int uploads;   // tiles streamed in
+            unsigned int evictions; // pages recycled for other tiles
+            unsigned int resident;  // tiles in the cache
+        };
+
+        /// Feedback is rendered at 1/FeedbackScale of the viewport in each direction
+        static const int FeedbackScale = 8;
+
+    private:
+        struct Page
+        {
+            std::int64_t tile; // index in the tile table, -1 when free
+            unsigned int lastUsed;
+            bool locked;
+        };
+
+        // Tiles resident outside the page budget (the mip tail of a sparse texture)
+        static const std::int32_t TailPage = -2;
+
+        MappedFile m_File;
+        const Vtx::Header *m_Header;
+        const std::uint64_t *m_Offsets;
+        bool m_Sparse;
+        GLuint m_Pages;       // page cache, or the sparse texture
+        GLuint m_Indirection; // page of every tile, or the finest resident level (sparse)
+        int m_CacheSide;      // pages along each side of the cache
+        int m_TailLevel;      // first level of the sparse mip tail
+        std::vector<Page> m_PageTable;
+        std::vector<std::int32_t> m_Resident; // page of every tile, -1 when not resident
+        std::vector<std::uint32_t> m_Requests;
+
+        GLuint m_FeedbackFramebuffer;
+        GLuint m_FeedbackTarget;
+        int m_FeedbackWidth;
+        int m_FeedbackHeight;
+        GLuint m_Readback[2];
+        GLsync m_ReadbackFence[2];
+        int m_ReadbackWidth[2];
+        int m_ReadbackHeight[2];
+        int m_ReadbackIndex;
+        GLint m_Viewport[4];
+
+        unsigned int m_Frame;
+        bool m_Dirty;
+        Stats m_Stats;
+
+    public:
+        /// @param path The cooked .vtx file
+        /// @param cachePages The number of tiles the cache holds
+        /// @param preferSparse Use ARB_sparse_texture when the driver supports it
+        explicit VirtualTexture(std::string const &path, int cachePages = 256, bool preferSparse = true);
+        ~VirtualTexture();
+
+        VirtualTexture(VirtualTexture const &) = delete;
+        VirtualTexture &operator=(VirtualTexture const &) = delete;
+
+        inline bool IsOpen() const { return m_Header != nullptr; }
+        inline bool IsSparse() const { return m_Sparse; }
+
+        /// Selects the shader variant, call before Shader::link()
+        ///
+        /// @param feedback Build the feedback pass instead of the sampling pass
+        void Configure(Shader &shader, bool feedback) const;
+
+        /// Redirects drawing into the feedback target, draw the scene with the
+        /// feedback shader until EndFeedback()
+        void BeginFeedback();
+        /// Starts reading the feedback back and restores the framebuffer
+        void EndFeedback();
+
+        /// Consumes finished feedback and streams missing tiles, call once per frame
+        ///
+        /// @param maxUploads The most tiles uploaded this frame
+        void Update(int maxUploads = 8);
+
+        /// Binds the cache and sets the uniforms of either shader variant
+        ///
+        /// @param slotID The texture unit of the pages, the indirection goes to slotID + 1
+        /// @param feedback Whether the shader is the feedback variant
+        void Bind(Shader &shader, SamplerCache &samplers, int slotID, bool feedback);
+
+        inline Stats const &GetStats() const { return m_Stats; }
+        inline int GetPageCapacity() const { return static_cast<int>(m_PageTable.size()); }
+        /// Video memory of the cache and the lookup table, in bytes
+        std::size_t GetMemoryUsage() const;
+        /// Video memory the whole mip chain would take if loaded up front, in bytes
+        std::size_t GetVirtualSize() const;
+
+    private:
+        void Load(std::string const &path);
+        void CreateCache(int cachePages, bool preferSparse);
+        int AcquirePage();
+        void UploadTile(std::uint32_t tile, int page);
+        void EvictPage(int page);
+        void Gather(const std::uint16_t *feedback, int width, int height);
+        void RebuildIndirection();
+        /// Level and position of a tile from its table index
+        void Locate(std::uint32_t tile, std::uint32_t &level, std::uint32_t &x, std::uint32_t &y) const;
+    };
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+// Standard Headers
+#include <cstdint>
+
+namespace Mirage
+{
+    /// On-disk layout of tiled virtual textures (.vtx) written by LglCooker --virtual
+    ///
+    /// The source image is padded to a square of power of two tiles so every level
+    /// down to a single tile is a whole number of tiles. A Header is followed by
+    /// one tile offset per tile, level 0 first and rows bottom up, then the tiles.
+    /// Each tile is RGBA8 of (tileSize + 2 * border) squared texels, the border
+    /// repeating the neighbouring texels of the same level so tiles filter
+    /// seamlessly from anywhere in a page cache.
+    namespace Vtx
+    {
+        const std::uint32_t Magic = 0x31585456; // "VTX1"
+        const std::uint32_t Version = 1;
+        const std::uint32_t MaxLevels = 16;
+        const std::uint32_t PayloadAlignment = 16;
+
+        struct Header
+        {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint32_t width;  // of the source image
+            std::uint32_t height; // of the source image
+            std::uint32_t size;   // padded width and height of level 0
+            std::uint32_t levels; // the last level is a single tile
+            std::uint32_t tileSize;
+            std::uint32_t border;
+        };
+
+        /// Tiles along each side of a level
+        inline std::uint32_t TilesPerSide(Header const &header, std::uint32_t level)
+        {
+            return (header.size / header.tileSize) >> level;
+        }
+
+        /// Index of a tile in the offset table
+        inline std::uint64_t TileIndex(Header const &header, std::uint32_t level, std::uint32_t x, std::uint32_t y)
+        {
+            std::uint64_t index = 0;
+            for (std::uint32_t l = 0; l < level; l++)
+                index += static_cast<std::uint64_t>(TilesPerSide(header, l)) * TilesPerSide(header, l);
+            return index + static_cast<std::uint64_t>(y) * TilesPerSide(header, level) + x;
+        }
+
+        /// Total tiles over every level
+        inline std::uint64_t TileCount(Header const &header)
+        {
+            return TileIndex(header, header.levels, 0, 0);
+        }
+    };
+};
@@ -1,14 +1,26 @@
 #include "lgl.h"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <glm/gtc/matrix_transform.hpp>
 #include "Texture2D.h"
-#include "Shader.h"
+#include "TextureLoader.h"
+#include "TextureManager.h"
+#include "SamplerCache.h"
+#include "shader.h"
 #include "VertexArray.h"
 #include "VertexBufferLayout.h"
 #include "VertexBuffer.h"
+#include "VertexFormat.h"
 #include "IndexBuffer.h"
+#include "RenderQueue.h"
 #include "glError.h"
+#include "Benchmarks.h"
+#include "GLState.h"
+#include "MeshOptimizer.h"
+#include "Tests.h"
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height)
 {
@@ -21,6 +33,8 @@ void processInput(GLFWwindow *window)
         glfwSetWindowShouldClose(window, true);
 }
 
+void runScene(GLFWwindow *mWindow);
+
 void APIENTRY glDebugOutput(GLenum source,
                             GLenum type,
                             GLuint id,
@@ -28,7 +42,7 @@ void APIENTRY glDebugOutput(GLenum source,
                             GLsizei length,
                             const char *message,
                             const void *userParam);
-int main()
+int main(int argc, char **argv)
 {
     // glfw: initialize and configure
     // ------------------------------
@@ -71,12 +85,37 @@ int main()
 
     std::cout << glGetString(GL_VERSION) << std::endl;
 
+    // run the requested benchmark or self test instead of the demo scene
+    if (argc > 1)
+    {
+        int result = strncmp(argv[1], "--test-", 7) == 0 ? Mirage::Test::run(argc - 1, argv + 1)
+                                                         : Mirage::Bench::run(argc - 1, argv + 1);
+        glfwTerminate();
+        return result;
+    }
+
+    // the scene's GL objects are released when it returns, while the context still exists
+    runScene(mWindow);
+    glfwTerminate();
+    return 0;
+}
+
+// one vertex of the cube, its VertexFormat replaces a runtime VertexBufferLayout
+struct CubeVertex
+{
+    glm::vec3 position;
+    glm::vec2 texCoord;
+};
+typedef Mirage::VertexFormat<CubeVertex, MIRAGE_ATTRIBUTE(CubeVertex, position), MIRAGE_ATTRIBUTE(CubeVertex, texCoord)> CubeFormat;
+
+void runScene(GLFWwindow *mWindow)
+{
     // blending
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    Mirage::GLState::Enable(GL_BLEND);
+    Mirage::GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // enable depth testing
-    glEnable(GL_DEPTH_TEST);
+    Mirage::GLState::Enable(GL_DEPTH_TEST);
 
     // no auto format this block
     float vertices[] = {
@@ -123,14 +162,15 @@ int main()
         -0.5f, 0.5f, 0.5f, 0.0f, 0.0f,
         -0.5f, 0.5f, -0.5f, 0.0f, 1.0f};
 
-    unsigned int indices[] = {
-        // note that we start from 0!
-        0, 1, 3, // first triangle
-        1, 2, 3  // second triangle
-    };
+    // the 36 corners merge into an indexed mesh of unique vertices, ordered for the vertex caches
+    static_assert(sizeof(vertices) == 36 * sizeof(CubeVertex), "the cube's floats are CubeVertex records");
+    std::vector<CubeVertex> cubeVertices(36);
+    std::memcpy(cubeVertices.data(), vertices, sizeof(vertices));
+    std::vector<unsigned int> cubeIndices;
+    Mirage::MeshOptimizer::Optimize(cubeVertices, cubeIndices);
 
     // vertex buffer object
-    Mirage::VertexBuffer VBO(vertices, sizeof(vertices));
+    Mirage::VertexBuffer VBO(cubeVertices.data(), static_cast<unsigned int>(cubeVertices.size() * sizeof(CubeVertex)));
 
     // shader object
     Mirage::Shader shader;
@@ -138,72 +178,75 @@ int main()
     shader.link();
     shader.activate();
 
-    // vertex array object
-    Mirage::VertexBufferLayout layout;
-    layout.push<float>(3);
-    // layout.push<float>(3);
-    layout.push<float>(2);
+    // vertex array object, the layout comes from CubeVertex at compile time
     Mirage::VertexArray VAO;
-    VAO.AddBuffer(VBO, layout);
+    VAO.AddBuffer<CubeFormat>(VBO);
 
-    Mirage::IndexBuffer IBO(indices, 6);
-    IBO.Bind();
+    Mirage::IndexBuffer IBO(cubeIndices.data(), static_cast<unsigned int>(cubeIndices.size()));
+    VAO.SetIndexBuffer(IBO);
 
     // load and create a texture
     // -------------------------
-    std::string file1 = "res/wall.jpg";
-    std::string file2 = "res/donot.png";
-    Texture2D texture1(file2.c_str(), 1);
-    Texture2D texture2(file1.c_str());
-    texture1.Bind();
-    texture2.Bind();
+    // images decode on worker threads, the placeholders are swapped in by loader.Update()
+    Mirage::TextureLoader loader;
+    // the manager shares textures by path and evicts unused ones over its budget
+    Mirage::TextureManager textures(256 << 20, &loader);
+    // the .ltx files are cooked from res/ at build time by LglCooker
+    auto texture1 = textures.Acquire("res/donot.ltx");
+    auto texture2 = textures.Acquire("res/wall.ltx");
 
     // binding texture to shader on slot 0 and 1
     shader.bind("texture1", 0);
     shader.bind("texture2", 1);
 
+    // both slots read through one shared sampler, it stays bound across texture rebinds
+    Mirage::SamplerCache samplers;
+    const Mirage::SamplerState filtering = Mirage::SamplerState::Trilinear(Mirage::SamplerCache::GetMaxAnisotropy());
+    samplers.Bind(0, filtering);
+    samplers.Bind(1, filtering);
+
     // projection matrix
     glm::mat4 projection = glm::mat4(1.0f);
     projection = glm::perspective(glm::radians(45.0f), (float)mWidth / (float)mHeight, 0.1f, 100.0f);
     shader.bind("projection", projection);
 
+    // view matrix, the camera doesn't move so it is set once like the projection
+    glm::mat4 view = glm::mat4(1.0f);
+    view = glm::translate(view, glm::vec3(0.0f, 0.0f, -3.0f));
+    shader.bind("view", view);
+
+    // collects the frame's draws, reused every frame
+    Mirage::RenderQueue queue;
+
     // main loop
     while (!glfwWindowShouldClose(mWindow))
     {
         // input
         // -----
         processInput(mWindow);
+        // upload textures that finished decoding
+        loader.Update();
+        textures.Collect();
         // window color
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         // clear depth buffer data and color data
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // model matrix
+        // model matrix, the only uniform that changes per frame
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::rotate(model, (float)glfwGetTime() * glm::radians(50.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        shader.bind("model", model);
 
-        // view matrix
-        glm::mat4 view = glm::mat4(1.0f);
-        view = glm::translate(view, glm::vec3(0.0f, 0.0f, -3.0f));
-        shader.bind("view", view);
-
-        // binding vertex array VAO
-        VAO.Bind();
-
-        // draw call
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        // draws are queued and dispatched sorted by program, material and texture
+        // the textures are looked up per frame, loader.Update() may have swapped them in
+        Mirage::DrawCommand cube = {&shader, VAO.GetRendererID(), {texture2->getTexture(), texture1->getTexture()},
+                                    GL_TRIANGLES, true, 0, static_cast<GLsizei>(IBO.GetCount()), model};
+        queue.Submit(Mirage::RenderQueue::MakeKey(0, shader.get(), VAO.GetRendererID(), texture2->getTexture(), 0.0f), cube);
+        queue.Sort();
+        queue.Dispatch();
+        queue.Clear();
 
+        Mirage::GLState::EndFrame();
         glfwSwapBuffers(mWindow);
         glfwPollEvents();
     }
-
-    shader.~Shader();
-    texture1.~Texture2D();
-    VBO.~VertexBuffer();
-    IBO.~IndexBuffer();
-    layout.~VertexBufferLayout();
-    VAO.~VertexArray();
-    glfwTerminate();
-    return 0;
 }
\ No newline at end of file
@@ -1,23 +1,67 @@
 // Local Headers
 #include "shader.h"
+#include "GLState.h"
+#include "Timer.h"
 
 // Standard Headers
 #include <cassert>
 #include <fstream>
 #include <memory>
 #include <iostream>
+#include <string>
+#include <cstring>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
 
 // Define Namespace
 namespace Mirage
 {
+    std::string Shader::sBinaryCache = "shadercache";
+
+    Shader::Shader(Shader &&other) noexcept
+        : mProgram(other.mProgram), mStatus(other.mStatus), mLength(other.mLength),
+          mUniforms(std::move(other.mUniforms)), mSources(std::move(other.mSources)),
+          mDefines(std::move(other.mDefines)), mLabel(std::move(other.mLabel)), mLinkTime(other.mLinkTime),
+          mLinkedFromCache(other.mLinkedFromCache)
+    {
+        // glDeleteProgram ignores 0
+        other.mProgram = 0;
+    }
+
+    Shader &Shader::operator=(Shader &&other) noexcept
+    {
+        if (this != &other)
+        {
+            glDeleteProgram(mProgram);
+            mProgram = other.mProgram;
+            mStatus = other.mStatus;
+            mLength = other.mLength;
+            mUniforms = std::move(other.mUniforms);
+            mSources = std::move(other.mSources);
+            mDefines = std::move(other.mDefines);
+            mLabel = std::move(other.mLabel);
+            mLinkTime = other.mLinkTime;
+            mLinkedFromCache = other.mLinkedFromCache;
+            other.mProgram = 0;
+        }
+        return *this;
+    }
+
     Shader &Shader::activate()
     {
-        glUseProgram(mProgram);
+        GLState::UseProgram(mProgram);
         return *this;
     }
 
     void Shader::bind(unsigned int location, float value) { glUniform1f(location, value); }
     void Shader::bind(unsigned int location, int value) { glUniform1i(location, value); }
+    void Shader::bind(unsigned int location, glm::vec2 const &value)
+    {
+        glUniform2f(location, value.x, value.y);
+    }
     void Shader::bind(unsigned int location, glm::vec4 const &value)
     {
         glUniform4f(location, value.x, value.y, value.z, value.w);
@@ -35,28 +79,58 @@ namespace Mirage
         auto src = std::string(std::istreambuf_iterator<char>(fd),
                                (std::istreambuf_iterator<char>()));
 
-        // Create a Shader Object
-        const char *source = src.c_str();
-        auto shader = create(filename);
-        glShaderSource(shader, 1, &source, nullptr);
-        glCompileShader(shader);
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &mStatus);
+        // Compilation is Deferred to link() so a Cached Binary Can Skip it
+        Source source = {filename, src};
+        mSources.push_back(source);
+        mLabel += (mLabel.empty() ? "" : "+") + filename;
+        return *this;
+    }
+
+    Shader &Shader::define(std::string const &name, std::string const &value)
+    {
+        mDefines += "#define " + name + " " + value + "\n";
+        return *this;
+    }
 
-        // Display the Build Log on Error
-        if (mStatus == false)
+    void Shader::compile()
+    {
+        for (auto const &src : mSources)
         {
+            // Defines Go Right After the #version Directive
+            std::string code = src.code;
+            std::size_t at = 0;
+            auto version = code.find("#version");
+            if (version != std::string::npos)
+            {
+                auto eol = code.find('\n', version);
+                if (eol == std::string::npos)
+                    code += '\n';
+                at = eol == std::string::npos ? code.size() : eol + 1;
+            }
+            code.insert(at, mDefines);
 
-            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &mLength);
-            std::unique_ptr<char[]> buffer(new char[mLength]);
-            glGetShaderInfoLog(shader, mLength, nullptr, buffer.get());
-            std::cout << "attach error on " << filename << std::endl;
-            fprintf(stderr, "%s\n%s", filename.c_str(), buffer.get());
-        }
+            // Create a Shader Object
+            const char *source = code.c_str();
+            auto shader = create(src.filename);
+            glShaderSource(shader, 1, &source, nullptr);
+            glCompileShader(shader);
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &mStatus);
 
-        // Attach the Shader and Free Allocated Memory
-        glAttachShader(mProgram, shader);
-        glDeleteShader(shader);
-        return *this;
+            // Display the Build Log on Error
+            if (mStatus == false)
+            {
+
+                glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &mLength);
+                std::unique_ptr<char[]> buffer(new char[mLength]);
+                glGetShaderInfoLog(shader, mLength, nullptr, buffer.get());
+                std::cout << "attach error on " << src.filename << std::endl;
+                fprintf(stderr, "%s\n%s", src.filename.c_str(), buffer.get());
+            }
+
+            // Attach the Shader and Free Allocated Memory
+            glAttachShader(mProgram, shader);
+            glDeleteShader(shader);
+        }
     }
 
     GLuint Shader::create(std::string const &filename)
@@ -77,17 +151,195 @@ namespace Mirage
 
     Shader &Shader::link()
     {
-        glLinkProgram(mProgram);
-        glGetProgramiv(mProgram, GL_LINK_STATUS, &mStatus);
-        if (mStatus == false)
+        Stopwatch watch;
+        std::uint64_t key = binaryKey();
+        mLinkedFromCache = loadBinary(key);
+        if (!mLinkedFromCache)
         {
-            glGetProgramiv(mProgram, GL_INFO_LOG_LENGTH, &mLength);
-            std::unique_ptr<char[]> buffer(new char[mLength]);
-            glGetProgramInfoLog(mProgram, mLength, nullptr, buffer.get());
-            std::cout << "link error on " << std::endl;
-            fprintf(stderr, "%s", buffer.get());
+            compile();
+            glProgramParameteri(mProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            glLinkProgram(mProgram);
+            glGetProgramiv(mProgram, GL_LINK_STATUS, &mStatus);
+            if (mStatus == false)
+            {
+                glGetProgramiv(mProgram, GL_INFO_LOG_LENGTH, &mLength);
+                std::unique_ptr<char[]> buffer(new char[mLength]);
+                glGetProgramInfoLog(mProgram, mLength, nullptr, buffer.get());
+                std::cout << "link error on " << mLabel << std::endl;
+                fprintf(stderr, "%s", buffer.get());
+            }
+            else
+                saveBinary(key);
         }
         assert(mStatus == true);
+        mLinkTime = watch.ElapsedMs();
+        cacheUniforms();
         return *this;
     }
+
+    void Shader::setBinaryCache(std::string const &directory)
+    {
+        sBinaryCache = directory;
+    }
+
+    std::uint64_t Shader::binaryKey() const
+    {
+        // Binaries are only valid for the exact driver that produced them
+        std::uint64_t key = fnv1a64(mDefines.data(), mDefines.size());
+        const GLenum strings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+        for (GLenum name : strings)
+        {
+            const char *value = reinterpret_cast<const char *>(glGetString(name));
+            if (value)
+                key = fnv1a64(value, strlen(value), key);
+        }
+        for (auto const &src : mSources)
+        {
+            key = fnv1a64(src.filename.data(), src.filename.size() + 1, key);
+            key = fnv1a64(src.code.data(), src.code.size(), key);
+        }
+        return key;
+    }
+
+    std::string Shader::binaryPath(std::uint64_t key) const
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "/%016llx.bin", static_cast<unsigned long long>(key));
+        return sBinaryCache + name;
+    }
+
+    bool Shader::loadBinary(std::uint64_t key)
+    {
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        if (sBinaryCache.empty() || formats == 0)
+            return false;
+
+        // Layout: key, binary format, binary blob
+        std::ifstream fd(binaryPath(key), std::ios::binary);
+        std::uint64_t storedKey = 0;
+        GLenum format = 0;
+        if (!fd.read(reinterpret_cast<char *>(&storedKey), sizeof(storedKey)) ||
+            !fd.read(reinterpret_cast<char *>(&format), sizeof(format)) || storedKey != key)
+            return false;
+        std::vector<char> binary((std::istreambuf_iterator<char>(fd)), std::istreambuf_iterator<char>());
+
+        // A driver update can still reject the blob, fall back to compiling
+        glProgramBinary(mProgram, format, binary.data(), static_cast<GLsizei>(binary.size()));
+        glGetProgramiv(mProgram, GL_LINK_STATUS, &mStatus);
+        return mStatus != GL_FALSE;
+    }
+
+    void Shader::saveBinary(std::uint64_t key) const
+    {
+        GLint length = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &length);
+        if (sBinaryCache.empty() || length == 0)
+            return;
+
+        glGetProgramiv(mProgram, GL_PROGRAM_BINARY_LENGTH, &length);
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(mProgram, length, nullptr, &format, binary.data());
+
+#ifdef _WIN32
+        _mkdir(sBinaryCache.c_str());
+#else
+        mkdir(sBinaryCache.c_str(), 0755);
+#endif
+        std::ofstream fd(binaryPath(key), std::ios::binary);
+        fd.write(reinterpret_cast<const char *>(&key), sizeof(key));
+        fd.write(reinterpret_cast<const char *>(&format), sizeof(format));
+        fd.write(binary.data(), binary.size());
+    }
+
+    GLint Shader::getUniformLocation(UniformName const &name) const
+    {
+        // Program was not linked through link(), ask the driver
+        if (mUniforms.empty())
+            return glGetUniformLocation(mProgram, name.str());
+
+        // Linear probe the power of two table, the hash only filters and the name decides.
+        // An empty slot ends the search, names link() did not see are left to the driver
+        std::size_t mask = mUniforms.size() - 1;
+        for (std::size_t i = name.hash() & mask;; i = (i + 1) & mask)
+        {
+            UniformSlot const &slot = mUniforms[i];
+            if (slot.location == -1)
+                return glGetUniformLocation(mProgram, name.str());
+            if (slot.hash == name.hash() && slot.name == name.str())
+                return slot.location;
+        }
+    }
+
+    void Shader::cacheUniforms()
+    {
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(mProgram, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(mProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+        // Gather every resolvable name before sizing the table
+        std::vector<UniformSlot> found;
+        std::unique_ptr<char[]> buffer(new char[maxLength + 1]);
+        for (GLint i = 0; i < count; i++)
+        {
+            GLint size;
+            GLenum type;
+            glGetActiveUniform(mProgram, i, maxLength + 1, nullptr, &size, &type, buffer.get());
+            std::string name = buffer.get();
+            GLint location = glGetUniformLocation(mProgram, name.c_str());
+
+            // Members of uniform blocks have no location
+            if (location == -1)
+                continue;
+            UniformSlot slot = {fnv1a(name.c_str()), location, name};
+            found.push_back(slot);
+
+            // Arrays are reported as "name[0]", make "name" and every element resolvable
+            auto bracket = name.rfind("[0]");
+            if (bracket == std::string::npos || bracket + 3 != name.size())
+                continue;
+            std::string base = name.substr(0, bracket);
+            slot.hash = fnv1a(base.c_str());
+            slot.name = base;
+            found.push_back(slot);
+            for (GLint element = 1; element < size; element++)
+            {
+                std::string indexed = base + "[" + std::to_string(element) + "]";
+                slot.hash = fnv1a(indexed.c_str());
+                slot.name = indexed;
+                slot.location = glGetUniformLocation(mProgram, indexed.c_str());
+                found.push_back(slot);
+            }
+        }
+
+        // Keep the table at most half full so probes stay short
+        std::size_t capacity = 8;
+        while (capacity < found.size() * 2)
+            capacity <<= 1;
+        UniformSlot empty = {0, -1, std::string()};
+        mUniforms.assign(capacity, empty);
+        for (auto &slot : found)
+            insertUniform(std::move(slot));
+    }
+
+    void Shader::insertUniform(UniformSlot &&uniform)
+    {
+        // Colliding hashes take the next free slot, lookups tell them apart by name
+        std::size_t mask = mUniforms.size() - 1;
+        for (std::size_t i = uniform.hash & mask;; i = (i + 1) & mask)
+        {
+            UniformSlot &slot = mUniforms[i];
+            if (slot.location == -1)
+            {
+                slot = std::move(uniform);
+                return;
+            }
+            if (slot.hash == uniform.hash && slot.name == uniform.name)
+            {
+                std::cout << "Uniform listed twice : " << uniform.name << std::endl;
+                return;
+            }
+        }
+    }
 };
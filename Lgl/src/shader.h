@@ -5,50 +5,121 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+// Local Headers
+#include "Hash.h"
+
 // Standard Headers
+#include <cstdint>
+#include <cstdio>
 #include <string>
+#include <vector>
 
 // Define Namespace
 namespace Mirage
 {
+    /// Uniform name with its hash precomputed, string literals are hashed at compile time
+    class UniformName
+    {
+    public:
+        template <std::size_t N>
+        constexpr UniformName(const char (&name)[N]) : mName(name), mHash(fnv1a(name)) {}
+        UniformName(std::string const &name) : mName(name.c_str()), mHash(fnv1a(name.c_str())) {}
+
+        constexpr const char *str() const { return mName; }
+        constexpr std::uint32_t hash() const { return mHash; }
+
+    private:
+        const char *mName;
+        std::uint32_t mHash;
+    };
+
     class Shader
     {
     public:
         // Implement Custom Constructor and Destructor
         Shader() { mProgram = glCreateProgram(); }
         ~Shader() { glDeleteProgram(mProgram); }
+        // Moves Hand the Program Over, the Source is Left Without One
+        Shader(Shader &&other) noexcept;
+        Shader &operator=(Shader &&other) noexcept;
 
         // Public Member Functions
         Shader &activate();
         Shader &attach(std::string const &filename);
         GLuint create(std::string const &filename);
+        Shader &define(std::string const &name, std::string const &value = "");
         GLuint get() { return mProgram; }
         Shader &link();
 
+        // Link Statistics of the Last Call to link()
+        double linkTime() const { return mLinkTime; }
+        bool linkedFromCache() const { return mLinkedFromCache; }
+        std::string const &label() const { return mLabel; }
+
+        // Directory for Cached Program Binaries, an Empty Path Disables the Cache
+        static void setBinaryCache(std::string const &directory);
+
         // Wrap Calls to glUniform
         void bind(unsigned int location, float value);
         void bind(unsigned int location, int value);
         void bind(unsigned int location, glm::mat4 const &matrix);
+        void bind(unsigned int location, glm::vec2 const &vector);
         void bind(unsigned int location, glm::vec4 const &vector);
         template <typename T>
-        Shader &bind(std::string const &name, T &&value)
+        Shader &bind(UniformName const &name, T &&value)
         {
-            int location = glGetUniformLocation(mProgram, name.c_str());
+            GLint location = getUniformLocation(name);
             if (location == -1)
-                fprintf(stderr, "Missing Uniform: %s\n", name.c_str());
+                fprintf(stderr, "Missing Uniform: %s\n", name.str());
             else
                 bind(location, std::forward<T>(value));
             return *this;
         }
 
+        // Resolve a Uniform Location through the Cache Built by link()
+        GLint getUniformLocation(UniformName const &name) const;
+
     private:
         // Disable Copying and Assignment
         Shader(Shader const &) = delete;
         Shader &operator=(Shader const &) = delete;
 
+        // Program Binary Cache
+        std::uint64_t binaryKey() const;
+        std::string binaryPath(std::uint64_t key) const;
+        bool loadBinary(std::uint64_t key);
+        void saveBinary(std::uint64_t key) const;
+        void compile();
+
+        // Shader Source Kept Until link() Knows Whether it Must Compile
+        struct Source
+        {
+            std::string filename;
+            std::string code;
+        };
+
+        // Enumerate Active Uniforms into the Location Cache
+        void cacheUniforms();
+
+        // Open Addressed Slot of the Uniform Location Cache
+        struct UniformSlot
+        {
+            std::uint32_t hash;
+            GLint location; // -1 marks an empty slot
+            std::string name;
+        };
+        void insertUniform(UniformSlot &&uniform);
+
         // Private Member Variables
         GLuint mProgram;
         GLint mStatus;
         GLint mLength;
+        std::vector<UniformSlot> mUniforms;
+        std::vector<Source> mSources;
+        std::string mDefines;
+        std::string mLabel;
+        double mLinkTime = 0.0;
+        bool mLinkedFromCache = false;
+        static std::string sBinaryCache;
     };
 };